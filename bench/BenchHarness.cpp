@@ -0,0 +1,73 @@
+#include "BenchHarness.h"
+#include <algorithm>
+#include <cstdio>
+#include <esp_timer.h>
+
+void BenchReport::add(const BenchResult& result) {
+    results_.push_back(result);
+    print(result);
+}
+
+int64_t BenchReport::nowUs() {
+    return esp_timer_get_time();
+}
+
+void BenchReport::summarize(std::vector<uint32_t>& samplesUs, BenchResult& result) {
+    if (samplesUs.empty()) {
+        return;
+    }
+
+    std::sort(samplesUs.begin(), samplesUs.end());
+
+    // Nearest-rank percentiles
+    size_t count = samplesUs.size();
+    result.p50Us = samplesUs[(count - 1) * 50 / 100];
+    result.p90Us = samplesUs[(count - 1) * 90 / 100];
+    result.p99Us = samplesUs[(count - 1) * 99 / 100];
+    result.maxUs = samplesUs[count - 1];
+}
+
+void BenchReport::print(const BenchResult& result) {
+    printf("%-8s %-12s payload=%-5u subs=%-3u keys=%-5u threads=%-2u %12.0f ops/s  p50=%uus p90=%uus p99=%uus max=%uus\n",
+           result.suite.c_str(), result.name.c_str(), result.payloadBytes, result.subscribers, result.keys,
+           result.threads, result.opsPerSec, result.p50Us, result.p90Us, result.p99Us, result.maxUs);
+    fflush(stdout);
+}
+
+bool BenchReport::writeJson(const std::string& path) const {
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        return false;
+    }
+
+    fprintf(file, "[\n");
+    for (size_t i = 0; i < results_.size(); i++) {
+        const BenchResult& r = results_[i];
+        fprintf(file,
+                "  {\"suite\": \"%s\", \"name\": \"%s\", \"payload_bytes\": %u, \"subscribers\": %u, "
+                "\"keys\": %u, \"threads\": %u, \"ops\": %llu, \"seconds\": %.6f, \"ops_per_sec\": %.1f, "
+                "\"p50_us\": %u, \"p90_us\": %u, \"p99_us\": %u, \"max_us\": %u}%s\n",
+                r.suite.c_str(), r.name.c_str(), r.payloadBytes, r.subscribers, r.keys, r.threads,
+                (unsigned long long)r.ops, r.seconds, r.opsPerSec, r.p50Us, r.p90Us, r.p99Us, r.maxUs,
+                i + 1 < results_.size() ? "," : "");
+    }
+    fprintf(file, "]\n");
+
+    return fclose(file) == 0;
+}
+
+bool BenchReport::writeCsv(const std::string& path) const {
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        return false;
+    }
+
+    fprintf(file, "suite,name,payload_bytes,subscribers,keys,threads,ops,seconds,ops_per_sec,p50_us,p90_us,p99_us,max_us\n");
+    for (const BenchResult& r : results_) {
+        fprintf(file, "%s,%s,%u,%u,%u,%u,%llu,%.6f,%.1f,%u,%u,%u,%u\n",
+                r.suite.c_str(), r.name.c_str(), r.payloadBytes, r.subscribers, r.keys, r.threads,
+                (unsigned long long)r.ops, r.seconds, r.opsPerSec, r.p50Us, r.p90Us, r.p99Us, r.maxUs);
+    }
+
+    return fclose(file) == 0;
+}
@@ -0,0 +1,60 @@
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// One measured case. Parameters that don't apply to a suite stay 0 and are written as 0.
+struct BenchResult {
+    std::string suite;      // "network" or "data"
+    std::string name;       // Operation, e.g. "publish", "get", "cleanup"
+    uint32_t payloadBytes;  // Message or value size
+    uint32_t subscribers;
+    uint32_t keys;
+    uint32_t threads;
+    uint64_t ops;
+    double seconds;
+    double opsPerSec;
+    // Per-operation latency in microseconds (publish-to-delivery for the network suite)
+    uint32_t p50Us;
+    uint32_t p90Us;
+    uint32_t p99Us;
+    uint32_t maxUs;
+
+    BenchResult() :
+        payloadBytes(0), subscribers(0), keys(0), threads(0), ops(0), seconds(0), opsPerSec(0),
+        p50Us(0), p90Us(0), p99Us(0), maxUs(0) {}
+};
+
+struct BenchConfig {
+    bool quick;              // Fewer ops and a smaller matrix, for CI smoke runs
+    std::string filter;      // Run only suites whose name contains this
+    std::string jsonPath;
+    std::string csvPath;
+
+    BenchConfig() : quick(false) {}
+};
+
+class BenchReport {
+public:
+    void add(const BenchResult& result);
+    const std::vector<BenchResult>& results() const { return results_; }
+
+    bool writeJson(const std::string& path) const;
+    bool writeCsv(const std::string& path) const;
+
+    // Monotonic microseconds, same clock as the firmware's esp_timer
+    static int64_t nowUs();
+
+    // Fill p50/p90/p99/max from raw samples (sorts them in place)
+    static void summarize(std::vector<uint32_t>& samplesUs, BenchResult& result);
+
+private:
+    std::vector<BenchResult> results_;
+
+    static void print(const BenchResult& result);
+};
+
+#endif // BENCH_HARNESS_H
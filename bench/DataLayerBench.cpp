@@ -0,0 +1,226 @@
+#include "DataLayerBench.h"
+#include <atomic>
+#include <cstdio>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include "layers/data/DataLayer.h"
+
+namespace {
+
+const uint32_t KEY_COUNTS[] = {16, 256, 4096};
+const uint32_t VALUE_SIZES[] = {4, 32, 256};
+const uint32_t THREAD_COUNTS[] = {1, 4};
+const uint32_t CLEANUP_KEY_COUNTS[] = {256, 4096, 16384};
+
+const uint32_t LONG_TTL_MS = 600000;
+const uint32_t CLEANUP_INTERVAL_MS = 500;
+const uint32_t CLEANUP_TIMEOUT_MS = 3000;
+
+struct Worker {
+    DataLayer* dataLayer;
+    const std::vector<std::string>* keys;
+    DataLayerBench::Op op;
+    uint32_t ops;
+    uint32_t seed;
+    const std::vector<uint8_t>* value;
+    std::vector<uint32_t> latenciesUs;
+    const std::atomic<bool>* start;
+    SemaphoreHandle_t done;
+};
+
+std::vector<std::string> makeKeys(uint32_t count) {
+    std::vector<std::string> keys;
+    keys.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        char key[24];
+        snprintf(key, sizeof(key), "bench:key:%u", i);
+        keys.push_back(key);
+    }
+    return keys;
+}
+
+}
+
+DataLayerBench::DataLayerBench(const BenchConfig& config) : config_(config) {}
+
+const char* DataLayerBench::opName(Op op) {
+    switch (op) {
+        case OP_SET:     return "set";
+        case OP_GET:     return "get";
+        case OP_SET_TTL: return "set_ttl";
+        case OP_TTL:     return "ttl";
+    }
+    return "?";
+}
+
+void DataLayerBench::run(BenchReport& report) {
+    uint32_t ops = config_.quick ? 2000 : 20000;
+    const Op allOps[] = {OP_SET, OP_GET, OP_SET_TTL, OP_TTL};
+
+    for (Op op : allOps) {
+        for (uint32_t keys : KEY_COUNTS) {
+            for (uint32_t valueBytes : VALUE_SIZES) {
+                // TTL lookups don't touch the value; one size is enough
+                if (op == OP_TTL && valueBytes != VALUE_SIZES[0]) {
+                    continue;
+                }
+                for (uint32_t threads : THREAD_COUNTS) {
+                    runOpCase(report, op, keys, valueBytes, threads, ops);
+                }
+            }
+        }
+    }
+
+    for (uint32_t keys : CLEANUP_KEY_COUNTS) {
+        if (config_.quick && keys > 4096) {
+            continue;
+        }
+        runCleanupCase(report, keys, 32);
+    }
+}
+
+void DataLayerBench::workerTask(void* parameter) {
+    Worker* worker = static_cast<Worker*>(parameter);
+    DataLayer* dataLayer = worker->dataLayer;
+    const std::vector<std::string>& keys = *worker->keys;
+    const std::vector<uint8_t>& value = *worker->value;
+    uint8_t buffer[256];
+
+    while (!worker->start->load()) {
+        taskYIELD();
+    }
+
+    // xorshift32: uniform key choice without contending on a shared RNG
+    uint32_t state = worker->seed;
+    for (uint32_t i = 0; i < worker->ops; i++) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        const std::string& key = keys[state % keys.size()];
+
+        int64_t before = BenchReport::nowUs();
+        switch (worker->op) {
+            case OP_SET:
+                dataLayer->set(key, value.data(), value.size());
+                break;
+            case OP_GET: {
+                size_t len = 0;
+                dataLayer->get(key, buffer, sizeof(buffer), len);
+                break;
+            }
+            case OP_SET_TTL:
+                dataLayer->set(key, value.data(), value.size(), LONG_TTL_MS);
+                break;
+            case OP_TTL:
+                dataLayer->ttl(key);
+                break;
+        }
+        worker->latenciesUs[i] = (uint32_t)(BenchReport::nowUs() - before);
+    }
+
+    xSemaphoreGive(worker->done);
+    vTaskDelete(nullptr);
+}
+
+void DataLayerBench::runOpCase(BenchReport& report, Op op, uint32_t keyCount, uint32_t valueBytes,
+                               uint32_t threads, uint32_t ops) {
+    DataLayer* dataLayer = new DataLayer();
+    dataLayer->init();
+
+    std::vector<std::string> keys = makeKeys(keyCount);
+    std::vector<uint8_t> value(valueBytes, 0x5A);
+
+    // Reads measure a full store
+    if (op == OP_GET || op == OP_TTL) {
+        for (const std::string& key : keys) {
+            dataLayer->set(key, value.data(), value.size(), op == OP_TTL ? LONG_TTL_MS : 0);
+        }
+    }
+
+    std::atomic<bool> start(false);
+    SemaphoreHandle_t done = xSemaphoreCreateCounting(threads, 0);
+    std::vector<Worker> workers(threads);
+
+    for (uint32_t t = 0; t < threads; t++) {
+        Worker& worker = workers[t];
+        worker.dataLayer = dataLayer;
+        worker.keys = &keys;
+        worker.op = op;
+        worker.ops = ops / threads;
+        worker.seed = 0x9E3779B9u * (t + 1);
+        worker.value = &value;
+        worker.latenciesUs.resize(worker.ops);
+        worker.start = &start;
+        worker.done = done;
+
+        char name[24];
+        snprintf(name, sizeof(name), "BenchData%u", t);
+        xTaskCreate(workerTask, name, 4096, &worker, 1, nullptr);
+    }
+
+    int64_t begin = BenchReport::nowUs();
+    start.store(true);
+    for (uint32_t t = 0; t < threads; t++) {
+        xSemaphoreTake(done, portMAX_DELAY);
+    }
+    int64_t end = BenchReport::nowUs();
+
+    BenchResult result;
+    result.suite = "data";
+    result.name = opName(op);
+    result.payloadBytes = valueBytes;
+    result.keys = keyCount;
+    result.threads = threads;
+
+    std::vector<uint32_t> latencies;
+    latencies.reserve(ops);
+    for (const Worker& worker : workers) {
+        result.ops += worker.ops;
+        latencies.insert(latencies.end(), worker.latenciesUs.begin(), worker.latenciesUs.end());
+    }
+    result.seconds = (end - begin) / 1e6;
+    result.opsPerSec = result.seconds > 0 ? result.ops / result.seconds : 0;
+    BenchReport::summarize(latencies, result);
+    report.add(result);
+
+    vSemaphoreDelete(done);
+    delete dataLayer;
+}
+
+void DataLayerBench::runCleanupCase(BenchReport& report, uint32_t keyCount, uint32_t valueBytes) {
+    DataLayer* dataLayer = new DataLayer();
+    dataLayer->init(CLEANUP_INTERVAL_MS);
+
+    std::vector<std::string> keys = makeKeys(keyCount);
+    std::vector<uint8_t> value(valueBytes, 0x5A);
+    for (const std::string& key : keys) {
+        dataLayer->set(key, value.data(), value.size(), 1);
+    }
+
+    // Everything has expired by now; time the next pass that finds it. A pass that ran
+    // mid-load only evicted part of the keys and is discarded by the reset.
+    vTaskDelay(pdMS_TO_TICKS(2));
+    dataLayer->resetStats();
+
+    DataLayer::Stats stats = dataLayer->stats();
+    int64_t deadline = BenchReport::nowUs() + (int64_t)CLEANUP_TIMEOUT_MS * 1000;
+    while (stats.cleanupRuns == 0 && BenchReport::nowUs() < deadline) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+        stats = dataLayer->stats();
+    }
+
+    BenchResult result;
+    result.suite = "data";
+    result.name = "cleanup";
+    result.payloadBytes = valueBytes;
+    result.keys = keyCount;
+    result.threads = 1;
+    result.ops = stats.evicted;
+    result.seconds = stats.cleanupLastUs / 1e6;
+    result.opsPerSec = result.seconds > 0 ? result.ops / result.seconds : 0;
+    result.p50Us = result.p90Us = result.p99Us = result.maxUs = stats.cleanupLastUs;
+    report.add(result);
+
+    delete dataLayer;
+}
@@ -0,0 +1,31 @@
+#ifndef DATA_LAYER_BENCH_H
+#define DATA_LAYER_BENCH_H
+
+#include "BenchHarness.h"
+
+// DataLayer get/set/ttl throughput and per-op latency across key counts, value sizes and
+// concurrent tasks, plus cleanup-pass eviction rate. Each case gets a fresh DataLayer.
+class DataLayerBench {
+public:
+    enum Op {
+        OP_SET,
+        OP_GET,
+        OP_SET_TTL,
+        OP_TTL
+    };
+
+    explicit DataLayerBench(const BenchConfig& config);
+
+    void run(BenchReport& report);
+
+private:
+    const BenchConfig& config_;
+
+    void runOpCase(BenchReport& report, Op op, uint32_t keys, uint32_t valueBytes, uint32_t threads, uint32_t ops);
+    void runCleanupCase(BenchReport& report, uint32_t keys, uint32_t valueBytes);
+
+    static const char* opName(Op op);
+    static void workerTask(void* parameter);
+};
+
+#endif // DATA_LAYER_BENCH_H
@@ -0,0 +1,130 @@
+#include "NetworkBench.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "layers/network/NetworkLayer.h"
+
+namespace {
+
+const uint32_t PAYLOAD_SIZES[] = {8, 64, 256, 1024};
+const uint32_t SUBSCRIBER_COUNTS[] = {1, 4, 16};
+
+// Publishes ahead of delivery before the publisher backs off; every publish is a task,
+// so an unbounded burst only measures how fast the heap runs out
+const uint32_t MAX_IN_FLIGHT = 64;
+const uint32_t DRAIN_TIMEOUT_MS = 10000;
+
+struct DeliveryLog {
+    std::vector<uint32_t> latenciesUs;
+    std::atomic<uint32_t> claimed;   // Next latency slot
+    std::atomic<uint32_t> delivered; // Callbacks finished writing
+    std::atomic<int64_t> lastDeliveryUs;
+
+    explicit DeliveryLog(size_t capacity) : latenciesUs(capacity), claimed(0), delivered(0), lastDeliveryUs(0) {}
+};
+
+}
+
+NetworkBench::NetworkBench(const BenchConfig& config) : config_(config) {}
+
+void NetworkBench::run(BenchReport& report) {
+    uint32_t messages = config_.quick ? 200 : 2000;
+
+    for (uint32_t payloadBytes : PAYLOAD_SIZES) {
+        for (uint32_t subscribers : SUBSCRIBER_COUNTS) {
+            if (config_.quick && subscribers > 4) {
+                continue;
+            }
+            runCase(report, payloadBytes, subscribers, messages);
+        }
+    }
+}
+
+void NetworkBench::runCase(BenchReport& report, uint32_t payloadBytes, uint32_t subscribers, uint32_t messages) {
+    const std::string topic = "bench/publish";
+
+    NetworkLayer* network = new NetworkLayer();
+    network->init();
+
+    DeliveryLog* log = new DeliveryLog((size_t)messages * subscribers);
+    for (uint32_t i = 0; i < subscribers; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "sub%u", i);
+        network->subscribe(topic, name, [log](const uint8_t* data, size_t len, const std::string&) {
+            int64_t now = BenchReport::nowUs();
+            int64_t sentUs;
+            memcpy(&sentUs, data, sizeof(sentUs));
+
+            int64_t last = log->lastDeliveryUs.load();
+            while (now > last && !log->lastDeliveryUs.compare_exchange_weak(last, now)) {
+            }
+
+            uint32_t index = log->claimed.fetch_add(1);
+            if (index < log->latenciesUs.size()) {
+                log->latenciesUs[index] = (uint32_t)(now - sentUs);
+            }
+
+            // Counted last: once delivered reaches the total the runner may read and free the log
+            log->delivered.fetch_add(1);
+        });
+    }
+
+    std::vector<uint8_t> payload(payloadBytes, 0xA5);
+    std::vector<uint32_t> callUs(messages);
+    uint64_t expected = (uint64_t)messages * subscribers;
+
+    int64_t start = BenchReport::nowUs();
+    for (uint32_t i = 0; i < messages; i++) {
+        while ((uint64_t)i * subscribers - log->delivered.load() > (uint64_t)MAX_IN_FLIGHT * subscribers) {
+            taskYIELD();
+        }
+
+        int64_t before = BenchReport::nowUs();
+        memcpy(payload.data(), &before, sizeof(before));
+        network->publish(topic, payload.data(), payload.size(), "bench");
+        callUs[i] = (uint32_t)(BenchReport::nowUs() - before);
+    }
+    int64_t publishedAt = BenchReport::nowUs();
+
+    int64_t deadline = publishedAt + (int64_t)DRAIN_TIMEOUT_MS * 1000;
+    while (log->delivered.load() < expected && BenchReport::nowUs() < deadline) {
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+    uint32_t delivered = log->delivered.load();
+
+    BenchResult call;
+    call.suite = "network";
+    call.name = "publish_call";
+    call.payloadBytes = payloadBytes;
+    call.subscribers = subscribers;
+    call.ops = messages;
+    call.seconds = (publishedAt - start) / 1e6;
+    call.opsPerSec = call.seconds > 0 ? messages / call.seconds : 0;
+    BenchReport::summarize(callUs, call);
+    report.add(call);
+
+    BenchResult delivery;
+    delivery.suite = "network";
+    delivery.name = "deliver";
+    delivery.payloadBytes = payloadBytes;
+    delivery.subscribers = subscribers;
+    delivery.ops = delivered;
+    delivery.seconds = (log->lastDeliveryUs.load() - start) / 1e6;
+    delivery.opsPerSec = delivery.seconds > 0 ? delivered / delivery.seconds : 0;
+    std::vector<uint32_t> latencies(log->latenciesUs.begin(),
+                                    log->latenciesUs.begin() + std::min<size_t>(delivered, log->latenciesUs.size()));
+    BenchReport::summarize(latencies, delivery);
+    report.add(delivery);
+
+    if (delivered < expected) {
+        // Delivery tasks still hold the layer and the log; leak them rather than free under them
+        printf("network  deliver      timed out: %u of %llu deliveries\n", delivered, (unsigned long long)expected);
+        return;
+    }
+
+    delete network;
+    delete log;
+}
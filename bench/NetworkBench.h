@@ -0,0 +1,20 @@
+#ifndef NETWORK_BENCH_H
+#define NETWORK_BENCH_H
+
+#include "BenchHarness.h"
+
+// Publish throughput and publish-to-delivery latency across payload sizes and
+// subscriber counts. Each case gets a fresh NetworkLayer.
+class NetworkBench {
+public:
+    explicit NetworkBench(const BenchConfig& config);
+
+    void run(BenchReport& report);
+
+private:
+    const BenchConfig& config_;
+
+    void runCase(BenchReport& report, uint32_t payloadBytes, uint32_t subscribers, uint32_t messages);
+};
+
+#endif // NETWORK_BENCH_H
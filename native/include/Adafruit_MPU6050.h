@@ -0,0 +1,76 @@
+#ifndef NATIVE_ADAFRUIT_MPU6050_H
+#define NATIVE_ADAFRUIT_MPU6050_H
+
+#include <cstdint>
+#include <functional>
+#include "Adafruit_Sensor.h"
+#include "Wire.h"
+
+#define MPU6050_I2CADDR_DEFAULT 0x68
+
+typedef enum {
+    MPU6050_RANGE_2_G = 0,
+    MPU6050_RANGE_4_G,
+    MPU6050_RANGE_8_G,
+    MPU6050_RANGE_16_G
+} mpu6050_accel_range_t;
+
+typedef enum {
+    MPU6050_RANGE_250_DEG = 0,
+    MPU6050_RANGE_500_DEG,
+    MPU6050_RANGE_1000_DEG,
+    MPU6050_RANGE_2000_DEG
+} mpu6050_gyro_range_t;
+
+typedef enum {
+    MPU6050_BAND_260_HZ = 0,
+    MPU6050_BAND_184_HZ,
+    MPU6050_BAND_94_HZ,
+    MPU6050_BAND_44_HZ,
+    MPU6050_BAND_21_HZ,
+    MPU6050_BAND_10_HZ,
+    MPU6050_BAND_5_HZ
+} mpu6050_bandwidth_t;
+
+typedef enum {
+    MPU6050_HIGHPASS_DISABLE = 0,
+    MPU6050_HIGHPASS_5_HZ,
+    MPU6050_HIGHPASS_2_5_HZ,
+    MPU6050_HIGHPASS_1_25_HZ,
+    MPU6050_HIGHPASS_0_63_HZ,
+    MPU6050_HIGHPASS_UNUSED,
+    MPU6050_HIGHPASS_HOLD
+} mpu6050_highpass_t;
+
+// Simulated MPU6050: a level sensor (1 g on Z) with a slow sinusoidal wobble, a function of
+// micros() so runs are reproducible. Tests can replace the motion model with setMotion().
+class Adafruit_MPU6050 {
+public:
+    // Fills accel (m/s^2) and gyro (rad/s) for a time in microseconds
+    using MotionModel = std::function<void(uint64_t timeUs, float accel[3], float gyro[3])>;
+
+    bool begin(uint8_t address = MPU6050_I2CADDR_DEFAULT, TwoWire* wire = &Wire, int32_t sensorId = 0);
+    bool getEvent(sensors_event_t* accel, sensors_event_t* gyro, sensors_event_t* temp);
+
+    void setAccelerometerRange(mpu6050_accel_range_t range) { accelRange_ = range; }
+    mpu6050_accel_range_t getAccelerometerRange() { return accelRange_; }
+    void setGyroRange(mpu6050_gyro_range_t range) { gyroRange_ = range; }
+    mpu6050_gyro_range_t getGyroRange() { return gyroRange_; }
+    void setFilterBandwidth(mpu6050_bandwidth_t bandwidth) { bandwidth_ = bandwidth; }
+    mpu6050_bandwidth_t getFilterBandwidth() { return bandwidth_; }
+    void setHighPassFilter(mpu6050_highpass_t filter) { (void)filter; }
+    void setMotionDetectionThreshold(uint8_t threshold) { (void)threshold; }
+    void setMotionDetectionDuration(uint8_t duration) { (void)duration; }
+    void setInterruptPinLatch(bool held) { (void)held; }
+    void setInterruptPinPolarity(bool activeLow) { (void)activeLow; }
+    void setMotionInterrupt(bool active) { (void)active; }
+
+    static void setMotion(MotionModel model);
+
+private:
+    mpu6050_accel_range_t accelRange_ = MPU6050_RANGE_2_G;
+    mpu6050_gyro_range_t gyroRange_ = MPU6050_RANGE_250_DEG;
+    mpu6050_bandwidth_t bandwidth_ = MPU6050_BAND_260_HZ;
+};
+
+#endif // NATIVE_ADAFRUIT_MPU6050_H
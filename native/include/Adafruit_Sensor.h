@@ -0,0 +1,32 @@
+#ifndef NATIVE_ADAFRUIT_SENSOR_H
+#define NATIVE_ADAFRUIT_SENSOR_H
+
+#include <cstdint>
+
+// Layout-compatible subset of the Adafruit unified sensor event
+typedef struct {
+    union {
+        float v[3];
+        struct {
+            float x;
+            float y;
+            float z;
+        };
+    };
+} sensors_vec_t;
+
+typedef struct {
+    int32_t version;
+    int32_t sensor_id;
+    int32_t type;
+    int32_t reserved0;
+    int32_t timestamp;
+    union {
+        float data[4];
+        sensors_vec_t acceleration;
+        sensors_vec_t gyro;
+        float temperature;
+    };
+} sensors_event_t;
+
+#endif // NATIVE_ADAFRUIT_SENSOR_H
@@ -0,0 +1,64 @@
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+// Host shim for the Arduino-ESP32 core: timing, Serial, String, GPIO stubs and ESP info.
+// Only what the layers and apps use; everything runs on POSIX threads (see freertos/*).
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <freertos/queue.h>
+#include "WString.h"
+#include "HardwareSerial.h"
+
+// Same width as on the ESP32, so wrap-around arithmetic behaves identically
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT          0x01
+#define OUTPUT         0x03
+#define INPUT_PULLUP   0x05
+#define INPUT_PULLDOWN 0x09
+
+#define RISING  0x01
+#define FALLING 0x02
+#define CHANGE  0x03
+
+#define IRAM_ATTR
+
+// GPIO state is kept in memory so apps can read back what they wrote
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int digitalPinToInterrupt(uint8_t pin);
+void attachInterrupt(uint8_t pin, void (*handler)(), int mode);
+void attachInterruptArg(uint8_t pin, void (*handler)(void*), void* arg, int mode);
+void detachInterrupt(uint8_t pin);
+
+// Host only: run the handler attached to pin, as the GPIO ISR would (simulated peripherals)
+void nativeRaiseInterrupt(uint8_t pin);
+
+class EspClass {
+public:
+    uint32_t getFreeHeap();
+    uint32_t getHeapSize() { return 320 * 1024; }
+    uint32_t getFreePsram() { return 4 * 1024 * 1024; }
+    void restart();
+};
+
+extern EspClass ESP;
+
+#endif // NATIVE_ARDUINO_H
@@ -0,0 +1,65 @@
+#ifndef NATIVE_BLUETOOTH_SERIAL_H
+#define NATIVE_BLUETOOTH_SERIAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include "WString.h"
+
+// Loopback Bluetooth SPP for the host. The device side is the normal BluetoothSerial API;
+// the host side (tests, benchmarks, main_native's stdin bridge) injects received bytes and
+// observes transmitted ones. "Connected" follows begin() unless the host overrides it.
+class BluetoothSerial {
+public:
+    using TxListener = std::function<void(const uint8_t* data, size_t len)>;
+
+    BluetoothSerial() {}
+    ~BluetoothSerial();
+
+    bool begin(const String& deviceName, bool isMaster = false);
+    void end();
+    bool connected(int timeoutMs = 0);
+    bool hasClient() { return connected(); }
+
+    int available();
+    int read();
+    int peek();
+    size_t readBytes(uint8_t* buffer, size_t len);
+    size_t readBytes(char* buffer, size_t len) { return readBytes(reinterpret_cast<uint8_t*>(buffer), len); }
+
+    size_t write(uint8_t byte) { return write(&byte, 1); }
+    size_t write(const uint8_t* data, size_t len);
+    size_t print(const String& text) { return write(reinterpret_cast<const uint8_t*>(text.c_str()), text.length()); }
+    size_t print(const char* text) { return print(String(text)); }
+    size_t println(const String& text) { return print(text) + print("\r\n"); }
+    size_t println(const char* text) { return println(String(text)); }
+    size_t println() { return print("\r\n"); }
+    void flush() {}
+
+    // Host side. Apps own their BluetoothSerial privately, so the host reaches the most
+    // recently started instance through host() (nullptr before any begin()).
+    static BluetoothSerial* host();
+    void hostSetConnected(bool connected);
+    void hostInject(const uint8_t* data, size_t len);     // Bytes the phone "sent"
+    void hostInject(const char* text);
+    size_t hostTake(std::vector<uint8_t>& out);           // Drain bytes the device sent
+    void hostSetTxListener(TxListener listener);          // Or observe them as they are written
+    size_t hostTxBytes() const;                           // Total bytes written since begin()
+
+private:
+    mutable std::mutex mutex_;
+    std::deque<uint8_t> rx_;
+    std::vector<uint8_t> tx_;
+    TxListener txListener_;
+    size_t txTotal_ = 0;
+    bool started_ = false;
+    int connectedOverride_ = -1; // -1 follows begin()
+
+    static std::atomic<BluetoothSerial*> hostInstance_;
+};
+
+#endif // NATIVE_BLUETOOTH_SERIAL_H
@@ -0,0 +1,57 @@
+#ifndef NATIVE_FS_H
+#define NATIVE_FS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+namespace fs {
+
+// Arduino fs::File over a stdio FILE*
+class File {
+public:
+    File() {}
+    explicit File(FILE* handle) {
+        if (handle != nullptr) {
+            handle_.reset(handle, &fclose);
+        }
+    }
+
+    explicit operator bool() const { return handle_ != nullptr; }
+    size_t read(uint8_t* buffer, size_t len);
+    size_t write(const uint8_t* data, size_t len);
+    size_t size() const;
+    bool seek(uint32_t position);
+    size_t position() const;
+    void flush();
+    void close() { handle_.reset(); }
+
+private:
+    std::shared_ptr<FILE> handle_;
+};
+
+// Host directory standing in for a flash filesystem; paths are relative to root
+class FS {
+public:
+    explicit FS(const std::string& root) : root_(root) {}
+
+    void setRoot(const std::string& root) { root_ = root; }
+    File open(const char* path, const char* mode = "r");
+    bool exists(const char* path);
+    bool remove(const char* path);
+    bool rename(const char* from, const char* to);
+    bool mkdir(const char* path);
+    bool rmdir(const char* path);
+
+protected:
+    std::string hostPath(const char* path) const;
+    std::string root_;
+};
+
+} // namespace fs
+
+using fs::File;
+
+#endif // NATIVE_FS_H
@@ -0,0 +1,36 @@
+#ifndef NATIVE_SIM_H
+#define NATIVE_SIM_H
+
+#include <cstdint>
+
+// Virtual-time simulation for the host build.
+//
+// After begin(), millis()/micros()/esp_timer_get_time() and every FreeRTOS wait run on a
+// virtual clock. One task runs at a time in FIFO order and never gets preempted; when all
+// tasks are blocked the clock jumps to the earliest wake-up, so an hour of firmware time with
+// mostly idle tasks takes seconds and every run interleaves identically. Code runs in zero
+// virtual time unless it calls advance() (delayMicroseconds() does) to model busy work.
+//
+// Threads not created through xTaskCreate must not call RTOS functions once begin() ran,
+// and a task that polls the clock without blocking or yielding stops time for everyone.
+namespace NativeSim {
+
+// Switch to virtual time. Call once, from the main thread, before any task is created.
+void begin(uint64_t startUs = 0);
+bool active();
+
+uint64_t nowUs();
+
+// Let time pass while the calling task keeps the CPU
+void advance(uint64_t us);
+
+// Charge every context switch (0 by default), so fan-out and task-per-message costs show up
+// as latency instead of running in zero time
+void setSwitchCost(uint32_t us);
+
+// Times the scheduler handed the CPU to a task
+uint64_t contextSwitches();
+
+}
+
+#endif // NATIVE_SIM_H
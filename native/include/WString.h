@@ -0,0 +1,60 @@
+#ifndef NATIVE_WSTRING_H
+#define NATIVE_WSTRING_H
+
+#include <cstddef>
+#include <string>
+
+// Arduino String on top of std::string; covers the members the apps use
+class String {
+public:
+    String() {}
+    String(const char* text) : value_(text != nullptr ? text : "") {}
+    String(const char* text, size_t len) : value_(text, len) {}
+    String(const std::string& text) : value_(text) {}
+    String(char c) : value_(1, c) {}
+    explicit String(int value) : value_(std::to_string(value)) {}
+    explicit String(unsigned int value) : value_(std::to_string(value)) {}
+    explicit String(long value) : value_(std::to_string(value)) {}
+    explicit String(unsigned long value) : value_(std::to_string(value)) {}
+    explicit String(float value, unsigned int decimals = 2);
+    explicit String(double value, unsigned int decimals = 2);
+
+    const char* c_str() const { return value_.c_str(); }
+    unsigned int length() const { return (unsigned int)value_.size(); }
+    bool isEmpty() const { return value_.empty(); }
+    char operator[](unsigned int index) const { return index < value_.size() ? value_[index] : '\0'; }
+    char charAt(unsigned int index) const { return (*this)[index]; }
+
+    String& operator+=(const String& other) { value_ += other.value_; return *this; }
+    String& operator+=(const char* other) { value_ += (other != nullptr ? other : ""); return *this; }
+    String& operator+=(char c) { value_ += c; return *this; }
+    bool concat(const String& other) { value_ += other.value_; return true; }
+
+    bool operator==(const String& other) const { return value_ == other.value_; }
+    bool operator==(const char* other) const { return other != nullptr && value_ == other; }
+    bool operator!=(const String& other) const { return !(*this == other); }
+    bool operator!=(const char* other) const { return !(*this == other); }
+    bool equals(const String& other) const { return *this == other; }
+    bool equalsIgnoreCase(const String& other) const;
+
+    void trim();
+    void toUpperCase();
+    void toLowerCase();
+    bool startsWith(const String& prefix) const { return value_.compare(0, prefix.value_.size(), prefix.value_) == 0; }
+    bool endsWith(const String& suffix) const;
+    int indexOf(char c, unsigned int from = 0) const;
+    int indexOf(const String& text, unsigned int from = 0) const;
+    String substring(unsigned int from) const;
+    String substring(unsigned int from, unsigned int to) const;
+    long toInt() const;
+    float toFloat() const;
+
+    friend String operator+(const String& a, const String& b) { return String(a.value_ + b.value_); }
+    friend String operator+(const String& a, const char* b) { String r(a); r += b; return r; }
+    friend String operator+(const char* a, const String& b) { String r(a); r += b; return r; }
+
+private:
+    std::string value_;
+};
+
+#endif // NATIVE_WSTRING_H
@@ -0,0 +1,64 @@
+#ifndef NATIVE_WIRE_H
+#define NATIVE_WIRE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifndef NATIVE_I2C_MUX
+#define NATIVE_I2C_MUX 0
+#endif
+
+#ifndef NATIVE_I2C_MUX_ADDRESS
+#define NATIVE_I2C_MUX_ADDRESS 0x70
+#endif
+
+// Simulated I2C target. The first byte of a write selects a register, the rest is written
+// from there; reads continue from the selected register.
+class NativeI2cDevice {
+public:
+    virtual ~NativeI2cDevice() {}
+    virtual void i2cWrite(const uint8_t* data, size_t len) = 0;
+    virtual void i2cRead(uint8_t* out, size_t len) = 0;
+};
+
+// I2C bus stub. Transactions to addresses without an attached device succeed and reads
+// return zeros. The MPU6050 is simulated both at the driver level (Adafruit_MPU6050.h) and
+// as register-level devices for code that drives its FIFO directly: at 0x68 and 0x69 on the
+// main bus, or with -DNATIVE_I2C_MUX=1 at 0x68 and 0x69 behind each channel of a TCA9548A
+// multiplexer at NATIVE_I2C_MUX_ADDRESS (a write of a channel bitmask opens channels, a read
+// returns it; the mux answers in both layouts). Under NativeSim, every transaction charges
+// its bus time (9 clocks per byte) to the caller.
+class TwoWire {
+public:
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0);
+    bool setClock(uint32_t frequency);
+    uint32_t getClock() const { return clock_; }
+
+    void beginTransmission(uint8_t address);
+    uint8_t endTransmission(bool sendStop = true);
+    size_t write(uint8_t byte);
+    size_t write(const uint8_t* data, size_t len);
+    size_t requestFrom(uint8_t address, size_t len, bool sendStop = true);
+    int available();
+    int read();
+
+    static const uint8_t MUX_CHANNELS = 8;
+
+    // Route transactions for address to device (nullptr detaches), on the main bus or behind
+    // mux channel 0-7
+    static void attachDevice(uint8_t address, NativeI2cDevice* device, int channel = -1);
+
+private:
+    uint32_t clock_ = 100000;
+    uint8_t address_ = 0;
+    std::vector<uint8_t> tx_;
+    std::vector<uint8_t> rx_;
+    size_t rxPos_ = 0;
+
+    void chargeBusTime(size_t bytes);
+};
+
+extern TwoWire Wire;
+
+#endif // NATIVE_WIRE_H
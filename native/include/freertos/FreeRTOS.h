@@ -0,0 +1,43 @@
+#ifndef NATIVE_FREERTOS_H
+#define NATIVE_FREERTOS_H
+
+// Host shim for the subset of FreeRTOS used by the layers. Tasks are POSIX threads, one tick
+// is one millisecond, and priorities/affinity are accepted but not enforced.
+
+#include <cstdint>
+#include <cstddef>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdTRUE  1
+#define pdFALSE 0
+#define pdPASS  1
+#define pdFAIL  0
+
+#define portMAX_DELAY       ((TickType_t)0xFFFFFFFFu)
+#define configTICK_RATE_HZ  1000
+#define portTICK_PERIOD_MS  (1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+#define configMAX_PRIORITIES 25
+#define tskNO_AFFINITY      0x7FFFFFFF
+
+// Critical sections map to a process-wide recursive lock
+typedef struct {
+    uint32_t owner;
+    uint32_t count;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {0, 0}
+
+void nativeEnterCritical(portMUX_TYPE* mux);
+void nativeExitCritical(portMUX_TYPE* mux);
+
+#define portENTER_CRITICAL(mux)     nativeEnterCritical(mux)
+#define portEXIT_CRITICAL(mux)      nativeExitCritical(mux)
+#define portENTER_CRITICAL_ISR(mux) nativeEnterCritical(mux)
+#define portEXIT_CRITICAL_ISR(mux)  nativeExitCritical(mux)
+#define portYIELD_FROM_ISR(...)     ((void)0)
+
+#endif // NATIVE_FREERTOS_H
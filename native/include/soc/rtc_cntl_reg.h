@@ -0,0 +1,9 @@
+#ifndef NATIVE_SOC_RTC_CNTL_REG_H
+#define NATIVE_SOC_RTC_CNTL_REG_H
+
+// Register writes are no-ops on the host
+#define RTC_CNTL_BROWN_OUT_REG 0
+#define WRITE_PERI_REG(addr, val) ((void)(addr), (void)(val))
+#define READ_PERI_REG(addr) ((void)(addr), 0u)
+
+#endif // NATIVE_SOC_RTC_CNTL_REG_H
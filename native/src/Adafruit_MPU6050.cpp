@@ -0,0 +1,372 @@
+#include <Adafruit_MPU6050.h>
+#include <Arduino.h>
+#include <NativeSim.h>
+#include <esp_timer.h>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+// GPIO the simulated INT pin is wired to (the firmware default, MPU_INT_PIN)
+#ifndef NATIVE_MPU_INT_PIN
+#define NATIVE_MPU_INT_PIN 13
+#endif
+
+// Sensor clock error in parts per million (positive: samples come slower than nominal); the
+// real part is specified to +-1%
+#ifndef NATIVE_MPU_CLOCK_PPM
+#define NATIVE_MPU_CLOCK_PPM 0
+#endif
+
+namespace {
+
+const float GRAVITY = 9.80665f;
+const float TWO_PI_F = 6.2831853f;
+
+std::mutex motionMutex;
+Adafruit_MPU6050::MotionModel motionModel;
+
+// Level board with a 0.5 Hz tilt wobble and a matching gyro rate
+void defaultMotion(uint64_t timeUs, float accel[3], float gyro[3]) {
+    float t = timeUs / 1e6f;
+    float wobble = 0.05f * sinf(TWO_PI_F * 0.5f * t);
+    accel[0] = GRAVITY * wobble;
+    accel[1] = 0.02f * cosf(TWO_PI_F * 3.0f * t);
+    accel[2] = GRAVITY * (1.0f - 0.5f * wobble * wobble);
+    gyro[0] = 0.0f;
+    gyro[1] = 0.05f * TWO_PI_F * 0.5f * cosf(TWO_PI_F * 0.5f * t);
+    gyro[2] = 0.001f;
+}
+
+void sampleMotion(uint64_t timeUs, float accel[3], float gyro[3]) {
+    std::lock_guard<std::mutex> guard(motionMutex);
+    if (motionModel) {
+        motionModel(timeUs, accel, gyro);
+    } else {
+        defaultMotion(timeUs, accel, gyro);
+    }
+}
+
+int16_t toRaw(float value, float lsbPerUnit) {
+    float raw = value * lsbPerUnit;
+    if (raw > 32767.0f) {
+        return 32767;
+    }
+    if (raw < -32768.0f) {
+        return -32768;
+    }
+    return (int16_t)lrintf(raw);
+}
+
+// Register-level MPU6050: sample-rate divider, DLPF, ranges, data registers and the
+// 1024-byte FIFO with accel + gyro enabled. FIFO samples are produced lazily from the clock
+// when the bus is accessed, and overwrite the oldest bytes once the FIFO is full. With
+// DATA_RDY_EN set, a pulse is raised on NATIVE_MPU_INT_PIN at every sample while the FIFO runs.
+// The sample clock runs NATIVE_MPU_CLOCK_PPM off nominal.
+class Mpu6050Registers : public NativeI2cDevice {
+public:
+    Mpu6050Registers() : intTask_(nullptr) { reset(); }
+
+    void i2cWrite(const uint8_t* data, size_t len) override {
+        std::lock_guard<std::mutex> guard(mutex_);
+        pointer_ = data[0] & 0x7F;
+        for (size_t i = 1; i < len; i++) {
+            writeRegister(pointer_, data[i]);
+            pointer_ = (pointer_ + 1) & 0x7F;
+        }
+    }
+
+    void i2cRead(uint8_t* out, size_t len) override {
+        std::lock_guard<std::mutex> guard(mutex_);
+        uint64_t now = esp_timer_get_time();
+        produce(now);
+        for (size_t i = 0; i < len; i++) {
+            if (pointer_ == REG_FIFO_R_W) {
+                // FIFO reads don't advance the pointer
+                if (fifo_.empty()) {
+                    out[i] = 0;
+                } else {
+                    out[i] = fifo_.front();
+                    fifo_.pop_front();
+                }
+                continue;
+            }
+            out[i] = readRegister(pointer_, now);
+            pointer_ = (pointer_ + 1) & 0x7F;
+        }
+    }
+
+private:
+    static const uint8_t REG_SMPLRT_DIV = 0x19;
+    static const uint8_t REG_CONFIG = 0x1A;
+    static const uint8_t REG_GYRO_CONFIG = 0x1B;
+    static const uint8_t REG_ACCEL_CONFIG = 0x1C;
+    static const uint8_t REG_FIFO_EN = 0x23;
+    static const uint8_t REG_INT_ENABLE = 0x38;
+    static const uint8_t REG_INT_STATUS = 0x3A;
+    static const uint8_t REG_ACCEL_XOUT_H = 0x3B;
+    static const uint8_t REG_GYRO_ZOUT_L = 0x48;
+    static const uint8_t REG_USER_CTRL = 0x6A;
+    static const uint8_t REG_PWR_MGMT_1 = 0x6B;
+    static const uint8_t REG_FIFO_COUNT_H = 0x72;
+    static const uint8_t REG_FIFO_COUNT_L = 0x73;
+    static const uint8_t REG_FIFO_R_W = 0x74;
+    static const uint8_t REG_WHO_AM_I = 0x75;
+    static const size_t FIFO_SIZE = 1024;
+    static const size_t SAMPLE_BYTES = 12;
+
+    std::mutex mutex_;
+    uint8_t regs_[128];
+    uint8_t pointer_;
+    std::deque<uint8_t> fifo_;
+    uint64_t fifoStartUs_;
+    uint64_t produced_;
+    uint64_t pulsed_;      // DATA_RDY pulses raised since the FIFO started
+    TaskHandle_t intTask_;
+
+    void reset() {
+        memset(regs_, 0, sizeof(regs_));
+        regs_[REG_PWR_MGMT_1] = 0x40; // Asleep after reset, like the chip
+        pointer_ = 0;
+        fifo_.clear();
+        fifoStartUs_ = 0;
+        produced_ = 0;
+        pulsed_ = 0;
+    }
+
+    bool fifoRunning() const {
+        return (regs_[REG_USER_CTRL] & 0x40) != 0 && (regs_[REG_FIFO_EN] & 0x78) == 0x78;
+    }
+
+    double periodUs() const {
+        uint8_t dlpf = regs_[REG_CONFIG] & 0x07;
+        double baseHz = (dlpf == 0 || dlpf == 7) ? 8000 : 1000;
+        return 1e6 * (1 + regs_[REG_SMPLRT_DIV]) / baseHz * (1.0 + NATIVE_MPU_CLOCK_PPM * 1e-6);
+    }
+
+    // Samples the clock has produced by now since the FIFO started
+    uint64_t samplesDue(uint64_t now) const {
+        return (uint64_t)((now - fifoStartUs_) / periodUs());
+    }
+
+    void writeRegister(uint8_t reg, uint8_t value) {
+        if (reg == REG_PWR_MGMT_1 && (value & 0x80)) {
+            reset();
+            return;
+        }
+        if (reg == REG_USER_CTRL) {
+            bool wasRunning = fifoRunning();
+            if (value & 0x04) {
+                fifo_.clear();
+            }
+            regs_[reg] = value & ~0x04; // FIFO_RESET self-clears
+            if (!wasRunning && fifoRunning()) {
+                fifoStartUs_ = esp_timer_get_time();
+                produced_ = 0;
+                pulsed_ = 0;
+            }
+            return;
+        }
+        if (reg == REG_INT_ENABLE && (value & 0x01) && intTask_ == nullptr) {
+            xTaskCreate(interruptTask, "MpuIntPin", 2048, this, configMAX_PRIORITIES - 1, &intTask_);
+        }
+        if (reg == REG_FIFO_R_W || reg == REG_WHO_AM_I) {
+            return;
+        }
+        regs_[reg] = value;
+    }
+
+    void encodeSample(uint64_t timeUs, uint8_t out[14]) const {
+        float a[3];
+        float g[3];
+        sampleMotion(timeUs, a, g);
+        float accelLsb = 16384.0f / (1 << ((regs_[REG_ACCEL_CONFIG] >> 3) & 0x03)) / GRAVITY;
+        float gyroLsb = 131.0f / (1 << ((regs_[REG_GYRO_CONFIG] >> 3) & 0x03)) * 57.29578f;
+        int16_t values[7] = {
+            toRaw(a[0], accelLsb), toRaw(a[1], accelLsb), toRaw(a[2], accelLsb),
+            (int16_t)((25.0f - 36.53f) * 340.0f), // TEMP_OUT for 25 C
+            toRaw(g[0], gyroLsb), toRaw(g[1], gyroLsb), toRaw(g[2], gyroLsb)
+        };
+        for (int i = 0; i < 7; i++) {
+            out[2 * i] = (uint8_t)((uint16_t)values[i] >> 8);
+            out[2 * i + 1] = (uint8_t)values[i];
+        }
+    }
+
+    void produce(uint64_t now) {
+        if (!fifoRunning() || now < fifoStartUs_) {
+            return;
+        }
+        double period = periodUs();
+        uint64_t due = samplesDue(now);
+
+        // After a long stall only the newest FIFO-full of samples can matter
+        uint64_t keep = FIFO_SIZE / SAMPLE_BYTES + 1;
+        if (due > produced_ + keep) {
+            produced_ = due - keep;
+            regs_[REG_INT_STATUS] |= 0x10;
+        }
+
+        uint8_t sample[14];
+        while (produced_ < due) {
+            produced_++;
+            encodeSample(fifoStartUs_ + (uint64_t)(produced_ * period), sample);
+            fifo_.insert(fifo_.end(), sample, sample + 6);      // ACCEL_XOUT_H..ACCEL_ZOUT_L
+            fifo_.insert(fifo_.end(), sample + 8, sample + 14); // GYRO_XOUT_H..GYRO_ZOUT_L
+            while (fifo_.size() > FIFO_SIZE) {
+                fifo_.pop_front();
+                regs_[REG_INT_STATUS] |= 0x10; // FIFO_OFLOW_INT
+            }
+        }
+    }
+
+    static void sleepUntil(uint64_t dueUs) {
+        int64_t waitUs = (int64_t)dueUs - esp_timer_get_time();
+        if (waitUs <= 0) {
+            return;
+        }
+        if (!NativeSim::active()) {
+            std::this_thread::sleep_for(std::chrono::microseconds(waitUs));
+            return;
+        }
+        // Whole ticks asleep, then the rest as busy time so the pulse lands on the sample
+        if (waitUs >= 1000 * portTICK_PERIOD_MS) {
+            vTaskDelay((TickType_t)(waitUs / (1000 * portTICK_PERIOD_MS)));
+        }
+        waitUs = (int64_t)dueUs - esp_timer_get_time();
+        if (waitUs > 0) {
+            NativeSim::advance((uint64_t)waitUs);
+        }
+    }
+
+    static void interruptTask(void* parameter) {
+        Mpu6050Registers* self = static_cast<Mpu6050Registers*>(parameter);
+        while (true) {
+            uint64_t dueUs = 0;
+            {
+                std::lock_guard<std::mutex> guard(self->mutex_);
+                if (self->fifoRunning() && (self->regs_[REG_INT_ENABLE] & 0x01)) {
+                    dueUs = self->fifoStartUs_ + (uint64_t)ceil((self->pulsed_ + 1) * self->periodUs());
+                }
+            }
+            if (dueUs == 0) {
+                vTaskDelay(pdMS_TO_TICKS(10));
+                continue;
+            }
+
+            sleepUntil(dueUs);
+
+            {
+                std::lock_guard<std::mutex> guard(self->mutex_);
+                if (!self->fifoRunning()) {
+                    continue;
+                }
+                // A host that fell behind gets one pulse for the samples it missed, like a
+                // level-triggered line seen late
+                uint64_t now = esp_timer_get_time();
+                self->produce(now);
+                uint64_t due = self->samplesDue(now);
+                if (due <= self->pulsed_) {
+                    continue; // FIFO restarted while asleep
+                }
+                self->pulsed_ = due;
+            }
+            nativeRaiseInterrupt(NATIVE_MPU_INT_PIN);
+        }
+    }
+
+    uint8_t readRegister(uint8_t reg, uint64_t now) {
+        if (reg >= REG_ACCEL_XOUT_H && reg <= REG_GYRO_ZOUT_L) {
+            uint8_t sample[14];
+            encodeSample(now, sample);
+            return sample[reg - REG_ACCEL_XOUT_H];
+        }
+        switch (reg) {
+        case REG_FIFO_COUNT_H:
+            return (uint8_t)(fifo_.size() >> 8);
+        case REG_FIFO_COUNT_L:
+            return (uint8_t)fifo_.size();
+        case REG_WHO_AM_I:
+            return 0x68;
+        case REG_INT_STATUS: {
+            uint8_t status = regs_[reg];
+            regs_[reg] = 0; // Cleared on read
+            return status;
+        }
+        default:
+            return regs_[reg];
+        }
+    }
+};
+
+// 0x68 and 0x69 on the main bus, or behind every mux channel (NATIVE_I2C_MUX). Each model has
+// its own sample clock; only the firmware's first sensor enables DATA_RDY, so one model drives
+// the INT pin.
+#if NATIVE_I2C_MUX
+Mpu6050Registers registerModels[2 * TwoWire::MUX_CHANNELS];
+
+struct RegisterModelAttach {
+    RegisterModelAttach() {
+        for (int channel = 0; channel < TwoWire::MUX_CHANNELS; channel++) {
+            TwoWire::attachDevice(0x68, &registerModels[2 * channel], channel);
+            TwoWire::attachDevice(0x69, &registerModels[2 * channel + 1], channel);
+        }
+    }
+} registerModelAttach;
+#else
+Mpu6050Registers registerModels[2];
+
+struct RegisterModelAttach {
+    RegisterModelAttach() {
+        TwoWire::attachDevice(0x68, &registerModels[0]);
+        TwoWire::attachDevice(0x69, &registerModels[1]);
+    }
+} registerModelAttach;
+#endif
+
+void fillEvent(sensors_event_t* event, int32_t type, const float values[3], int32_t timestampMs) {
+    if (event == nullptr) {
+        return;
+    }
+    memset(event, 0, sizeof(*event));
+    event->version = sizeof(sensors_event_t);
+    event->type = type;
+    event->timestamp = timestampMs;
+    event->data[0] = values[0];
+    event->data[1] = values[1];
+    event->data[2] = values[2];
+}
+
+}
+
+bool Adafruit_MPU6050::begin(uint8_t address, TwoWire* wire, int32_t sensorId) {
+    (void)address;
+    (void)wire;
+    (void)sensorId;
+    return true;
+}
+
+bool Adafruit_MPU6050::getEvent(sensors_event_t* accel, sensors_event_t* gyro, sensors_event_t* temp) {
+    uint64_t now = esp_timer_get_time();
+    float a[3];
+    float g[3];
+    sampleMotion(now, a, g);
+
+    int32_t timestampMs = (int32_t)(now / 1000);
+    fillEvent(accel, 1, a, timestampMs);  // SENSOR_TYPE_ACCELEROMETER
+    fillEvent(gyro, 4, g, timestampMs);   // SENSOR_TYPE_GYROSCOPE
+    if (temp != nullptr) {
+        memset(temp, 0, sizeof(*temp));
+        temp->type = 13;                  // SENSOR_TYPE_AMBIENT_TEMPERATURE
+        temp->timestamp = timestampMs;
+        temp->temperature = 25.0f;
+    }
+    return true;
+}
+
+void Adafruit_MPU6050::setMotion(MotionModel model) {
+    std::lock_guard<std::mutex> guard(motionMutex);
+    motionModel = model;
+}
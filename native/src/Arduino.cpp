@@ -0,0 +1,135 @@
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <NativeSim.h>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+// Timing, GPIO and ESP info for the host build
+
+namespace {
+
+const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+const int GPIO_COUNT = 40;
+uint8_t gpioLevels[GPIO_COUNT];
+std::mutex gpioMutex;
+
+struct InterruptHandler {
+    void (*plain)();
+    void (*withArg)(void*);
+    void* arg;
+};
+InterruptHandler interruptHandlers[GPIO_COUNT];
+
+}
+
+int64_t esp_timer_get_time() {
+    if (NativeSim::active()) {
+        return (int64_t)NativeSim::nowUs();
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+unsigned long millis() {
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+unsigned long micros() {
+    return (uint32_t)esp_timer_get_time();
+}
+
+void delay(uint32_t ms) {
+    vTaskDelay(pdMS_TO_TICKS(ms));
+}
+
+void delayMicroseconds(uint32_t us) {
+    if (NativeSim::active()) {
+        NativeSim::advance(us);
+        return;
+    }
+
+    // Busy-wait like the ESP32 core; sleeping would overshoot by tens of microseconds
+    int64_t until = esp_timer_get_time() + us;
+    while (esp_timer_get_time() < until) {
+    }
+}
+
+void yield() {
+    taskYIELD();
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    (void)pin;
+    (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    if (pin < GPIO_COUNT) {
+        std::lock_guard<std::mutex> guard(gpioMutex);
+        gpioLevels[pin] = value ? HIGH : LOW;
+    }
+}
+
+int digitalRead(uint8_t pin) {
+    if (pin >= GPIO_COUNT) {
+        return LOW;
+    }
+    std::lock_guard<std::mutex> guard(gpioMutex);
+    return gpioLevels[pin];
+}
+
+int digitalPinToInterrupt(uint8_t pin) {
+    return pin;
+}
+
+void attachInterrupt(uint8_t pin, void (*handler)(), int mode) {
+    (void)mode;
+    if (pin < GPIO_COUNT) {
+        std::lock_guard<std::mutex> guard(gpioMutex);
+        interruptHandlers[pin] = InterruptHandler{ handler, nullptr, nullptr };
+    }
+}
+
+void attachInterruptArg(uint8_t pin, void (*handler)(void*), void* arg, int mode) {
+    (void)mode;
+    if (pin < GPIO_COUNT) {
+        std::lock_guard<std::mutex> guard(gpioMutex);
+        interruptHandlers[pin] = InterruptHandler{ nullptr, handler, arg };
+    }
+}
+
+void detachInterrupt(uint8_t pin) {
+    if (pin < GPIO_COUNT) {
+        std::lock_guard<std::mutex> guard(gpioMutex);
+        interruptHandlers[pin] = InterruptHandler{ nullptr, nullptr, nullptr };
+    }
+}
+
+void nativeRaiseInterrupt(uint8_t pin) {
+    if (pin >= GPIO_COUNT) {
+        return;
+    }
+    InterruptHandler handler;
+    {
+        std::lock_guard<std::mutex> guard(gpioMutex);
+        handler = interruptHandlers[pin];
+    }
+    if (handler.plain != nullptr) {
+        handler.plain();
+    } else if (handler.withArg != nullptr) {
+        handler.withArg(handler.arg);
+    }
+}
+
+EspClass ESP;
+
+uint32_t EspClass::getFreeHeap() {
+    return 200 * 1024; // Nominal figure; host heap usage isn't comparable
+}
+
+void EspClass::restart() {
+    Serial.println("[native] ESP.restart() requested, exiting");
+    Serial.flush();
+    std::_Exit(0);
+}
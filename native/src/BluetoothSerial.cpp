@@ -0,0 +1,120 @@
+#include <BluetoothSerial.h>
+#include <cstring>
+
+std::atomic<BluetoothSerial*> BluetoothSerial::hostInstance_(nullptr);
+
+BluetoothSerial* BluetoothSerial::host() {
+    return hostInstance_.load();
+}
+
+bool BluetoothSerial::begin(const String& deviceName, bool isMaster) {
+    (void)deviceName;
+    (void)isMaster;
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        started_ = true;
+    }
+    hostInstance_ = this;
+    return true;
+}
+
+void BluetoothSerial::end() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    started_ = false;
+}
+
+BluetoothSerial::~BluetoothSerial() {
+    BluetoothSerial* expected = this;
+    hostInstance_.compare_exchange_strong(expected, nullptr);
+}
+
+bool BluetoothSerial::connected(int timeoutMs) {
+    (void)timeoutMs;
+    std::lock_guard<std::mutex> guard(mutex_);
+    return connectedOverride_ >= 0 ? connectedOverride_ == 1 : started_;
+}
+
+int BluetoothSerial::available() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return (int)rx_.size();
+}
+
+int BluetoothSerial::read() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (rx_.empty()) {
+        return -1;
+    }
+    int byte = rx_.front();
+    rx_.pop_front();
+    return byte;
+}
+
+int BluetoothSerial::peek() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return rx_.empty() ? -1 : rx_.front();
+}
+
+size_t BluetoothSerial::readBytes(uint8_t* buffer, size_t len) {
+    // Non-blocking: the apps only read what available() reported
+    std::lock_guard<std::mutex> guard(mutex_);
+    size_t count = 0;
+    while (count < len && !rx_.empty()) {
+        buffer[count++] = rx_.front();
+        rx_.pop_front();
+    }
+    return count;
+}
+
+size_t BluetoothSerial::write(const uint8_t* data, size_t len) {
+    TxListener listener;
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        bool isConnected = connectedOverride_ >= 0 ? connectedOverride_ == 1 : started_;
+        if (!isConnected || data == nullptr || len == 0) {
+            return 0;
+        }
+        txTotal_ += len;
+        if (txListener_) {
+            listener = txListener_;
+        } else {
+            tx_.insert(tx_.end(), data, data + len);
+        }
+    }
+
+    // Outside the lock so the listener may call back into the host API
+    if (listener) {
+        listener(data, len);
+    }
+    return len;
+}
+
+void BluetoothSerial::hostSetConnected(bool connected) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    connectedOverride_ = connected ? 1 : 0;
+}
+
+void BluetoothSerial::hostInject(const uint8_t* data, size_t len) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    rx_.insert(rx_.end(), data, data + len);
+}
+
+void BluetoothSerial::hostInject(const char* text) {
+    hostInject(reinterpret_cast<const uint8_t*>(text), strlen(text));
+}
+
+size_t BluetoothSerial::hostTake(std::vector<uint8_t>& out) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    out.swap(tx_);
+    tx_.clear();
+    return out.size();
+}
+
+void BluetoothSerial::hostSetTxListener(TxListener listener) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    txListener_ = listener;
+}
+
+size_t BluetoothSerial::hostTxBytes() const {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return txTotal_;
+}
@@ -0,0 +1,79 @@
+#include <FS.h>
+#include <cerrno>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs {
+
+size_t File::read(uint8_t* buffer, size_t len) {
+    return handle_ ? fread(buffer, 1, len, handle_.get()) : 0;
+}
+
+size_t File::write(const uint8_t* data, size_t len) {
+    return handle_ ? fwrite(data, 1, len, handle_.get()) : 0;
+}
+
+size_t File::size() const {
+    if (!handle_) {
+        return 0;
+    }
+    struct stat info;
+    fflush(handle_.get());
+    if (fstat(fileno(handle_.get()), &info) != 0) {
+        return 0;
+    }
+    return (size_t)info.st_size;
+}
+
+bool File::seek(uint32_t position) {
+    return handle_ && fseek(handle_.get(), position, SEEK_SET) == 0;
+}
+
+size_t File::position() const {
+    return handle_ ? (size_t)ftell(handle_.get()) : 0;
+}
+
+void File::flush() {
+    if (handle_) {
+        fflush(handle_.get());
+    }
+}
+
+std::string FS::hostPath(const char* path) const {
+    std::string relative = (path != nullptr) ? path : "";
+    if (!relative.empty() && relative[0] == '/') {
+        relative.erase(0, 1);
+    }
+    return root_ + "/" + relative;
+}
+
+File FS::open(const char* path, const char* mode) {
+    std::string full = hostPath(path);
+    // Binary mode so byte counts match the device
+    std::string hostMode = std::string(mode != nullptr ? mode : "r") + "b";
+    return File(fopen(full.c_str(), hostMode.c_str()));
+}
+
+bool FS::exists(const char* path) {
+    struct stat info;
+    return stat(hostPath(path).c_str(), &info) == 0;
+}
+
+bool FS::remove(const char* path) {
+    return ::remove(hostPath(path).c_str()) == 0;
+}
+
+bool FS::rename(const char* from, const char* to) {
+    return ::rename(hostPath(from).c_str(), hostPath(to).c_str()) == 0;
+}
+
+bool FS::mkdir(const char* path) {
+    return ::mkdir(hostPath(path).c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+bool FS::rmdir(const char* path) {
+    return ::rmdir(hostPath(path).c_str()) == 0;
+}
+
+} // namespace fs
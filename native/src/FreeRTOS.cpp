@@ -0,0 +1,761 @@
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <freertos/queue.h>
+#include <Arduino.h>
+#include <NativeSim.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// FreeRTOS on POSIX threads. Every blocking call waits on a condition variable in bounded
+// slices so a task marked for deletion notices it promptly and unwinds out of its function.
+//
+// With NativeSim::begin() the same calls run on a virtual-time scheduler instead: exactly one
+// task thread runs at a time, ready tasks run in FIFO order, and when every task is blocked
+// the clock jumps to the earliest wake-up. Runs are then deterministic and as fast as the
+// host allows.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Upper bound on how long a blocked task takes to notice vTaskDelete
+const std::chrono::milliseconds DELETE_POLL(20);
+// How long vTaskDelete waits for another task's thread to leave
+const std::chrono::milliseconds DELETE_JOIN_TIMEOUT(1000);
+
+struct TaskDeleted {};
+
+struct NativeTask {
+    std::string name;
+    TaskFunction_t function = nullptr;
+    void* parameter = nullptr;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    uint32_t notifyValue = 0;
+    std::atomic<bool> deleteRequested{false};
+    bool exited = false;
+
+    // Virtual-time scheduling; guarded by the scheduler mutex
+    std::condition_variable turn;
+    const void* waitChannel = nullptr;
+    uint64_t wakeAtUs = 0;
+};
+
+const uint64_t WAIT_FOREVER = UINT64_MAX;
+
+struct VirtualScheduler {
+    std::mutex mutex;
+    std::atomic<bool> active{false};
+    std::atomic<uint64_t> nowUs{0};
+    NativeTask* running = nullptr;
+    std::deque<NativeTask*> ready;
+    std::vector<NativeTask*> blocked; // In blocking order, so wake-ups are deterministic
+    uint64_t contextSwitches = 0;
+    uint32_t switchCostUs = 0;
+};
+
+VirtualScheduler sim;
+
+thread_local NativeTask* currentTask = nullptr;
+
+NativeTask* selfTask() {
+    if (currentTask == nullptr) {
+        // setup()/loop() and other foreign threads get a handle on first use
+        currentTask = new NativeTask();
+        currentTask->name = "main";
+    }
+    return currentTask;
+}
+
+void checkDeleted() {
+    if (currentTask != nullptr && currentTask->deleteRequested.load()) {
+        throw TaskDeleted();
+    }
+}
+
+// Virtual-time scheduler. Callers hold sim.mutex where the name ends in Locked.
+
+void simWakeExpiredLocked() {
+    uint64_t now = sim.nowUs.load();
+    for (auto it = sim.blocked.begin(); it != sim.blocked.end();) {
+        if ((*it)->wakeAtUs <= now) {
+            sim.ready.push_back(*it);
+            it = sim.blocked.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void simWakeTaskLocked(NativeTask* task) {
+    for (auto it = sim.blocked.begin(); it != sim.blocked.end(); ++it) {
+        if (*it == task) {
+            sim.blocked.erase(it);
+            sim.ready.push_back(task);
+            return;
+        }
+    }
+}
+
+// Hand the CPU to the next ready task, letting time pass first if nothing is ready
+void simDispatchLocked() {
+    if (sim.ready.empty()) {
+        uint64_t earliest = WAIT_FOREVER;
+        for (NativeTask* task : sim.blocked) {
+            earliest = std::min(earliest, task->wakeAtUs);
+        }
+        if (earliest == WAIT_FOREVER) {
+            fprintf(stderr, "[native] Simulation deadlock: every task is blocked without a timeout\n");
+            std::abort();
+        }
+        if (earliest > sim.nowUs.load()) {
+            sim.nowUs = earliest;
+        }
+        simWakeExpiredLocked();
+    }
+
+    NativeTask* previous = sim.running;
+    sim.running = sim.ready.front();
+    sim.ready.pop_front();
+    if (sim.running != previous) {
+        sim.contextSwitches++;
+        if (sim.switchCostUs > 0) {
+            sim.nowUs += sim.switchCostUs;
+            simWakeExpiredLocked();
+        }
+    }
+    sim.running->turn.notify_one();
+}
+
+void simWaitTurnLocked(std::unique_lock<std::mutex>& lock, NativeTask* task) {
+    task->turn.wait(lock, [task] { return sim.running == task; });
+}
+
+// Block the calling task until channel is signalled or the clock reaches wakeAtUs
+void simBlock(const void* channel, uint64_t wakeAtUs) {
+    NativeTask* self = selfTask();
+    std::unique_lock<std::mutex> lock(sim.mutex);
+    self->waitChannel = channel;
+    self->wakeAtUs = wakeAtUs;
+    sim.blocked.push_back(self);
+    simDispatchLocked();
+    simWaitTurnLocked(lock, self);
+}
+
+void simYield() {
+    NativeTask* self = selfTask();
+    std::unique_lock<std::mutex> lock(sim.mutex);
+    if (sim.ready.empty()) {
+        // Nothing else can run: let a tick pass so polling loops make progress
+        uint64_t next = sim.nowUs.load() + 1000 * portTICK_PERIOD_MS;
+        for (NativeTask* task : sim.blocked) {
+            next = std::min(next, task->wakeAtUs);
+        }
+        sim.nowUs = std::max(next, sim.nowUs.load());
+        simWakeExpiredLocked();
+    }
+    sim.ready.push_back(self);
+    simDispatchLocked();
+    simWaitTurnLocked(lock, self);
+}
+
+void simSignal(const void* channel) {
+    std::lock_guard<std::mutex> guard(sim.mutex);
+    for (auto it = sim.blocked.begin(); it != sim.blocked.end();) {
+        if ((*it)->waitChannel == channel) {
+            sim.ready.push_back(*it);
+            it = sim.blocked.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void wakeOne(std::condition_variable& cv) {
+    if (sim.active.load()) {
+        simSignal(&cv);
+    } else {
+        cv.notify_one();
+    }
+}
+
+void wakeAll(std::condition_variable& cv) {
+    if (sim.active.load()) {
+        simSignal(&cv);
+    } else {
+        cv.notify_all();
+    }
+}
+
+uint64_t ticksToUs(TickType_t ticks) {
+    return (uint64_t)ticks * portTICK_PERIOD_MS * 1000;
+}
+
+// Wait until ready() holds or ticks elapse (portMAX_DELAY waits forever). Caller holds lock.
+template <typename Predicate>
+bool blockUntil(std::unique_lock<std::mutex>& lock, std::condition_variable& cv, TickType_t ticks,
+                Predicate ready) {
+    if (sim.active.load()) {
+        uint64_t wakeAtUs = ticks == portMAX_DELAY ? WAIT_FOREVER : sim.nowUs.load() + ticksToUs(ticks);
+        while (!ready()) {
+            checkDeleted();
+            if (ticks != portMAX_DELAY && sim.nowUs.load() >= wakeAtUs) {
+                return false;
+            }
+            lock.unlock();
+            simBlock(&cv, wakeAtUs);
+            // Before relocking: the object may belong to whoever is deleting this task
+            checkDeleted();
+            lock.lock();
+        }
+        return true;
+    }
+
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(ticks * portTICK_PERIOD_MS);
+    while (!ready()) {
+        checkDeleted();
+
+        Clock::time_point now = Clock::now();
+        if (ticks != portMAX_DELAY && now >= deadline) {
+            return false;
+        }
+
+        Clock::time_point wake = now + DELETE_POLL;
+        if (ticks != portMAX_DELAY && deadline < wake) {
+            wake = deadline;
+        }
+        cv.wait_until(lock, wake);
+    }
+    return true;
+}
+
+void runTask(NativeTask* task) {
+    currentTask = task;
+    if (sim.active.load()) {
+        std::unique_lock<std::mutex> lock(sim.mutex);
+        simWaitTurnLocked(lock, task);
+    }
+
+    try {
+        if (!task->deleteRequested.load()) {
+            task->function(task->parameter);
+        }
+    } catch (const TaskDeleted&) {
+        // vTaskDelete; unwinding ends the thread
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(task->mutex);
+        task->exited = true;
+        wakeAll(task->cv);
+    }
+
+    if (sim.active.load()) {
+        std::lock_guard<std::mutex> guard(sim.mutex);
+        simDispatchLocked();
+    }
+}
+
+enum SemaphoreType {
+    SEMAPHORE_MUTEX,
+    SEMAPHORE_RECURSIVE,
+    SEMAPHORE_BINARY,
+    SEMAPHORE_COUNTING
+};
+
+struct NativeSemaphore {
+    SemaphoreType type;
+    std::mutex mutex;
+    std::condition_variable cv;
+    UBaseType_t count;
+    UBaseType_t maxCount;
+    std::thread::id owner;
+    UBaseType_t recursion = 0;
+};
+
+SemaphoreHandle_t createSemaphore(SemaphoreType type, UBaseType_t maxCount, UBaseType_t initialCount) {
+    NativeSemaphore* semaphore = new NativeSemaphore();
+    semaphore->type = type;
+    semaphore->maxCount = maxCount;
+    semaphore->count = initialCount;
+    return semaphore;
+}
+
+struct NativeQueue {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<uint8_t> storage; // length * itemSize, used as a ring
+    UBaseType_t length;
+    UBaseType_t itemSize;
+    UBaseType_t head = 0;
+    UBaseType_t count = 0;
+};
+
+BaseType_t queueSend(QueueHandle_t handle, const void* item, TickType_t ticks, bool toFront) {
+    NativeQueue* queue = static_cast<NativeQueue*>(handle);
+    if (queue == nullptr) {
+        return pdFAIL;
+    }
+
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!blockUntil(lock, queue->cv, ticks, [queue] { return queue->count < queue->length; })) {
+        return pdFALSE; // errQUEUE_FULL
+    }
+
+    UBaseType_t slot;
+    if (toFront) {
+        queue->head = (queue->head + queue->length - 1) % queue->length;
+        slot = queue->head;
+    } else {
+        slot = (queue->head + queue->count) % queue->length;
+    }
+    memcpy(queue->storage.data() + slot * queue->itemSize, item, queue->itemSize);
+    queue->count++;
+    wakeAll(queue->cv);
+    return pdTRUE;
+}
+
+BaseType_t queueReceive(QueueHandle_t handle, void* item, TickType_t ticks, bool remove) {
+    NativeQueue* queue = static_cast<NativeQueue*>(handle);
+    if (queue == nullptr) {
+        return pdFAIL;
+    }
+
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!blockUntil(lock, queue->cv, ticks, [queue] { return queue->count > 0; })) {
+        return pdFALSE;
+    }
+
+    memcpy(item, queue->storage.data() + queue->head * queue->itemSize, queue->itemSize);
+    if (remove) {
+        queue->head = (queue->head + 1) % queue->length;
+        queue->count--;
+        wakeAll(queue->cv);
+    }
+    return pdTRUE;
+}
+
+std::recursive_mutex criticalMutex;
+
+}
+
+// Tasks
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char* name, uint32_t stackDepth, void* parameter,
+                       UBaseType_t priority, TaskHandle_t* handle) {
+    (void)stackDepth;
+    (void)priority;
+    if (function == nullptr) {
+        return pdFAIL;
+    }
+
+    NativeTask* task = new NativeTask();
+    task->name = (name != nullptr) ? name : "";
+    task->function = function;
+    task->parameter = parameter;
+    if (handle != nullptr) {
+        *handle = task;
+    }
+
+    if (sim.active.load()) {
+        // Runs once the creator blocks or yields; no preemption in virtual time
+        std::lock_guard<std::mutex> guard(sim.mutex);
+        sim.ready.push_back(task);
+    }
+
+    std::thread(runTask, task).detach();
+    return pdPASS;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stackDepth,
+                                   void* parameter, UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t coreId) {
+    (void)coreId;
+    return xTaskCreate(function, name, stackDepth, parameter, priority, handle);
+}
+
+void vTaskDelete(TaskHandle_t handle) {
+    NativeTask* task = static_cast<NativeTask*>(handle);
+    if (task == nullptr || task == currentTask) {
+        throw TaskDeleted();
+    }
+
+    // Handles are never freed, so a stale handle held elsewhere stays safe to use
+    std::unique_lock<std::mutex> lock(task->mutex);
+    task->deleteRequested = true;
+
+    if (sim.active.load()) {
+        // Pull it out of whatever it waits on and let it unwind before returning
+        {
+            std::lock_guard<std::mutex> guard(sim.mutex);
+            simWakeTaskLocked(task);
+        }
+        blockUntil(lock, task->cv, portMAX_DELAY, [task] { return task->exited; });
+        return;
+    }
+
+    task->cv.notify_all();
+    task->cv.wait_for(lock, DELETE_JOIN_TIMEOUT, [task] { return task->exited; });
+}
+
+void vTaskDelay(TickType_t ticks) {
+    NativeTask* task = selfTask();
+    checkDeleted();
+    if (ticks == 0) {
+        taskYIELD();
+        return;
+    }
+
+    if (sim.active.load()) {
+        uint64_t wakeAtUs = sim.nowUs.load() + ticksToUs(ticks);
+        while (sim.nowUs.load() < wakeAtUs) {
+            simBlock(&task->cv, wakeAtUs);
+            checkDeleted();
+        }
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(task->mutex);
+    task->cv.wait_for(lock, std::chrono::milliseconds(ticks * portTICK_PERIOD_MS),
+                      [task] { return task->deleteRequested.load(); });
+    lock.unlock();
+    checkDeleted();
+}
+
+void vTaskDelayUntil(TickType_t* previousWakeTime, TickType_t increment) {
+    *previousWakeTime += increment;
+    int32_t remaining = (int32_t)(*previousWakeTime - xTaskGetTickCount());
+    vTaskDelay(remaining > 0 ? (TickType_t)remaining : 0);
+}
+
+TickType_t xTaskGetTickCount() {
+    return (TickType_t)(millis() / portTICK_PERIOD_MS);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    return selfTask();
+}
+
+const char* pcTaskGetName(TaskHandle_t handle) {
+    NativeTask* task = static_cast<NativeTask*>(handle != nullptr ? handle : selfTask());
+    return task->name.c_str();
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t handle) {
+    (void)handle;
+    return 0; // Host threads have large stacks; not meaningful here
+}
+
+void taskYIELD() {
+    checkDeleted();
+    if (sim.active.load()) {
+        simYield();
+        checkDeleted();
+        return;
+    }
+    std::this_thread::yield();
+}
+
+// Direct-to-task notifications (counting semaphore semantics)
+
+BaseType_t xTaskNotifyGive(TaskHandle_t handle) {
+    NativeTask* task = static_cast<NativeTask*>(handle);
+    if (task == nullptr) {
+        return pdFAIL;
+    }
+
+    std::lock_guard<std::mutex> guard(task->mutex);
+    task->notifyValue++;
+    wakeAll(task->cv);
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t handle, BaseType_t* higherPriorityTaskWoken) {
+    xTaskNotifyGive(handle);
+    if (higherPriorityTaskWoken != nullptr) {
+        *higherPriorityTaskWoken = pdFALSE;
+    }
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait) {
+    NativeTask* task = selfTask();
+    std::unique_lock<std::mutex> lock(task->mutex);
+    blockUntil(lock, task->cv, ticksToWait, [task] { return task->notifyValue > 0; });
+
+    uint32_t value = task->notifyValue;
+    if (value > 0) {
+        task->notifyValue = clearCountOnExit ? 0 : value - 1;
+    }
+    return value;
+}
+
+// Semaphores
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+    return createSemaphore(SEMAPHORE_MUTEX, 1, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() {
+    return createSemaphore(SEMAPHORE_RECURSIVE, 1, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+    return createSemaphore(SEMAPHORE_BINARY, 1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount) {
+    return createSemaphore(SEMAPHORE_COUNTING, maxCount, initialCount);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t handle, TickType_t ticksToWait) {
+    NativeSemaphore* semaphore = static_cast<NativeSemaphore*>(handle);
+    if (semaphore == nullptr) {
+        return pdFALSE;
+    }
+
+    std::unique_lock<std::mutex> lock(semaphore->mutex);
+    if (!blockUntil(lock, semaphore->cv, ticksToWait, [semaphore] { return semaphore->count > 0; })) {
+        return pdFALSE;
+    }
+
+    semaphore->count--;
+    semaphore->owner = std::this_thread::get_id();
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t handle) {
+    NativeSemaphore* semaphore = static_cast<NativeSemaphore*>(handle);
+    if (semaphore == nullptr) {
+        return pdFALSE;
+    }
+
+    std::lock_guard<std::mutex> guard(semaphore->mutex);
+    if (semaphore->count >= semaphore->maxCount) {
+        return pdFALSE; // Not taken / already full, as on FreeRTOS
+    }
+
+    semaphore->count++;
+    semaphore->owner = std::thread::id();
+    wakeOne(semaphore->cv);
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t handle, TickType_t ticksToWait) {
+    NativeSemaphore* semaphore = static_cast<NativeSemaphore*>(handle);
+    if (semaphore == nullptr) {
+        return pdFALSE;
+    }
+
+    std::unique_lock<std::mutex> lock(semaphore->mutex);
+    std::thread::id self = std::this_thread::get_id();
+    if (semaphore->recursion > 0 && semaphore->owner == self) {
+        semaphore->recursion++;
+        return pdTRUE;
+    }
+
+    if (!blockUntil(lock, semaphore->cv, ticksToWait, [semaphore] { return semaphore->count > 0; })) {
+        return pdFALSE;
+    }
+
+    semaphore->count--;
+    semaphore->owner = self;
+    semaphore->recursion = 1;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t handle) {
+    NativeSemaphore* semaphore = static_cast<NativeSemaphore*>(handle);
+    if (semaphore == nullptr) {
+        return pdFALSE;
+    }
+
+    std::lock_guard<std::mutex> guard(semaphore->mutex);
+    if (semaphore->recursion == 0 || semaphore->owner != std::this_thread::get_id()) {
+        return pdFALSE;
+    }
+
+    if (--semaphore->recursion == 0) {
+        semaphore->count++;
+        semaphore->owner = std::thread::id();
+        wakeOne(semaphore->cv);
+    }
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t handle, BaseType_t* higherPriorityTaskWoken) {
+    if (higherPriorityTaskWoken != nullptr) {
+        *higherPriorityTaskWoken = pdFALSE;
+    }
+    return xSemaphoreGive(handle);
+}
+
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t handle) {
+    NativeSemaphore* semaphore = static_cast<NativeSemaphore*>(handle);
+    if (semaphore == nullptr) {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> guard(semaphore->mutex);
+    return semaphore->count;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t handle) {
+    delete static_cast<NativeSemaphore*>(handle);
+}
+
+// Queues
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    if (length == 0 || itemSize == 0) {
+        return nullptr;
+    }
+
+    NativeQueue* queue = new NativeQueue();
+    queue->length = length;
+    queue->itemSize = itemSize;
+    queue->storage.resize((size_t)length * itemSize);
+    return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticksToWait) {
+    return queueSend(queue, item, ticksToWait, false);
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void* item, TickType_t ticksToWait) {
+    return queueSend(queue, item, ticksToWait, false);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t queue, const void* item, TickType_t ticksToWait) {
+    return queueSend(queue, item, ticksToWait, true);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void* item, BaseType_t* higherPriorityTaskWoken) {
+    if (higherPriorityTaskWoken != nullptr) {
+        *higherPriorityTaskWoken = pdFALSE;
+    }
+    return queueSend(queue, item, 0, false);
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t handle, const void* item) {
+    NativeQueue* queue = static_cast<NativeQueue*>(handle);
+    if (queue == nullptr) {
+        return pdFAIL;
+    }
+
+    // Intended for length-1 mailboxes: replace whatever is there
+    std::lock_guard<std::mutex> guard(queue->mutex);
+    queue->head = 0;
+    queue->count = 1;
+    memcpy(queue->storage.data(), item, queue->itemSize);
+    wakeAll(queue->cv);
+    return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticksToWait) {
+    return queueReceive(queue, item, ticksToWait, true);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void* item, TickType_t ticksToWait) {
+    return queueReceive(queue, item, ticksToWait, false);
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t handle) {
+    NativeQueue* queue = static_cast<NativeQueue*>(handle);
+    if (queue == nullptr) {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> guard(queue->mutex);
+    return queue->count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t handle) {
+    NativeQueue* queue = static_cast<NativeQueue*>(handle);
+    if (queue == nullptr) {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> guard(queue->mutex);
+    return queue->length - queue->count;
+}
+
+BaseType_t xQueueReset(QueueHandle_t handle) {
+    NativeQueue* queue = static_cast<NativeQueue*>(handle);
+    if (queue == nullptr) {
+        return pdFAIL;
+    }
+
+    std::lock_guard<std::mutex> guard(queue->mutex);
+    queue->head = 0;
+    queue->count = 0;
+    wakeAll(queue->cv);
+    return pdPASS;
+}
+
+void vQueueDelete(QueueHandle_t handle) {
+    delete static_cast<NativeQueue*>(handle);
+}
+
+// Critical sections
+
+void nativeEnterCritical(portMUX_TYPE* mux) {
+    criticalMutex.lock();
+    if (mux != nullptr) {
+        mux->count++;
+    }
+}
+
+void nativeExitCritical(portMUX_TYPE* mux) {
+    if (mux != nullptr) {
+        mux->count--;
+    }
+    criticalMutex.unlock();
+}
+
+// Virtual time
+
+namespace NativeSim {
+
+void begin(uint64_t startUs) {
+    std::lock_guard<std::mutex> guard(sim.mutex);
+    sim.nowUs = startUs;
+    sim.running = selfTask();
+    sim.active = true;
+}
+
+bool active() {
+    return sim.active.load();
+}
+
+uint64_t nowUs() {
+    return sim.nowUs.load();
+}
+
+void advance(uint64_t us) {
+    std::lock_guard<std::mutex> guard(sim.mutex);
+    sim.nowUs += us;
+    simWakeExpiredLocked();
+}
+
+void setSwitchCost(uint32_t us) {
+    std::lock_guard<std::mutex> guard(sim.mutex);
+    sim.switchCostUs = us;
+}
+
+uint64_t contextSwitches() {
+    std::lock_guard<std::mutex> guard(sim.mutex);
+    return sim.contextSwitches;
+}
+
+}
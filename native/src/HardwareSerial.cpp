@@ -0,0 +1,82 @@
+#include <HardwareSerial.h>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+HardwareSerial Serial;
+
+namespace {
+std::mutex outputMutex;
+}
+
+int HardwareSerial::printf(const char* format, ...) {
+    char stackBuffer[256];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(stackBuffer, sizeof(stackBuffer), format, args);
+    va_end(args);
+    if (len < 0) {
+        return len;
+    }
+
+    std::lock_guard<std::mutex> guard(outputMutex);
+    if ((size_t)len < sizeof(stackBuffer)) {
+        fwrite(stackBuffer, 1, len, stdout);
+    } else {
+        va_start(args, format);
+        vfprintf(stdout, format, args);
+        va_end(args);
+    }
+    return len;
+}
+
+size_t HardwareSerial::print(const char* text) {
+    if (text == nullptr) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> guard(outputMutex);
+    return fwrite(text, 1, strlen(text), stdout);
+}
+
+size_t HardwareSerial::print(char c) {
+    return write((uint8_t)c);
+}
+
+size_t HardwareSerial::print(int value) {
+    return printf("%d", value);
+}
+
+size_t HardwareSerial::print(unsigned int value) {
+    return printf("%u", value);
+}
+
+size_t HardwareSerial::print(long value) {
+    return printf("%ld", value);
+}
+
+size_t HardwareSerial::print(unsigned long value) {
+    return printf("%lu", value);
+}
+
+size_t HardwareSerial::print(double value, int decimals) {
+    return printf("%.*f", decimals, value);
+}
+
+size_t HardwareSerial::println() {
+    return print("\r\n");
+}
+
+size_t HardwareSerial::write(uint8_t byte) {
+    return write(&byte, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* data, size_t len) {
+    std::lock_guard<std::mutex> guard(outputMutex);
+    return fwrite(data, 1, len, stdout);
+}
+
+void HardwareSerial::flush() {
+    std::lock_guard<std::mutex> guard(outputMutex);
+    fflush(stdout);
+}
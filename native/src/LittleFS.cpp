@@ -0,0 +1,95 @@
+#include <LittleFS.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <unistd.h>
+
+#ifndef NATIVE_LITTLEFS_DEFAULT_ROOT
+#define NATIVE_LITTLEFS_DEFAULT_ROOT ".pio/native_littlefs"
+#endif
+
+namespace {
+
+const char* defaultRoot() {
+    const char* root = getenv("NATIVE_LITTLEFS_ROOT");
+    return (root != nullptr && root[0] != '\0') ? root : NATIVE_LITTLEFS_DEFAULT_ROOT;
+}
+
+bool makeDirs(const std::string& path) {
+    for (size_t pos = 1; pos <= path.size(); pos++) {
+        if (pos == path.size() || path[pos] == '/') {
+            std::string prefix = path.substr(0, pos);
+            if (::mkdir(prefix.c_str(), 0755) != 0 && errno != EEXIST) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+size_t directoryBytes(const std::string& path) {
+    DIR* dir = opendir(path.c_str());
+    if (dir == nullptr) {
+        return 0;
+    }
+
+    size_t total = 0;
+    while (struct dirent* entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name == "." || name == "..") {
+            continue;
+        }
+        std::string child = path + "/" + name;
+        struct stat info;
+        if (stat(child.c_str(), &info) != 0) {
+            continue;
+        }
+        total += S_ISDIR(info.st_mode) ? directoryBytes(child) : (size_t)info.st_size;
+    }
+    closedir(dir);
+    return total;
+}
+
+void removeTree(const std::string& path) {
+    DIR* dir = opendir(path.c_str());
+    if (dir == nullptr) {
+        ::remove(path.c_str());
+        return;
+    }
+
+    while (struct dirent* entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name != "." && name != "..") {
+            removeTree(path + "/" + name);
+        }
+    }
+    closedir(dir);
+    ::rmdir(path.c_str());
+}
+
+}
+
+LittleFSFS LittleFS;
+
+LittleFSFS::LittleFSFS() : fs::FS(defaultRoot()) {
+}
+
+bool LittleFSFS::begin(bool formatOnFail, const char* basePath, uint8_t maxOpenFiles, const char* partitionLabel) {
+    (void)formatOnFail;
+    (void)basePath;
+    (void)maxOpenFiles;
+    (void)partitionLabel;
+    return makeDirs(root_);
+}
+
+bool LittleFSFS::format() {
+    removeTree(root_);
+    return makeDirs(root_);
+}
+
+size_t LittleFSFS::usedBytes() {
+    return directoryBytes(root_);
+}
@@ -0,0 +1,81 @@
+#include <WString.h>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <strings.h>
+
+String::String(float value, unsigned int decimals) : String((double)value, decimals) {
+}
+
+String::String(double value, unsigned int decimals) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.*f", (int)decimals, value);
+    value_ = buffer;
+}
+
+bool String::equalsIgnoreCase(const String& other) const {
+    return value_.size() == other.value_.size() && strcasecmp(value_.c_str(), other.value_.c_str()) == 0;
+}
+
+void String::trim() {
+    size_t begin = 0;
+    while (begin < value_.size() && isspace((unsigned char)value_[begin])) {
+        begin++;
+    }
+    size_t end = value_.size();
+    while (end > begin && isspace((unsigned char)value_[end - 1])) {
+        end--;
+    }
+    value_ = value_.substr(begin, end - begin);
+}
+
+void String::toUpperCase() {
+    for (size_t i = 0; i < value_.size(); i++) {
+        value_[i] = (char)toupper((unsigned char)value_[i]);
+    }
+}
+
+void String::toLowerCase() {
+    for (size_t i = 0; i < value_.size(); i++) {
+        value_[i] = (char)tolower((unsigned char)value_[i]);
+    }
+}
+
+bool String::endsWith(const String& suffix) const {
+    return value_.size() >= suffix.value_.size() &&
+           value_.compare(value_.size() - suffix.value_.size(), suffix.value_.size(), suffix.value_) == 0;
+}
+
+int String::indexOf(char c, unsigned int from) const {
+    size_t pos = value_.find(c, from);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::indexOf(const String& text, unsigned int from) const {
+    size_t pos = value_.find(text.value_, from);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+String String::substring(unsigned int from) const {
+    return from < value_.size() ? String(value_.substr(from)) : String();
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+    if (from > to) {
+        unsigned int swap = from;
+        from = to;
+        to = swap;
+    }
+    if (from >= value_.size()) {
+        return String();
+    }
+    return String(value_.substr(from, to - from));
+}
+
+long String::toInt() const {
+    return strtol(value_.c_str(), nullptr, 10);
+}
+
+float String::toFloat() const {
+    return strtof(value_.c_str(), nullptr);
+}
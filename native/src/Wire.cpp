@@ -0,0 +1,126 @@
+#include <Wire.h>
+#include <NativeSim.h>
+#include <atomic>
+#include <mutex>
+
+TwoWire Wire;
+
+namespace {
+
+std::mutex devicesMutex;
+
+// Row 0 is the main bus, row 1 + n mux channel n
+NativeI2cDevice* (*devices())[128] {
+    static NativeI2cDevice* table[1 + TwoWire::MUX_CHANNELS][128] = {};
+    return table;
+}
+
+// TCA9548A: one control register holding the open-channel bitmask
+class I2cMux : public NativeI2cDevice {
+public:
+    std::atomic<uint8_t> channels{0};
+
+    void i2cWrite(const uint8_t* data, size_t len) override { channels = data[len - 1]; }
+    void i2cRead(uint8_t* out, size_t len) override {
+        for (size_t i = 0; i < len; i++) {
+            out[i] = channels;
+        }
+    }
+} mux;
+
+NativeI2cDevice* deviceAt(uint8_t address) {
+    address &= 0x7F;
+    if (address == NATIVE_I2C_MUX_ADDRESS) {
+        return &mux;
+    }
+    std::lock_guard<std::mutex> guard(devicesMutex);
+    if (devices()[0][address] != nullptr) {
+        return devices()[0][address];
+    }
+    uint8_t open = mux.channels;
+    for (int channel = 0; channel < TwoWire::MUX_CHANNELS; channel++) {
+        if ((open & (1u << channel)) && devices()[1 + channel][address] != nullptr) {
+            return devices()[1 + channel][address];
+        }
+    }
+    return nullptr;
+}
+
+}
+
+void TwoWire::attachDevice(uint8_t address, NativeI2cDevice* device, int channel) {
+    if (channel < -1 || channel >= MUX_CHANNELS) {
+        return;
+    }
+    std::lock_guard<std::mutex> guard(devicesMutex);
+    devices()[1 + channel][address & 0x7F] = device;
+}
+
+bool TwoWire::begin(int sda, int scl, uint32_t frequency) {
+    (void)sda;
+    (void)scl;
+    if (frequency != 0) {
+        clock_ = frequency;
+    }
+    return true;
+}
+
+bool TwoWire::setClock(uint32_t frequency) {
+    clock_ = frequency;
+    return true;
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+    address_ = address;
+    tx_.clear();
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop) {
+    (void)sendStop;
+    chargeBusTime(tx_.size() + 1); // Plus the address byte
+    NativeI2cDevice* device = deviceAt(address_);
+    if (device != nullptr && !tx_.empty()) {
+        device->i2cWrite(tx_.data(), tx_.size());
+    }
+    tx_.clear();
+    return 0; // Success
+}
+
+size_t TwoWire::write(uint8_t byte) {
+    tx_.push_back(byte);
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t* data, size_t len) {
+    tx_.insert(tx_.end(), data, data + len);
+    return len;
+}
+
+size_t TwoWire::requestFrom(uint8_t address, size_t len, bool sendStop) {
+    (void)sendStop;
+    chargeBusTime(len + 1);
+    rx_.assign(len, 0);
+    rxPos_ = 0;
+    NativeI2cDevice* device = deviceAt(address);
+    if (device != nullptr && len > 0) {
+        device->i2cRead(rx_.data(), len);
+    }
+    return len;
+}
+
+int TwoWire::available() {
+    return (int)(rx_.size() - rxPos_);
+}
+
+int TwoWire::read() {
+    if (rxPos_ >= rx_.size()) {
+        return -1;
+    }
+    return rx_[rxPos_++];
+}
+
+void TwoWire::chargeBusTime(size_t bytes) {
+    if (NativeSim::active() && clock_ > 0) {
+        NativeSim::advance((uint64_t)bytes * 9 * 1000000 / clock_);
+    }
+}
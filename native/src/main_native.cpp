@@ -0,0 +1,211 @@
+#include <Arduino.h>
+#include <BluetoothSerial.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "../../src/layers/network/NetworkLayer.h"
+#include "../../src/layers/network/TrafficRecorder.h"
+#include "../../src/layers/network/TrafficReplayer.h"
+#include "../../src/layers/data/persistence/PosixFileStorage.h"
+#include "../../src/layers/application/measurement/ExportFrame.h"
+
+// Host entry point: runs the firmware's setup()/loop() from src/main.cpp unchanged.
+//
+//   --seconds N    exit after N seconds (default: run until killed; also NATIVE_RUN_SECONDS)
+//   --no-stdin     don't forward stdin lines as Bluetooth commands
+//   --record FILE  record all broker traffic after setup() and write it to FILE on exit
+//   --replay FILE  re-publish a recorded log into the broker after setup()
+//   --speed X      replay speed factor: 1 real time (default), N faster, 0 as fast as possible
+//
+// Lines typed on stdin reach the Bluetooth app as if sent from the phone; everything the
+// device writes to Bluetooth is echoed to stdout prefixed with "BT> ". Binary export frames
+// ("FORMAT BIN") are checked and summarized instead of echoed.
+
+void setup();
+void loop();
+
+extern NetworkLayer* networkLayer;
+
+// Recordings need room for a few minutes of sensor traffic
+static const size_t RECORD_CAPACITY = 16 * 1024 * 1024;
+
+namespace {
+
+void forwardStdin() {
+    char line[256];
+    while (fgets(line, sizeof(line), stdin) != nullptr) {
+        BluetoothSerial* bluetooth = BluetoothSerial::host();
+        if (bluetooth == nullptr) {
+            fprintf(stderr, "[native] Bluetooth not started, dropping input\n");
+            continue;
+        }
+        bluetooth->hostInject(line);
+    }
+}
+
+std::mutex echoMutex;
+std::string echoLine;
+std::vector<uint8_t> echoFrame; // Binary frame still arriving
+uint16_t echoRecordSize = 0;
+uint16_t echoNextSequence = 0;
+uint32_t echoRecordsCrc = 0;
+
+void echoExportFrame(const ExportFrame::View& frame) {
+    if (frame.sequence != echoNextSequence) {
+        Serial.printf("BT> [BIN] session %u: frame %u out of order, expected %u\n", (unsigned)frame.session,
+                      frame.sequence, echoNextSequence);
+    }
+    echoNextSequence = frame.sequence + 1;
+
+    if (frame.type == ExportFrame::TYPE_HEADER) {
+        ExportFrame::Info info;
+        if (!ExportFrame::decodeInfo(frame.payload, frame.length, info)) {
+            return;
+        }
+        echoRecordSize = info.recordSize;
+        echoRecordsCrc = 0;
+        Serial.printf("BT> [BIN] session %u: %u samples, format %u (%u bytes each), %.3f Hz, start_us %llu, %u data frames\n",
+                      (unsigned)frame.session, (unsigned)info.sampleCount, info.format, info.recordSize,
+                      info.rateMilliHz / 1000.0, (unsigned long long)info.startUs, (unsigned)info.dataFrames);
+    } else if (frame.type == ExportFrame::TYPE_DATA && frame.length >= ExportFrame::DATA_PREFIX_SIZE) {
+        uint32_t first;
+        memcpy(&first, frame.payload, 4);
+        size_t bytes = frame.length - ExportFrame::DATA_PREFIX_SIZE;
+        echoRecordsCrc = crc32Update(echoRecordsCrc, frame.payload + ExportFrame::DATA_PREFIX_SIZE, bytes);
+        Serial.printf("BT> [BIN] frame %u: samples %u-%u, %u bytes\n", frame.sequence, (unsigned)first,
+                      (unsigned)(first + (echoRecordSize ? bytes / echoRecordSize : 0)) - 1,
+                      (unsigned)(frame.length + ExportFrame::PREFIX_SIZE + ExportFrame::CRC_SIZE));
+    } else if (frame.type == ExportFrame::TYPE_END && frame.length >= ExportFrame::END_SIZE) {
+        uint32_t samples;
+        uint32_t frames;
+        uint32_t crc;
+        memcpy(&samples, frame.payload, 4);
+        memcpy(&frames, frame.payload + 4, 4);
+        memcpy(&crc, frame.payload + 8, 4);
+        Serial.printf("BT> [BIN] end: %u samples in %u data frames, records CRC %s\n", (unsigned)samples,
+                      (unsigned)frames, crc == echoRecordsCrc ? "ok" : "MISMATCH");
+        echoNextSequence = 0;
+    }
+}
+
+// Reassemble writes into lines; println() arrives as text and "\r\n" in separate writes
+void echoBluetooth(const uint8_t* data, size_t len) {
+    std::lock_guard<std::mutex> guard(echoMutex);
+    for (size_t i = 0; i < len; i++) {
+        // Text never contains the sync byte, so a frame can only start at one
+        if (!echoFrame.empty() || data[i] == ExportFrame::SYNC0) {
+            echoFrame.push_back(data[i]);
+            ExportFrame::View frame;
+            int size = ExportFrame::parse(echoFrame.data(), echoFrame.size(), frame);
+            if (size > 0) {
+                echoExportFrame(frame);
+            } else if (size < 0) {
+                Serial.printf("BT> [BIN] bad frame, %u bytes dropped\n", (unsigned)echoFrame.size());
+            }
+            if (size != 0) {
+                echoFrame.clear();
+            }
+            continue;
+        }
+
+        char c = (char)data[i];
+        if (c == '\r') {
+            continue;
+        }
+        if (c == '\n') {
+            Serial.printf("BT> %s\n", echoLine.c_str());
+            echoLine.clear();
+        } else {
+            echoLine += c;
+        }
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+    double runSeconds = 0;
+    bool readStdin = true;
+    const char* recordPath = nullptr;
+    const char* replayPath = nullptr;
+    float replaySpeed = 1.0f;
+
+    const char* envSeconds = getenv("NATIVE_RUN_SECONDS");
+    if (envSeconds != nullptr) {
+        runSeconds = atof(envSeconds);
+    }
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            runSeconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--no-stdin") == 0) {
+            readStdin = false;
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else if (strcmp(argv[i], "--speed") == 0 && i + 1 < argc) {
+            replaySpeed = (float)atof(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [--seconds N] [--no-stdin] [--record FILE] [--replay FILE [--speed X]]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+
+    // Line-buffered so task output shows up promptly when piped
+    setvbuf(stdout, nullptr, _IOLBF, 0);
+
+    setup();
+
+    // Paths are used as given, relative to the working directory
+    PosixFileStorage files("");
+    TrafficRecorder recorder(recordPath != nullptr ? RECORD_CAPACITY : 0, false);
+    TrafficReplayer replayer;
+    if (recordPath != nullptr) {
+        recorder.setIgnoredPublisher(TrafficReplayer::PUBLISHER_NAME);
+        if (!recorder.start(networkLayer)) {
+            fprintf(stderr, "[native] Failed to start traffic recording\n");
+            _exit(1);
+        }
+    }
+    if (replayPath != nullptr) {
+        if (!replayer.load(&files, replayPath) || !replayer.start(networkLayer, replaySpeed)) {
+            fprintf(stderr, "[native] Failed to replay %s\n", replayPath);
+            _exit(1);
+        }
+    }
+
+    if (BluetoothSerial::host() != nullptr) {
+        BluetoothSerial::host()->hostSetTxListener(echoBluetooth);
+    }
+    if (readStdin) {
+        std::thread(forwardStdin).detach();
+    }
+
+    unsigned long start = millis();
+    while (runSeconds <= 0 || millis() - start < runSeconds * 1000) {
+        loop();
+    }
+
+    if (recordPath != nullptr) {
+        recorder.stop();
+        recorder.save(&files, recordPath);
+        printf("[native] Recorded %u messages (%u bytes, %u dropped) to %s\n", recorder.messageCount(),
+               (unsigned)recorder.bytesUsed(), recorder.droppedCount(), recordPath);
+    }
+    if (replayPath != nullptr) {
+        TrafficReplayer::Stats stats = replayer.stats();
+        printf("[native] Replayed %u of %u messages (%u failed, max %u us late)%s\n", stats.published,
+               replayer.messageCount(), stats.failed, stats.maxLateUs, replayer.isRunning() ? ", still running" : "");
+    }
+
+    // Application tasks never return; leave without running static destructors under them
+    Serial.flush();
+    fflush(stdout);
+    _exit(0);
+}
@@ -0,0 +1,308 @@
+#include "PipelineProbe.h"
+#include <algorithm>
+#include <cstring>
+#include <Arduino.h>
+#include <BluetoothSerial.h>
+#include <NativeSim.h>
+#include "layers/application/mpu/MpuSample.h"
+#include "layers/application/measurement/ExportFrame.h"
+
+namespace {
+
+// Samples published but not (yet) seen on the link; older ones were never recorded
+const size_t MAX_PENDING = 8192;
+}
+
+PipelineProbe::PipelineProbe(NetworkLayer* network, MeasurementApp* measurement, uint32_t occupancyIntervalMs) :
+    network_(network),
+    measurement_(measurement),
+    occupancyIntervalMs_(occupancyIntervalMs),
+    frameRanges_(0),
+    framesBad_(0),
+    startUs_(0),
+    stopUs_(0),
+    dataEndUs_(0),
+    inData_(false),
+    bufferFilled_(false),
+    samplesPublished_(0),
+    linesUnmatched_(0),
+    transmitBytes_(0),
+    digest_(2166136261u),
+    bufferMax_(0),
+    bufferSum_(0),
+    bufferReadings_(0) {}
+
+bool PipelineProbe::attach() {
+    BluetoothSerial* bluetooth = BluetoothSerial::host();
+    if (network_ == nullptr || measurement_ == nullptr || bluetooth == nullptr) {
+        return false;
+    }
+
+    bool subscribed = network_->subscribe("mpu/raw", "SimProbe",
+                                          [this](const uint8_t* data, size_t len, const std::string&) {
+                                              this->onMpuData(data, len);
+                                          });
+    if (!subscribed) {
+        return false;
+    }
+
+    bluetooth->hostSetTxListener([this](const uint8_t* data, size_t len) { this->onTransmit(data, len); });
+
+    return xTaskCreate(occupancyTask, "SimOccupancy", 4096, this, 1, nullptr) == pdPASS;
+}
+
+void PipelineProbe::markStart() {
+    startUs_ = NativeSim::nowUs();
+}
+
+void PipelineProbe::markStop(bool bufferFilled) {
+    stopUs_ = NativeSim::nowUs();
+    bufferFilled_ = bufferFilled;
+}
+
+void PipelineProbe::onMpuData(const uint8_t* data, size_t len) {
+    uint64_t publishedUs;
+    uint8_t ranges;
+    MpuRawCounts counts;
+    if (!MpuSample::decode(data, len, publishedUs, ranges, counts)) {
+        return;
+    }
+
+    uint64_t now = NativeSim::nowUs();
+
+    samplesPublished_++;
+    brokerUs_.push_back((uint32_t)(now - publishedUs));
+
+    char line[128];
+    // MeasurementApp transmits raw counts by default, formatted the same way after the t_us column
+    MpuSample::formatCsv(counts, ranges, false, line, sizeof(line));
+    pending_.push_back(PendingSample{line, publishedUs});
+    if (pending_.size() > MAX_PENDING) {
+        pending_.pop_front();
+    }
+}
+
+void PipelineProbe::onTransmit(const uint8_t* data, size_t len) {
+    uint64_t now = NativeSim::nowUs();
+    transmitBytes_ += len;
+
+    // Timestamp first so the digest also changes when only the timing does
+    for (int shift = 0; shift < 64; shift += 8) {
+        digest_ = (digest_ ^ (uint8_t)(now >> shift)) * 16777619u;
+    }
+    for (size_t i = 0; i < len; i++) {
+        digest_ = (digest_ ^ data[i]) * 16777619u;
+
+        // Binary export frames; text never contains the sync byte
+        if (!rxFrame_.empty() || data[i] == ExportFrame::SYNC0) {
+            rxFrame_.push_back(data[i]);
+            ExportFrame::View frame;
+            int size = ExportFrame::parse(rxFrame_.data(), rxFrame_.size(), frame);
+            if (size > 0) {
+                onFrame(frame, now);
+            } else if (size < 0) {
+                framesBad_++;
+            }
+            if (size != 0) {
+                rxFrame_.clear();
+            }
+            continue;
+        }
+
+        char c = (char)data[i];
+        if (c == '\r') {
+            continue;
+        }
+        if (c == '\n') {
+            if (!rxLine_.empty()) {
+                onLine(rxLine_, now);
+            }
+            rxLine_.clear();
+        } else {
+            rxLine_ += c;
+        }
+    }
+}
+
+void PipelineProbe::onLine(const std::string& line, uint64_t nowUs) {
+    if (line.compare(0, 11, "DATA_START:") == 0) {
+        inData_ = true;
+        return;
+    }
+    if (line == "DATA_END") {
+        inData_ = false;
+        dataEndUs_ = nowUs;
+        return;
+    }
+    if (!inData_ || line.compare(0, 7, "Format:") == 0 || line.compare(0, 6, "Scale:") == 0 ||
+        line.compare(0, 9, "Start_us:") == 0) {
+        return;
+    }
+
+    // Match on the values; the leading t_us is relative to the first recorded sample
+    size_t comma = line.find(',');
+    matchSample(comma == std::string::npos ? line : line.substr(comma + 1), nowUs);
+}
+
+void PipelineProbe::onFrame(const ExportFrame::View& frame, uint64_t nowUs) {
+    if (frame.type == ExportFrame::TYPE_HEADER) {
+        ExportFrame::Info info;
+        inData_ = false;
+        if (ExportFrame::decodeInfo(frame.payload, frame.length, info)) {
+            inData_ = info.format == ExportFrame::FORMAT_MPU_COUNTS;
+            frameRanges_ = info.ranges;
+        }
+        return;
+    }
+    if (frame.type == ExportFrame::TYPE_END) {
+        inData_ = false;
+        dataEndUs_ = nowUs;
+        return;
+    }
+    if (!inData_ || frame.type != ExportFrame::TYPE_DATA || frame.length < ExportFrame::DATA_PREFIX_SIZE) {
+        return;
+    }
+
+    // Same text as a CSV line's values, so both formats match the same way
+    const uint8_t* record = frame.payload + ExportFrame::DATA_PREFIX_SIZE;
+    const uint8_t* end = frame.payload + frame.length;
+    char values[128];
+    for (; record + ExportFrame::COUNTS_RECORD_SIZE <= end; record += ExportFrame::COUNTS_RECORD_SIZE) {
+        MpuRawCounts counts;
+        memcpy(&counts, record + 4, MpuSample::COUNTS_SIZE);
+        MpuSample::formatCsv(counts, frameRanges_, false, values, sizeof(values));
+        matchSample(values, nowUs);
+    }
+}
+
+void PipelineProbe::matchSample(const std::string& values, uint64_t nowUs) {
+    // Samples are transmitted in publish order; anything skipped before the match was not recorded
+    while (!pending_.empty() && pending_.front().line != values) {
+        pending_.pop_front();
+    }
+    if (pending_.empty()) {
+        linesUnmatched_++;
+        return;
+    }
+
+    endToEndUs_.push_back((uint32_t)(nowUs - pending_.front().publishedUs));
+    transmitUs_.push_back((uint32_t)(nowUs - stopUs_));
+    pending_.pop_front();
+}
+
+void PipelineProbe::occupancyTask(void* parameter) {
+    PipelineProbe* probe = static_cast<PipelineProbe*>(parameter);
+
+    while (true) {
+        if (probe->measurement_->isRecording()) {
+            uint32_t samples = (uint32_t)probe->measurement_->getRecordedSamplesCount();
+            probe->bufferMax_ = std::max(probe->bufferMax_, samples);
+            probe->bufferSum_ += samples;
+            probe->bufferReadings_++;
+        }
+        vTaskDelay(pdMS_TO_TICKS(probe->occupancyIntervalMs_));
+    }
+}
+
+PipelineProbe::Latency PipelineProbe::summarize(std::vector<uint32_t> samplesUs) {
+    Latency latency = {0, 0, 0, 0, 0};
+    if (samplesUs.empty()) {
+        return latency;
+    }
+
+    std::sort(samplesUs.begin(), samplesUs.end());
+    size_t count = samplesUs.size();
+    latency.count = (uint32_t)count;
+    latency.p50Us = samplesUs[(count - 1) * 50 / 100];
+    latency.p90Us = samplesUs[(count - 1) * 90 / 100];
+    latency.p99Us = samplesUs[(count - 1) * 99 / 100];
+    latency.maxUs = samplesUs[count - 1];
+    return latency;
+}
+
+PipelineProbe::Report PipelineProbe::report(double wallSeconds) const {
+    Report r;
+    r.virtualUs = NativeSim::nowUs();
+    r.wallSeconds = wallSeconds;
+    r.contextSwitches = NativeSim::contextSwitches();
+
+    r.samplesPublished = samplesPublished_;
+    r.samplesTransmitted = (uint32_t)endToEndUs_.size();
+    r.linesUnmatched = linesUnmatched_;
+    r.framesBad = framesBad_;
+    r.recordSeconds = stopUs_ > startUs_ ? (stopUs_ - startUs_) / 1e6 : 0;
+    r.bufferFilled = bufferFilled_;
+    r.sampleRateHz = r.recordSeconds > 0 ? r.samplesTransmitted / r.recordSeconds : 0;
+
+    r.transmitSeconds = dataEndUs_ > stopUs_ ? (dataEndUs_ - stopUs_) / 1e6 : 0;
+    r.transmitBytes = transmitBytes_;
+    r.transmitLinesPerSec = r.transmitSeconds > 0 ? r.samplesTransmitted / r.transmitSeconds : 0;
+    r.transmitBytesPerSec = r.transmitSeconds > 0 ? transmitBytes_ / r.transmitSeconds : 0;
+
+    r.bufferCapacity = (uint32_t)measurement_->getSampleCapacity();
+    r.bufferMax = bufferMax_;
+    r.bufferMean = bufferReadings_ > 0 ? (double)bufferSum_ / bufferReadings_ : 0;
+
+    r.broker = summarize(brokerUs_);
+    r.transmit = summarize(transmitUs_);
+    r.endToEnd = summarize(endToEndUs_);
+    r.digest = digest_;
+    return r;
+}
+
+void PipelineProbe::print(const Report& r, FILE* out) {
+    fprintf(out, "Simulated %.3f s in %.3f s wall (%.0fx), %llu context switches\n",
+            r.virtualUs / 1e6, r.wallSeconds, r.wallSeconds > 0 ? r.virtualUs / 1e6 / r.wallSeconds : 0,
+            (unsigned long long)r.contextSwitches);
+    fprintf(out, "Samples: %u published, %u transmitted (%.1f Hz over %.3f s), %u unmatched lines\n",
+            r.samplesPublished, r.samplesTransmitted, r.sampleRateHz, r.recordSeconds, r.linesUnmatched);
+    if (r.framesBad > 0) {
+        fprintf(out, "Frames: %u failed their CRC\n", r.framesBad);
+    }
+    fprintf(out, "Transmit: %.3f s, %llu bytes, %.1f lines/s, %.0f B/s\n",
+            r.transmitSeconds, (unsigned long long)r.transmitBytes, r.transmitLinesPerSec, r.transmitBytesPerSec);
+    fprintf(out, "Buffer: max %u / %u samples, mean %.1f while recording%s\n",
+            r.bufferMax, r.bufferCapacity, r.bufferMean, r.bufferFilled ? " (filled before STOP)" : "");
+
+    const Latency* latencies[] = {&r.broker, &r.transmit, &r.endToEnd};
+    const char* names[] = {"broker", "transmit", "end-to-end"};
+    for (size_t i = 0; i < 3; i++) {
+        fprintf(out, "Latency %-10s n=%-6u p50=%uus p90=%uus p99=%uus max=%uus\n", names[i],
+                latencies[i]->count, latencies[i]->p50Us, latencies[i]->p90Us, latencies[i]->p99Us,
+                latencies[i]->maxUs);
+    }
+    fprintf(out, "Digest: %08x\n", r.digest);
+}
+
+bool PipelineProbe::writeJson(const Report& r, const std::string& path) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        return false;
+    }
+
+    fprintf(file, "{\n");
+    fprintf(file, "  \"virtual_us\": %llu,\n  \"wall_seconds\": %.3f,\n  \"context_switches\": %llu,\n",
+            (unsigned long long)r.virtualUs, r.wallSeconds, (unsigned long long)r.contextSwitches);
+    fprintf(file, "  \"samples_published\": %u,\n  \"samples_transmitted\": %u,\n  \"lines_unmatched\": %u,\n",
+            r.samplesPublished, r.samplesTransmitted, r.linesUnmatched);
+    fprintf(file, "  \"frames_bad\": %u,\n", r.framesBad);
+    fprintf(file, "  \"record_seconds\": %.6f,\n  \"sample_rate_hz\": %.3f,\n", r.recordSeconds, r.sampleRateHz);
+    fprintf(file, "  \"transmit_seconds\": %.6f,\n  \"transmit_bytes\": %llu,\n", r.transmitSeconds,
+            (unsigned long long)r.transmitBytes);
+    fprintf(file, "  \"transmit_lines_per_sec\": %.3f,\n  \"transmit_bytes_per_sec\": %.1f,\n",
+            r.transmitLinesPerSec, r.transmitBytesPerSec);
+    fprintf(file, "  \"buffer_capacity\": %u,\n  \"buffer_max\": %u,\n  \"buffer_mean\": %.3f,\n",
+            r.bufferCapacity, r.bufferMax, r.bufferMean);
+    fprintf(file, "  \"buffer_filled\": %s,\n", r.bufferFilled ? "true" : "false");
+
+    const Latency* latencies[] = {&r.broker, &r.transmit, &r.endToEnd};
+    const char* names[] = {"broker", "transmit", "end_to_end"};
+    for (size_t i = 0; i < 3; i++) {
+        fprintf(file, "  \"latency_%s\": {\"count\": %u, \"p50_us\": %u, \"p90_us\": %u, \"p99_us\": %u, \"max_us\": %u},\n",
+                names[i], latencies[i]->count, latencies[i]->p50Us, latencies[i]->p90Us, latencies[i]->p99Us,
+                latencies[i]->maxUs);
+    }
+    fprintf(file, "  \"digest\": \"%08x\"\n}\n", r.digest);
+
+    return fclose(file) == 0;
+}
@@ -0,0 +1,114 @@
+#ifndef PIPELINE_PROBE_H
+#define PIPELINE_PROBE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <vector>
+#include "layers/network/NetworkLayer.h"
+#include "layers/application/measurement/MeasurementApp.h"
+#include "layers/application/measurement/ExportFrame.h"
+
+// Observes the MPU -> broker -> MeasurementApp -> Bluetooth pipeline from the outside:
+// subscribes to mpu/raw next to MeasurementApp, watches the bytes Bluetooth transmits, and
+// samples MeasurementApp's buffer. Samples are matched to transmitted CSV lines (or binary
+// export records, "FORMAT BIN") by content,
+// so no firmware code needs instrumenting. Runs under the virtual-time scheduler, where only
+// one task executes at a time, so it needs no locking.
+class PipelineProbe {
+public:
+    struct Latency {
+        uint32_t count;
+        uint32_t p50Us;
+        uint32_t p90Us;
+        uint32_t p99Us;
+        uint32_t maxUs;
+    };
+
+    struct Report {
+        uint64_t virtualUs;
+        double wallSeconds;
+        uint64_t contextSwitches;
+
+        uint32_t samplesPublished;    // mpu/raw messages seen by the probe
+        uint32_t samplesTransmitted;  // CSV lines matched back to a published sample
+        uint32_t linesUnmatched;      // CSV lines with no matching sample (should be 0)
+        uint32_t framesBad;           // Binary frames that failed their CRC (should be 0)
+        double recordSeconds;         // START to STOP injection
+        bool bufferFilled;            // Recording ended early on a full buffer
+        double sampleRateHz;          // Samples transmitted per recorded second
+
+        double transmitSeconds;       // STOP injection to DATA_END on the link
+        uint64_t transmitBytes;
+        double transmitLinesPerSec;
+        double transmitBytesPerSec;
+
+        uint32_t bufferCapacity;      // MeasurementApp sample buffer
+        uint32_t bufferMax;
+        double bufferMean;            // Over samples taken while recording
+
+        Latency broker;               // Sample time -> subscriber callback
+        Latency transmit;             // STOP injection -> CSV line on the link
+        Latency endToEnd;             // Sample time -> CSV line on the link
+
+        uint32_t digest;              // FNV-1a over every transmitted byte and its timestamp
+    };
+
+    PipelineProbe(NetworkLayer* network, MeasurementApp* measurement, uint32_t occupancyIntervalMs = 100);
+
+    bool attach();
+
+    // Scenario markers, called by the driver when it injects START and STOP
+    void markStart();
+    void markStop(bool bufferFilled = false);
+    bool transmitComplete() const { return dataEndUs_ != 0; }
+
+    Report report(double wallSeconds) const;
+    static void print(const Report& report, FILE* out);
+    static bool writeJson(const Report& report, const std::string& path);
+
+private:
+    struct PendingSample {
+        std::string line;      // Formatted exactly as MeasurementApp transmits it
+        uint64_t publishedUs;
+    };
+
+    NetworkLayer* network_;
+    MeasurementApp* measurement_;
+    uint32_t occupancyIntervalMs_;
+
+    std::deque<PendingSample> pending_;
+    std::string rxLine_;
+    std::vector<uint8_t> rxFrame_;   // Binary export frame still arriving
+    uint8_t frameRanges_;
+    uint32_t framesBad_;
+    uint64_t startUs_;
+    uint64_t stopUs_;
+    uint64_t dataEndUs_;
+    bool inData_;
+    bool bufferFilled_;
+
+    uint32_t samplesPublished_;
+    uint32_t linesUnmatched_;
+    uint64_t transmitBytes_;
+    uint32_t digest_;
+    uint32_t bufferMax_;
+    uint64_t bufferSum_;
+    uint32_t bufferReadings_;
+
+    std::vector<uint32_t> brokerUs_;
+    std::vector<uint32_t> transmitUs_;
+    std::vector<uint32_t> endToEndUs_;
+
+    void onMpuData(const uint8_t* data, size_t len);
+    void onTransmit(const uint8_t* data, size_t len);
+    void onLine(const std::string& line, uint64_t nowUs);
+    void onFrame(const ExportFrame::View& frame, uint64_t nowUs);
+    void matchSample(const std::string& values, uint64_t nowUs);
+    static void occupancyTask(void* parameter);
+    static Latency summarize(std::vector<uint32_t> samplesUs);
+};
+
+#endif // PIPELINE_PROBE_H
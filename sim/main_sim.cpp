@@ -0,0 +1,127 @@
+#include <Arduino.h>
+#include <BluetoothSerial.h>
+#include <LittleFS.h>
+#include <NativeSim.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+#include "PipelineProbe.h"
+
+// Virtual-time run of the full firmware from src/main.cpp, driving the
+// MPU -> broker -> MeasurementApp -> Bluetooth pipeline from the phone's side:
+//
+//   t = settle            "START" over Bluetooth
+//   t = settle + record   "STOP" ("DATA" if the buffer filled first), then wait for DATA_END
+//
+//   --record-ms N       recording length (default 10000)
+//   --settle-ms N       time before START (default 1000)
+//   --timeout-ms N      give up waiting for DATA_END after STOP (default 60000)
+//   --switch-cost-us N  virtual time charged per context switch (default 0)
+//   --format csv|bin    export format asked for before START (default csv, sends nothing)
+//   --json PATH         also write the report as JSON
+//   --quiet             drop the firmware's Serial output, print only the report
+//
+// Identical arguments and sources give an identical report, digest included; only the
+// wall-clock figures change between runs.
+
+void setup();
+
+extern NetworkLayer* networkLayer;
+extern ApplicationInterface* measurementApp;
+
+int main(int argc, char** argv) {
+    uint32_t settleMs = 1000;
+    uint32_t recordMs = 10000;
+    uint32_t timeoutMs = 60000;
+    uint32_t switchCostUs = 0;
+    std::string jsonPath;
+    bool quiet = false;
+    bool binary = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--record-ms") == 0 && i + 1 < argc) {
+            recordMs = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--settle-ms") == 0 && i + 1 < argc) {
+            settleMs = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--timeout-ms") == 0 && i + 1 < argc) {
+            timeoutMs = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--switch-cost-us") == 0 && i + 1 < argc) {
+            switchCostUs = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else if (strcmp(argv[i], "--quiet") == 0) {
+            quiet = true;
+        } else if (strcmp(argv[i], "--format") == 0 && i + 1 < argc &&
+                   (strcmp(argv[i + 1], "csv") == 0 || strcmp(argv[i + 1], "bin") == 0)) {
+            binary = strcmp(argv[++i], "bin") == 0;
+        } else {
+            fprintf(stderr, "usage: %s [--record-ms N] [--settle-ms N] [--timeout-ms N] [--switch-cost-us N] [--format csv|bin] [--json PATH] [--quiet]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+
+    // The report always goes to the real stdout, even when firmware output is dropped
+    FILE* reportOut = fdopen(dup(fileno(stdout)), "w");
+    if (quiet && freopen("/dev/null", "w", stdout) == nullptr) {
+        return 1;
+    }
+    setvbuf(stdout, nullptr, _IOLBF, 0);
+
+    std::chrono::steady_clock::time_point wallStart = std::chrono::steady_clock::now();
+
+    // Same flash contents every run
+    LittleFS.format();
+
+    NativeSim::begin();
+    NativeSim::setSwitchCost(switchCostUs);
+    setup();
+
+    PipelineProbe probe(networkLayer, static_cast<MeasurementApp*>(measurementApp));
+    if (!probe.attach()) {
+        fprintf(stderr, "[sim] Pipeline not available (Bluetooth or MeasurementApp failed to start)\n");
+        return 1;
+    }
+
+    delay(settleMs);
+    if (binary) {
+        BluetoothSerial::host()->hostInject("FORMAT BIN\n");
+        delay(100);
+    }
+    BluetoothSerial::host()->hostInject("START\n");
+    probe.markStart();
+
+    delay(recordMs);
+    // A full buffer ends recording on its own and MeasurementApp then ignores STOP; ask for DATA
+    bool recording = static_cast<MeasurementApp*>(measurementApp)->isRecording();
+    BluetoothSerial::host()->hostInject(recording ? "STOP\n" : "DATA\n");
+    probe.markStop(!recording);
+
+    uint32_t waitStart = millis();
+    while (!probe.transmitComplete() && millis() - waitStart < timeoutMs) {
+        delay(10);
+    }
+
+    double wallSeconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    PipelineProbe::Report report = probe.report(wallSeconds);
+
+    fflush(stdout);
+    PipelineProbe::print(report, reportOut);
+    if (!probe.transmitComplete()) {
+        fprintf(reportOut, "Transmission did not finish within %u ms of STOP\n", timeoutMs);
+    }
+
+    bool ok = probe.transmitComplete();
+    if (!jsonPath.empty() && !PipelineProbe::writeJson(report, jsonPath)) {
+        fprintf(stderr, "[sim] Failed to write %s\n", jsonPath.c_str());
+        ok = false;
+    }
+    fflush(reportOut);
+
+    // Tasks are parked on the virtual scheduler; leave without unwinding under them
+    _exit(ok ? 0 : 1);
+}
@@ -1,8 +1,11 @@
 #include "Bluetooth.h"
 #include <Arduino.h>
+#include <cstring>
+#include "../../logging/Log.h"
 
 Bluetooth::Bluetooth()
-    : initialized_(false) {
+    : initialized_(false),
+      streamRing_(STREAM_SLOT_SIZE, STREAM_RING_CAPACITY, true) {
     Serial.println("[Bluetooth] Created");
 }
 
@@ -49,6 +52,9 @@ void Bluetooth::update() {
     // Monitor and publish connection status changes
     logConnectionStatus();
 
+    // Queued bulk output first, so a transfer keeps the link busy
+    drainStream();
+
     // Read incoming Bluetooth data and publish as commands
     if (SerialBT.available()) {
         // Read available data into a buffer
@@ -81,25 +87,19 @@ void Bluetooth::update() {
                 command.trim();
             }
             
-            Serial.printf("[Bluetooth] Read %d bytes, extracted command: '%s'\n", bytesRead, command.c_str());
+            LOG_DEBUG(BLUETOOTH, "Read %u bytes, extracted command: '%s'", bytesRead, command.c_str());
             
             if (command.length() > 0) {
-                Serial.printf("[Bluetooth] Publishing command: '%s' (%d bytes)\n", command.c_str(), command.length());
-                
-                // Debug: Show bytes being published
-                Serial.printf("[Bluetooth] Publishing bytes: ");
-                const uint8_t* cmdBytes = (const uint8_t*)command.c_str();
-                for (size_t i = 0; i < command.length(); i++) {
-                    Serial.printf("%02X ", cmdBytes[i]);
-                }
-                Serial.println();
+                LOG_INFO(BLUETOOTH, "Publishing command: '%s' (%u bytes)", command.c_str(), command.length());
+                LOG_DEBUG(BLUETOOTH, "Publishing bytes: %s",
+                          LogHex((const uint8_t*)command.c_str(), command.length()));
                 
                 // Publish command to network for other apps to process
                 networkLayer_->publish("bluetooth/command", 
                                       (const uint8_t*)command.c_str(), 
                                       command.length());
             } else {
-                Serial.printf("[Bluetooth] No valid command found in %d bytes\n", bytesRead);
+                LOG_WARN(BLUETOOTH, "No valid command found in %u bytes", bytesRead);
             }
         }
     }
@@ -108,32 +108,21 @@ void Bluetooth::update() {
 }
 
 void Bluetooth::sendData(const String& data) {
-    Serial.printf("[Bluetooth] sendData called (len=%d), connected=%d\n", data.length(), SerialBT.connected());
     if (SerialBT.connected()) {
-        // Debug dump
-        Serial.printf("[Bluetooth] sendData bytes: ");
-        const uint8_t* bytes = (const uint8_t*)data.c_str();
-        for (size_t i = 0; i < data.length() && i < 64; i++) Serial.printf("%02X ", bytes[i]);
-        Serial.println();
-
+        LOG_DEBUG(BLUETOOTH, "sendData (len=%u): %s", data.length(),
+                  LogHex((const uint8_t*)data.c_str(), data.length()));
         SerialBT.println(data);
-        Serial.println("[Bluetooth] sendData: sent via SerialBT.println");
     } else {
-        Serial.println("[Bluetooth] sendData: not connected");
+        LOG_WARN(BLUETOOTH, "sendData: not connected");
     }
 }
 
 void Bluetooth::sendBinaryData(const uint8_t* data, size_t len) {
-    Serial.printf("[Bluetooth] sendBinaryData called (len=%d), connected=%d\n", len, SerialBT.connected());
     if (SerialBT.connected()) {
-        Serial.printf("[Bluetooth] sendBinaryData bytes: ");
-        for (size_t i = 0; i < len && i < 64; i++) Serial.printf("%02X ", data[i]);
-        Serial.println();
-
+        LOG_DEBUG(BLUETOOTH, "sendBinaryData (len=%u): %s", len, LogHex(data, len));
         SerialBT.write(data, len);
-        Serial.println("[Bluetooth] sendBinaryData: wrote bytes to SerialBT");
     } else {
-        Serial.println("[Bluetooth] sendBinaryData: not connected");
+        LOG_WARN(BLUETOOTH, "sendBinaryData: not connected");
     }
 }
 
@@ -145,18 +134,12 @@ String Bluetooth::getConnectionStatus() {
 }
 
 void Bluetooth::onTransmitData(const uint8_t* data, size_t len, const std::string& topic) {
-    Serial.printf("[Bluetooth] onTransmitData called for topic %s (len=%d), connected=%d\n", topic.c_str(), len, SerialBT.connected());
     if (!data || len == 0) {
-        Serial.println("[Bluetooth] onTransmitData: no data to send");
+        LOG_WARN(BLUETOOTH, "onTransmitData: no data to send");
         return;
     }
 
-    // Dump a short sample of bytes for debugging
-    Serial.printf("[Bluetooth] onTransmitData bytes: ");
-    for (size_t i = 0; i < len && i < 128; i++) {
-        Serial.printf("%02X ", data[i]);
-    }
-    Serial.println();
+    LOG_DEBUG(BLUETOOTH, "onTransmitData %s (len=%u): %s", topic, len, LogHex(data, len));
 
     if (SerialBT.connected()) {
         // If the payload looks like printable text, use println for convenience
@@ -169,13 +152,34 @@ void Bluetooth::onTransmitData(const uint8_t* data, size_t len, const std::strin
             // send as string
             String s((const char*)data, len);
             SerialBT.println(s);
-            Serial.println("[Bluetooth] onTransmitData: sent as text via println");
         } else {
             SerialBT.write(data, len);
-            Serial.println("[Bluetooth] onTransmitData: sent as binary via write");
         }
     } else {
-        Serial.println("[Bluetooth] Cannot transmit - not connected");
+        LOG_WARN(BLUETOOTH, "Cannot transmit - not connected");
+    }
+}
+
+void Bluetooth::drainStream() {
+    uint8_t slot[STREAM_SLOT_SIZE];
+    size_t dropped = 0;
+
+    // At most one ring's worth per update, so commands are still read during a long transfer
+    for (size_t i = 0; i < STREAM_RING_CAPACITY && streamRing_.pop(slot, 1) == 1; i++) {
+        uint16_t len;
+        memcpy(&len, slot, sizeof(len));
+        if (len > MAX_STREAM_WRITE) {
+            continue;
+        }
+        if (SerialBT.connected()) {
+            SerialBT.write(slot + sizeof(len), len);
+        } else {
+            dropped++;
+        }
+    }
+
+    if (dropped > 0) {
+        LOG_WARN(BLUETOOTH, "Dropped %u stream writes - not connected", (unsigned)dropped);
     }
 }
 
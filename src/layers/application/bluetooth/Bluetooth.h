@@ -2,6 +2,7 @@
 #define BLUETOOTH_H
 
 #include "../ApplicationInterface.h"
+#include "../../data/SampleRing.h"
 #include <BluetoothSerial.h>
 #include <Arduino.h>
 
@@ -23,19 +24,30 @@ public:
     // Status
     String getConnectionStatus();
 
+    // Ordered binary output for bulk transfers (MeasurementApp's export frames). Each record is a
+    // u16 length and up to MAX_STREAM_WRITE bytes; the Bluetooth task writes them whole and in
+    // push order, unlike bluetooth/transmit messages, which each go out on their own delivery
+    // task. Single producer, wired in main.
+    static const size_t MAX_STREAM_WRITE = 990; // One SPP packet
+    static const size_t STREAM_SLOT_SIZE = 2 + MAX_STREAM_WRITE;
+    SampleRing* streamRing() { return &streamRing_; }
+
 private:
+    static const size_t STREAM_RING_CAPACITY = 8; // 8 KB in PSRAM, drained every update
 
     // Bluetooth hardware
     BluetoothSerial SerialBT;
 
     // State
     bool initialized_;
+    SampleRing streamRing_;
 
     // Network callbacks
     void onTransmitData(const uint8_t* data, size_t len, const std::string& topic);
 
     // Helper methods
     void logConnectionStatus();
+    void drainStream();
 };
 
 #endif // BLUETOOTH_H
\ No newline at end of file
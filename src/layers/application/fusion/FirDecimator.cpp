@@ -0,0 +1,91 @@
+#include "FirDecimator.h"
+#include <cmath>
+#include <cstring>
+
+static const double PI = 3.14159265358979323846;
+static const int32_t Q15_ONE = 32768;
+
+FirDecimator::FirDecimator()
+    : taps_(1),
+      pos_(0),
+      decimation_(1),
+      phase_(0) {
+    memset(coeffs_, 0, sizeof(coeffs_));
+    coeffs_[0] = 32767;
+    reset();
+}
+
+bool FirDecimator::configure(size_t taps, uint32_t decimation, float cutoff) {
+    if (taps == 0 || taps > MAX_TAPS || decimation == 0 || !(cutoff > 0.0f) || cutoff > 1.0f) {
+        return false;
+    }
+    if (taps % 2 == 0) {
+        taps--;
+    }
+
+    // Windowed sinc, designed in double once, then rounded to Q15
+    double h[MAX_TAPS];
+    double sum = 0;
+    int mid = (int)(taps / 2);
+    for (size_t i = 0; i < taps; i++) {
+        int n = (int)i - mid;
+        double ideal = n == 0 ? cutoff : sin(PI * cutoff * n) / (PI * n);
+        double window = taps > 1 ? 0.54 - 0.46 * cos(2 * PI * i / (taps - 1)) : 1.0;
+        h[i] = ideal * window;
+        sum += h[i];
+    }
+
+    // Unity DC gain: rounding error goes to the center tap
+    int32_t total = 0;
+    for (size_t i = 0; i < taps; i++) {
+        long c = lround(h[i] / sum * Q15_ONE);
+        coeffs_[i] = (int16_t)(c > 32767 ? 32767 : (c < -32768 ? -32768 : c));
+        total += coeffs_[i];
+    }
+    int32_t center = coeffs_[mid] + (Q15_ONE - total);
+    coeffs_[mid] = (int16_t)(center > 32767 ? 32767 : center);
+
+    taps_ = taps;
+    decimation_ = decimation;
+    reset();
+    return true;
+}
+
+void FirDecimator::reset() {
+    memset(history_, 0, sizeof(history_));
+    pos_ = 0;
+    phase_ = 0;
+}
+
+void FirDecimator::prime(const int16_t in[CHANNELS]) {
+    for (size_t c = 0; c < CHANNELS; c++) {
+        for (size_t i = 0; i < 2 * taps_; i++) {
+            history_[c][i] = in[c];
+        }
+    }
+}
+
+bool FirDecimator::push(const int16_t in[CHANNELS], int16_t out[CHANNELS]) {
+    // Newest sample at pos_, mirrored taps_ further on; the window is history_[c][pos_ .. pos_ + taps_)
+    pos_ = pos_ == 0 ? taps_ - 1 : pos_ - 1;
+    for (size_t c = 0; c < CHANNELS; c++) {
+        history_[c][pos_] = in[c];
+        history_[c][pos_ + taps_] = in[c];
+    }
+
+    if (++phase_ < decimation_) {
+        return false;
+    }
+    phase_ = 0;
+
+    for (size_t c = 0; c < CHANNELS; c++) {
+        const int16_t* x = &history_[c][pos_];
+        int64_t acc = 0;
+        for (size_t i = 0; i < taps_; i++) {
+            acc += (int32_t)coeffs_[i] * x[i];
+        }
+        acc = (acc + (1 << 14)) >> 15;
+        out[c] = (int16_t)(acc > 32767 ? 32767 : (acc < -32768 ? -32768 : acc));
+    }
+    return true;
+}
@@ -0,0 +1,51 @@
+#ifndef FIR_DECIMATOR_H
+#define FIR_DECIMATOR_H
+
+#include <cstdint>
+#include <cstddef>
+
+// Fixed-point low-pass FIR with decimation over the six int16 IMU channels.
+//
+// Coefficients are a Hamming-windowed sinc in Q15, normalized to unity DC gain, and run
+// directly on the sensor counts with a 64-bit accumulator, so no float conversion happens
+// per sample. Only every decimation-th input produces an output and only then is the dot
+// product computed, so the cost is taps * 6 multiply-adds per output, not per input. The
+// delay line is stored twice over so each output reads one contiguous window.
+class FirDecimator {
+public:
+    static const size_t CHANNELS = 6;
+    static const size_t MAX_TAPS = 63;
+
+    FirDecimator();
+
+    // taps is forced odd (linear phase, integer group delay); cutoff is the -6 dB point as a
+    // fraction of the input Nyquist frequency, 0 < cutoff <= 1. Returns false on bad arguments.
+    bool configure(size_t taps, uint32_t decimation, float cutoff);
+
+    // Clear the delay line; the next outputs ramp up from zero unless primed
+    void reset();
+
+    // Fill the delay line with one sample, so the output starts from it instead of from zero
+    void prime(const int16_t in[CHANNELS]);
+
+    // Feed one input sample; returns true and fills out on every decimation-th call
+    bool push(const int16_t in[CHANNELS], int16_t out[CHANNELS]);
+
+    size_t taps() const { return taps_; }
+    uint32_t decimation() const { return decimation_; }
+
+    // Delay through the filter, in input samples
+    size_t groupDelay() const { return taps_ / 2; }
+
+    const int16_t* coefficients() const { return coeffs_; }
+
+private:
+    int16_t coeffs_[MAX_TAPS];
+    int16_t history_[CHANNELS][2 * MAX_TAPS];
+    size_t taps_;
+    size_t pos_;
+    uint32_t decimation_;
+    uint32_t phase_;
+};
+
+#endif // FIR_DECIMATOR_H
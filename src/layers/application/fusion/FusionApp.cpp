@@ -0,0 +1,165 @@
+#include "FusionApp.h"
+#include "../../logging/Log.h"
+
+static const float DEG_TO_RAD_F = 0.01745329f;
+static const float Q14 = 16384.0f;
+
+FusionApp::FusionApp()
+    : ring_(MpuSample::RAW_SIZE, RING_CAPACITY),
+      madgwick_(FUSION_BETA),
+      quaternionSlot_(nullptr),
+      initialized_(false),
+      started_(false),
+      ranges_(0),
+      lastTimestampUs_(0),
+      lastDt_(0),
+      processed_(0),
+      reportedDrops_(0) {
+    Serial.println("[FusionApp] Created");
+}
+
+FusionApp::~FusionApp() {
+    if (initialized_) {
+        Serial.println("[FusionApp] Cleaned up");
+    }
+}
+
+bool FusionApp::setup() {
+    if (!networkLayer_ || !dataLayer_) {
+        Serial.println("[FusionApp] ERROR: Missing layer dependencies");
+        return false;
+    }
+
+    // Cutoff at 80% of the output Nyquist frequency, expressed against the input Nyquist
+    if (!fir_.configure(FUSION_FIR_TAPS, FUSION_DECIMATION, 0.8f / FUSION_DECIMATION)) {
+        Serial.println("[FusionApp] Invalid FIR configuration");
+        return false;
+    }
+
+    if (!ring_.isValid()) {
+        Serial.println("[FusionApp] Failed to allocate sample ring");
+        return false;
+    }
+
+    quaternionSlot_ = dataLayer_->registerHotSlot("fusion/quaternion", QUATERNION_SIZE, QUATERNION_TTL_MS);
+    if (!quaternionSlot_) {
+        Serial.println("[FusionApp] WARNING: Failed to register fusion/quaternion hot slot");
+    }
+
+    initialized_ = true;
+    Serial.printf("[FusionApp] Setup complete - decimation %u, %u-tap FIR, beta %.3f\n",
+                  (unsigned)fir_.decimation(), (unsigned)fir_.taps(), madgwick_.beta());
+    return true;
+}
+
+void FusionApp::update() {
+    if (!initialized_) {
+        return;
+    }
+
+    uint8_t batch[DRAIN_BATCH * MpuSample::RAW_SIZE];
+    size_t n;
+    do {
+        n = ring_.pop(batch, DRAIN_BATCH);
+        for (size_t i = 0; i < n; i++) {
+            Sample sample;
+            if (MpuSample::decode(batch + i * MpuSample::RAW_SIZE, MpuSample::RAW_SIZE, sample.timestampUs,
+                                  sample.ranges, sample.counts)) {
+                process(sample);
+            }
+        }
+    } while (n == DRAIN_BATCH);
+
+    uint32_t dropped = ring_.dropped();
+    if (dropped != reportedDrops_) {
+        LOG_WARN(FUSION, "%u samples dropped (ring full)", dropped - reportedDrops_);
+        reportedDrops_ = dropped;
+    }
+}
+
+bool FusionApp::getQuaternion(float q[4]) const {
+    uint8_t record[QUATERNION_SIZE];
+    if (!quaternionSlot_ || !quaternionSlot_->read(record, millis())) {
+        return false;
+    }
+
+    int16_t values[4];
+    memcpy(values, record + 8, sizeof(values));
+    for (int i = 0; i < 4; i++) {
+        q[i] = values[i] / Q14;
+    }
+    return true;
+}
+
+void FusionApp::process(const Sample& sample) {
+    int64_t elapsedUs = (int64_t)(sample.timestampUs - lastTimestampUs_);
+    if (!started_ || sample.ranges != ranges_ || elapsedUs > (int64_t)RESTART_GAP_US) {
+        restart(sample);
+        return;
+    }
+    if (elapsedUs <= 0) {
+        // Not newer than the last sample (FIFO re-anchored); integrating it would step backwards
+        return;
+    }
+    lastDt_ = elapsedUs * 1e-6f;
+    lastTimestampUs_ = sample.timestampUs;
+
+    const MpuRawCounts& c = sample.counts;
+    float gyroScale = DEG_TO_RAD_F / MpuSample::gyroLsbPerDps(ranges_);
+    // Accelerometer scale doesn't matter, only its direction is used
+    madgwick_.update(c.gx * gyroScale, c.gy * gyroScale, c.gz * gyroScale, c.ax, c.ay, c.az, lastDt_);
+    processed_++;
+
+    int16_t in[FirDecimator::CHANNELS] = {c.ax, c.ay, c.az, c.gx, c.gy, c.gz};
+    int16_t filtered[FirDecimator::CHANNELS];
+    if (fir_.push(in, filtered)) {
+        publishOutputs(sample.timestampUs, filtered);
+    }
+}
+
+void FusionApp::restart(const Sample& sample) {
+    const MpuRawCounts& c = sample.counts;
+    if (started_) {
+        LOG_INFO(FUSION, "Restarting filters (gap of %u ms or range change)",
+                 (uint32_t)((sample.timestampUs - lastTimestampUs_) / 1000));
+    }
+
+    started_ = true;
+    ranges_ = sample.ranges;
+    lastTimestampUs_ = sample.timestampUs;
+    lastDt_ = 0;
+
+    madgwick_.reset(c.ax, c.ay, c.az);
+    int16_t in[FirDecimator::CHANNELS] = {c.ax, c.ay, c.az, c.gx, c.gy, c.gz};
+    fir_.reset();
+    fir_.prime(in);
+    processed_++;
+}
+
+void FusionApp::publishOutputs(uint64_t timestampUs, const int16_t filtered[FirDecimator::CHANNELS]) {
+    float q[4];
+    madgwick_.getQuaternion(q);
+    int16_t values[4];
+    for (int i = 0; i < 4; i++) {
+        values[i] = (int16_t)(q[i] * Q14 + (q[i] < 0 ? -0.5f : 0.5f));
+    }
+
+    uint8_t quaternion[QUATERNION_SIZE];
+    memcpy(quaternion, &timestampUs, 8);
+    memcpy(quaternion + 8, values, sizeof(values));
+    networkLayer_->publish("fusion/quaternion", quaternion, sizeof(quaternion));
+    if (quaternionSlot_) {
+        quaternionSlot_->write(quaternion, (uint32_t)(timestampUs / 1000));
+    }
+
+    // The filtered signal lags the input by the FIR's group delay
+    uint64_t delayUs = (uint64_t)(fir_.groupDelay() * lastDt_ * 1e6f + 0.5f);
+    if (delayUs > timestampUs) {
+        delayUs = timestampUs;
+    }
+    MpuRawCounts counts;
+    memcpy(&counts, filtered, sizeof(counts));
+    uint8_t record[MpuSample::RAW_SIZE];
+    MpuSample::encode(record, timestampUs - delayUs, ranges_, counts);
+    networkLayer_->publish("fusion/filtered", record, sizeof(record));
+}
@@ -0,0 +1,92 @@
+#ifndef FUSION_APP_H
+#define FUSION_APP_H
+
+#include "../ApplicationInterface.h"
+#include "../mpu/MpuSample.h"
+#include "MadgwickFilter.h"
+#include "FirDecimator.h"
+#include "../../data/SampleRing.h"
+#include <Arduino.h>
+
+// Filter settings:
+//   -DFUSION_DECIMATION=5   Output one filtered sample and one quaternion per N MPU samples
+//                           (50 Hz in, 10 Hz out by default)
+//   -DFUSION_FIR_TAPS=31    Low-pass length (odd, up to 63); cutoff at 80% of the output Nyquist
+//   -DFUSION_BETA=0.1f      Madgwick gain: higher trusts the accelerometer more
+#ifndef FUSION_DECIMATION
+#define FUSION_DECIMATION 5
+#endif
+
+#ifndef FUSION_FIR_TAPS
+#define FUSION_FIR_TAPS 31
+#endif
+
+#ifndef FUSION_BETA
+#define FUSION_BETA 0.1f
+#endif
+
+// FusionApp
+// On-device processing stage for the IMU stream, so clients that only need attitude or a
+// low-rate signal don't have to receive every raw sample. Reads every MPU sample from its
+// sampleRing() (attached to the MPU as a consumer) and runs it through a Madgwick orientation filter and a decimating fixed-point FIR.
+// Publishes at the decimated rate:
+//
+//   fusion/quaternion  16 bytes: timestamp u64 (esp_timer us) | w x y z int16, Q14 (16384 = 1.0)
+//   fusion/filtered    22 bytes: mpu/raw layout (MpuSample.h), low-passed counts; the
+//                      timestamp is corrected for the filter's group delay
+//
+// The latest quaternion record is also kept in the fusion/quaternion hot slot. Samples are
+// processed in order on the app task, integrating over the intervals between their
+// microsecond timestamps; a gap of more than RESTART_GAP_US (capture stopped) or a
+// range change restarts both filters from the next sample.
+class FusionApp : public ApplicationInterface {
+public:
+    static const size_t QUATERNION_SIZE = 16;
+
+    FusionApp();
+    ~FusionApp();
+
+    bool setup();
+    void update();
+
+    // Latest orientation as w, x, y, z; false before the first sample
+    bool getQuaternion(float q[4]) const;
+
+    uint32_t processedCount() const { return processed_; }
+    uint32_t droppedCount() const { return ring_.dropped(); }
+
+    // Ring to attach to the sample producer (MPU::attachConsumer)
+    SampleRing* sampleRing() { return &ring_; }
+
+private:
+    struct Sample {
+        uint64_t timestampUs;
+        uint8_t ranges;
+        MpuRawCounts counts;
+    };
+
+    SampleRing ring_; // mpu/raw records waiting for the app task
+    MadgwickFilter madgwick_;
+    FirDecimator fir_;
+    HotSlot* quaternionSlot_;
+
+    bool initialized_;
+    bool started_;
+    uint8_t ranges_;
+    uint64_t lastTimestampUs_;
+    float lastDt_;
+    uint32_t processed_;
+    uint32_t reportedDrops_;
+
+    // Configuration
+    static const size_t RING_CAPACITY = 128;       // 2.6 s at 50 Hz, 128 ms at 1 kHz
+    static const size_t DRAIN_BATCH = 16;
+    static const uint32_t RESTART_GAP_US = 500000;
+    static const uint32_t QUATERNION_TTL_MS = 1000;
+
+    void process(const Sample& sample);
+    void restart(const Sample& sample);
+    void publishOutputs(uint64_t timestampUs, const int16_t filtered[FirDecimator::CHANNELS]);
+};
+
+#endif // FUSION_APP_H
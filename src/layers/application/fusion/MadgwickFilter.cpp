@@ -0,0 +1,92 @@
+#include "MadgwickFilter.h"
+#include <cmath>
+
+MadgwickFilter::MadgwickFilter(float beta)
+    : beta_(beta),
+      q0_(1.0f),
+      q1_(0.0f),
+      q2_(0.0f),
+      q3_(0.0f) {}
+
+void MadgwickFilter::reset(float ax, float ay, float az) {
+    float norm = sqrtf(ax * ax + ay * ay + az * az);
+    if (norm == 0.0f) {
+        q0_ = 1.0f;
+        q1_ = q2_ = q3_ = 0.0f;
+        return;
+    }
+
+    // Roll and pitch from gravity, then the quaternion of those Euler angles with yaw 0
+    float roll = atan2f(ay, az);
+    float pitch = atan2f(-ax, sqrtf(ay * ay + az * az));
+    float cr = cosf(roll * 0.5f), sr = sinf(roll * 0.5f);
+    float cp = cosf(pitch * 0.5f), sp = sinf(pitch * 0.5f);
+    q0_ = cr * cp;
+    q1_ = sr * cp;
+    q2_ = cr * sp;
+    q3_ = -sr * sp;
+}
+
+void MadgwickFilter::update(float gx, float gy, float gz, float ax, float ay, float az, float dt) {
+    // Rate of change of the quaternion from the gyro
+    float qDot0 = 0.5f * (-q1_ * gx - q2_ * gy - q3_ * gz);
+    float qDot1 = 0.5f * (q0_ * gx + q2_ * gz - q3_ * gy);
+    float qDot2 = 0.5f * (q0_ * gy - q1_ * gz + q3_ * gx);
+    float qDot3 = 0.5f * (q0_ * gz + q1_ * gy - q2_ * gx);
+
+    // Gravity correction, skipped when the accelerometer reads nothing (free fall or no data)
+    float norm = sqrtf(ax * ax + ay * ay + az * az);
+    if (norm > 0.0f) {
+        float recip = 1.0f / norm;
+        ax *= recip;
+        ay *= recip;
+        az *= recip;
+
+        float _2q0 = 2.0f * q0_;
+        float _2q1 = 2.0f * q1_;
+        float _2q2 = 2.0f * q2_;
+        float _2q3 = 2.0f * q3_;
+        float _4q0 = 4.0f * q0_;
+        float _4q1 = 4.0f * q1_;
+        float _4q2 = 4.0f * q2_;
+        float _8q1 = 8.0f * q1_;
+        float _8q2 = 8.0f * q2_;
+        float q0q0 = q0_ * q0_;
+        float q1q1 = q1_ * q1_;
+        float q2q2 = q2_ * q2_;
+        float q3q3 = q3_ * q3_;
+
+        // Gradient of the error between measured and predicted gravity
+        float s0 = _4q0 * q2q2 + _2q2 * ax + _4q0 * q1q1 - _2q1 * ay;
+        float s1 = _4q1 * q3q3 - _2q3 * ax + 4.0f * q0q0 * q1_ - _2q0 * ay - _4q1 + _8q1 * q1q1 + _8q1 * q2q2 + _4q1 * az;
+        float s2 = 4.0f * q0q0 * q2_ + _2q0 * ax + _4q2 * q3q3 - _2q3 * ay - _4q2 + _8q2 * q1q1 + _8q2 * q2q2 + _4q2 * az;
+        float s3 = 4.0f * q1q1 * q3_ - _2q1 * ax + 4.0f * q2q2 * q3_ - _2q2 * ay;
+
+        norm = sqrtf(s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3);
+        if (norm > 0.0f) {
+            recip = beta_ / norm;
+            qDot0 -= s0 * recip;
+            qDot1 -= s1 * recip;
+            qDot2 -= s2 * recip;
+            qDot3 -= s3 * recip;
+        }
+    }
+
+    q0_ += qDot0 * dt;
+    q1_ += qDot1 * dt;
+    q2_ += qDot2 * dt;
+    q3_ += qDot3 * dt;
+
+    float recip = 1.0f / sqrtf(q0_ * q0_ + q1_ * q1_ + q2_ * q2_ + q3_ * q3_);
+    q0_ *= recip;
+    q1_ *= recip;
+    q2_ *= recip;
+    q3_ *= recip;
+}
+
+void MadgwickFilter::getQuaternion(float q[4]) const {
+    q[0] = q0_;
+    q[1] = q1_;
+    q[2] = q2_;
+    q[3] = q3_;
+}
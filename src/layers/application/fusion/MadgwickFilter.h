@@ -0,0 +1,33 @@
+#ifndef MADGWICK_FILTER_H
+#define MADGWICK_FILTER_H
+
+// Madgwick's gradient-descent orientation filter, IMU variant (accel + gyro, no magnetometer).
+// Gyro rates are integrated into the quaternion and a step of size beta along the gradient of
+// the gravity error pulls it back toward the accelerometer; larger beta trusts the
+// accelerometer more (faster convergence, more vibration noise). Yaw is unobservable without
+// a magnetometer and drifts with the gyro bias.
+//
+// Single-precision float throughout: the ESP32 has a hardware FPU, and one update is about
+// 120 multiply-adds.
+class MadgwickFilter {
+public:
+    explicit MadgwickFilter(float beta = 0.1f);
+
+    // Start from the attitude the accelerometer implies (yaw 0) instead of converging from identity
+    void reset(float ax, float ay, float az);
+
+    // Gyro in rad/s, accel in any consistent unit (only its direction is used), dt in seconds
+    void update(float gx, float gy, float gz, float ax, float ay, float az, float dt);
+
+    void setBeta(float beta) { beta_ = beta; }
+    float beta() const { return beta_; }
+
+    // Orientation as w, x, y, z (sensor frame to earth frame)
+    void getQuaternion(float q[4]) const;
+
+private:
+    float beta_;
+    float q0_, q1_, q2_, q3_;
+};
+
+#endif // MADGWICK_FILTER_H
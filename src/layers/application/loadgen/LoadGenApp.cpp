@@ -0,0 +1,511 @@
+#include "LoadGenApp.h"
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <algorithm>
+#include "../../logging/Log.h"
+
+LoadGenApp::LoadGenApp()
+    : initialized_(false),
+      state_(STATE_IDLE),
+      commands_(nullptr),
+      startUs_(0),
+      lastTickUs_(0),
+      stopUs_(0),
+      publishCreditMilli_(0),
+      dataCreditMilli_(0),
+      nextTopic_(0),
+      sequence_(0),
+      random_(0x2545F491u),
+      published_(0),
+      publishFailures_(0),
+      delivered_(0),
+      behind_(0),
+      dataOps_(0),
+      dataFailures_(0),
+      dataMisses_(0),
+      deliveryIndex_(0),
+      dataIndex_(0) {
+    resetConfig();
+    Serial.println("[LoadGenApp] Created");
+}
+
+LoadGenApp::~LoadGenApp() {
+    if (initialized_) {
+        if (state_ != STATE_IDLE) {
+            unsubscribeLoadTopics();
+        }
+        networkLayer_->unsubscribe("bluetooth/command", "LoadGenApp");
+        Serial.println("[LoadGenApp] Cleaned up");
+    }
+    if (commands_ != nullptr) {
+        vQueueDelete(commands_);
+        commands_ = nullptr;
+    }
+}
+
+bool LoadGenApp::setup() {
+    if (!networkLayer_ || !dataLayer_) {
+        Serial.println("[LoadGenApp] ERROR: Missing layer dependencies");
+        return false;
+    }
+
+    commands_ = xQueueCreate(COMMAND_QUEUE_DEPTH, sizeof(Command));
+    if (commands_ == nullptr) {
+        Serial.println("[LoadGenApp] Failed to create command queue");
+        return false;
+    }
+
+    auto commandCallback = [this](const uint8_t* data, size_t len, const std::string& topic) {
+        this->onBluetoothCommand(data, len, topic);
+    };
+
+    if (!networkLayer_->subscribe("bluetooth/command", "LoadGenApp", commandCallback)) {
+        Serial.println("[LoadGenApp] Failed to subscribe to bluetooth/command");
+        return false;
+    }
+
+    initialized_ = true;
+    Serial.println("[LoadGenApp] Setup complete - idle until LOAD START");
+    return true;
+}
+
+void LoadGenApp::update() {
+    if (!initialized_) {
+        return;
+    }
+
+    // Commands arrive on broker tasks; state and config changes happen here, on the app task
+    Command command;
+    while (xQueueReceive(commands_, &command, 0) == pdTRUE) {
+        handleCommand(command);
+    }
+
+    uint64_t now = esp_timer_get_time();
+
+    if (state_ == STATE_RUNNING) {
+        generateMessages(now);
+        generateDataOps(now);
+        lastTickUs_ = now;
+
+        if (config_.durationMs > 0 && now - startUs_ >= (uint64_t)config_.durationMs * 1000) {
+            stop();
+        }
+    } else if (state_ == STATE_DRAINING) {
+        uint64_t expected = (uint64_t)published_.load() * config_.fanout;
+        if (delivered_.load() >= expected || now - stopUs_ >= (uint64_t)DRAIN_TIMEOUT_MS * 1000) {
+            finish();
+        }
+    }
+}
+
+LoadGenApp::Report LoadGenApp::report() const {
+    Report r;
+    uint64_t end = (state_ == STATE_RUNNING) ? esp_timer_get_time() : stopUs_;
+    r.elapsedMs = startUs_ > 0 ? (uint32_t)((end - startUs_) / 1000) : 0;
+    r.published = published_.load();
+    r.publishFailures = publishFailures_.load();
+    r.delivered = delivered_.load();
+    uint64_t expected = (uint64_t)r.published * config_.fanout;
+    r.undelivered = expected > r.delivered ? (uint32_t)(expected - r.delivered) : 0;
+    r.behind = behind_.load();
+    r.dataOps = dataOps_.load();
+    r.dataFailures = dataFailures_.load();
+    r.dataMisses = dataMisses_.load();
+    r.delivery = percentiles(deliveryUs_, std::min<uint32_t>(deliveryIndex_.load(), LATENCY_SAMPLES));
+    r.data = percentiles(dataUs_, std::min<uint32_t>(dataIndex_.load(), LATENCY_SAMPLES));
+    return r;
+}
+
+void LoadGenApp::onBluetoothCommand(const uint8_t* data, size_t len, const std::string& topic) {
+    if (len < 4 || len > 64) {
+        return;
+    }
+
+    String command((const char*)data, len);
+    command.trim();
+    command.toUpperCase();
+    if (!command.startsWith("LOAD")) {
+        return;
+    }
+
+    // LOAD <VERB> [PARAM VALUE]
+    String args = command.substring(4);
+    args.trim();
+    int space = args.indexOf(' ');
+    String verb = space < 0 ? args : args.substring(0, space);
+    String rest = space < 0 ? String("") : args.substring(space + 1);
+    rest.trim();
+
+    Command parsed = {REQUEST_SET, PARAM_UNKNOWN, 0};
+    if (verb == "START") {
+        parsed.request = REQUEST_START;
+    } else if (verb == "STOP") {
+        parsed.request = REQUEST_STOP;
+    } else if (verb == "STATUS") {
+        parsed.request = REQUEST_STATUS;
+    } else if (verb == "CONFIG") {
+        parsed.request = REQUEST_CONFIG;
+    } else if (verb == "RESET") {
+        parsed.request = REQUEST_RESET;
+    } else if (verb == "SET") {
+        int split = rest.indexOf(' ');
+        if (split < 0) {
+            reply("LOAD ERR usage: LOAD SET <PARAM> <VALUE>\n");
+            return;
+        }
+        String value = rest.substring(split + 1);
+        value.trim();
+
+        parsed.param = parseParam(rest.substring(0, split));
+        if (parsed.param == PARAM_UNKNOWN) {
+            reply("LOAD ERR unknown parameter\n");
+            return;
+        }
+        long number = value.toInt();
+        if (number < 0) {
+            reply("LOAD ERR negative value\n");
+            return;
+        }
+        parsed.value = (uint32_t)number;
+    } else {
+        reply("LOAD ERR unknown command\n");
+        return;
+    }
+
+    if (xQueueSend(commands_, &parsed, 0) != pdTRUE) {
+        reply("LOAD ERR busy\n");
+    }
+}
+
+void LoadGenApp::handleCommand(const Command& command) {
+    switch (command.request) {
+        case REQUEST_START:
+            if (state_ == STATE_IDLE) {
+                start();
+            }
+            break;
+        case REQUEST_STOP:
+            if (state_ == STATE_RUNNING) {
+                stop();
+            }
+            break;
+        case REQUEST_STATUS:
+            publishReport();
+            break;
+        case REQUEST_CONFIG:
+            replyConfig();
+            break;
+        case REQUEST_RESET:
+            if (state_ != STATE_IDLE) {
+                reply("LOAD ERR running\n");
+                break;
+            }
+            resetConfig();
+            replyConfig();
+            break;
+        case REQUEST_SET:
+            handleSet(command.param, command.value);
+            break;
+    }
+}
+
+LoadGenApp::Param LoadGenApp::parseParam(const String& name) {
+    static const char* const NAMES[PARAM_UNKNOWN] = {
+        "RATE", "SIZE", "BURST", "FANOUT", "TOPICS", "DATA_RATE", "DATA_KEYS", "DATA_SIZE", "READS",
+        "DATA_TTL", "DURATION"
+    };
+    for (int i = 0; i < PARAM_UNKNOWN; i++) {
+        if (name == NAMES[i]) {
+            return (Param)i;
+        }
+    }
+    return PARAM_UNKNOWN;
+}
+
+void LoadGenApp::handleSet(uint8_t param, uint32_t value) {
+    // The subscriptions made by start() are undone from config_, so it holds still while running
+    if (state_ != STATE_IDLE) {
+        reply("LOAD ERR running\n");
+        return;
+    }
+
+    switch (param) {
+        case PARAM_RATE:
+            config_.rate = value;
+            break;
+        case PARAM_SIZE:
+            config_.payloadSize = value < MIN_PAYLOAD_SIZE ? MIN_PAYLOAD_SIZE : value;
+            break;
+        case PARAM_BURST:
+            config_.burst = std::max<uint32_t>(value, 1);
+            break;
+        case PARAM_FANOUT:
+            config_.fanout = value;
+            break;
+        case PARAM_TOPICS:
+            config_.topics = std::max<uint32_t>(value, 1);
+            break;
+        case PARAM_DATA_RATE:
+            config_.dataRate = value;
+            break;
+        case PARAM_DATA_KEYS:
+            config_.dataKeys = std::max<uint32_t>(value, 1);
+            break;
+        case PARAM_DATA_SIZE:
+            config_.dataSize = std::max<uint32_t>(value, 1);
+            break;
+        case PARAM_READS:
+            config_.readPercent = std::min<uint32_t>(value, 100);
+            break;
+        case PARAM_DATA_TTL:
+            config_.dataTtlMs = value;
+            break;
+        case PARAM_DURATION:
+            config_.durationMs = value;
+            break;
+        default:
+            return;
+    }
+
+    replyConfig();
+}
+
+void LoadGenApp::onLoadMessage(const uint8_t* data, size_t len, const std::string& topic) {
+    if (len < MIN_PAYLOAD_SIZE) {
+        return;
+    }
+
+    int64_t sentUs;
+    memcpy(&sentUs, data, sizeof(sentUs));
+    uint32_t latency = (uint32_t)(esp_timer_get_time() - sentUs);
+
+    deliveryUs_[deliveryIndex_.fetch_add(1) % LATENCY_SAMPLES] = latency;
+    delivered_.fetch_add(1);
+}
+
+void LoadGenApp::start() {
+    resetCounters();
+
+    payload_.assign(config_.payloadSize, 0x5A);
+    dataValue_.assign(config_.dataSize, 0xA5);
+    readBuffer_.resize(config_.dataSize);
+
+    topicNames_.clear();
+    for (uint32_t i = 0; i < config_.topics; i++) {
+        topicNames_.push_back("loadgen/t" + std::to_string(i));
+    }
+    keyNames_.clear();
+    for (uint32_t i = 0; i < config_.dataKeys; i++) {
+        keyNames_.push_back("loadgen/k" + std::to_string(i));
+    }
+
+    subscribeLoadTopics();
+
+    startUs_ = esp_timer_get_time();
+    lastTickUs_ = startUs_;
+    state_ = STATE_RUNNING;
+
+    LOG_INFO(LOADGEN, "Started: %u msg/s x %u B, burst %u, fanout %u over %u topics; %u data ops/s",
+             config_.rate, config_.payloadSize, config_.burst, config_.fanout, config_.topics, config_.dataRate);
+    reply("LOAD STARTED\n");
+}
+
+void LoadGenApp::stop() {
+    stopUs_ = esp_timer_get_time();
+    state_ = STATE_DRAINING;
+}
+
+void LoadGenApp::finish() {
+    unsubscribeLoadTopics();
+    state_ = STATE_IDLE;
+
+    Report r = report();
+    LOG_INFO(LOADGEN, "Finished after %u ms: %u published, %u delivered, %u undelivered, %u behind",
+             r.elapsedMs, r.published, r.delivered, r.undelivered, r.behind);
+    publishReport();
+}
+
+void LoadGenApp::generateMessages(uint64_t nowUs) {
+    if (config_.rate == 0 || topicNames_.empty()) {
+        return;
+    }
+
+    uint32_t cap = (uint32_t)((uint64_t)config_.rate * MAX_BACKLOG_MS / 1000) + config_.burst;
+    behind_.fetch_add(accrue(publishCreditMilli_, config_.rate, nowUs - lastTickUs_, cap));
+
+    uint64_t burstMilli = (uint64_t)config_.burst * 1000;
+    while (publishCreditMilli_ >= burstMilli) {
+        publishCreditMilli_ -= burstMilli;
+
+        for (uint32_t i = 0; i < config_.burst; i++) {
+            const std::string& topic = topicNames_[nextTopic_];
+            nextTopic_ = (nextTopic_ + 1) % topicNames_.size();
+
+            // timestamp(8) + sequence(4), rest is filler
+            int64_t sentUs = esp_timer_get_time();
+            uint32_t sequence = sequence_++;
+            memcpy(payload_.data(), &sentUs, sizeof(sentUs));
+            memcpy(payload_.data() + 8, &sequence, sizeof(sequence));
+
+            if (networkLayer_->publish(topic, payload_.data(), payload_.size(), "LoadGenApp")) {
+                published_.fetch_add(1);
+            } else {
+                publishFailures_.fetch_add(1);
+            }
+        }
+    }
+}
+
+void LoadGenApp::generateDataOps(uint64_t nowUs) {
+    if (config_.dataRate == 0 || keyNames_.empty()) {
+        return;
+    }
+
+    uint32_t cap = (uint32_t)((uint64_t)config_.dataRate * MAX_BACKLOG_MS / 1000) + 1;
+    behind_.fetch_add(accrue(dataCreditMilli_, config_.dataRate, nowUs - lastTickUs_, cap));
+
+    while (dataCreditMilli_ >= 1000) {
+        dataCreditMilli_ -= 1000;
+
+        const std::string& key = keyNames_[nextRandom() % keyNames_.size()];
+        bool isRead = nextRandom() % 100 < config_.readPercent;
+
+        int64_t before = esp_timer_get_time();
+        if (isRead) {
+            size_t len = 0;
+            if (!dataLayer_->get(key, readBuffer_.data(), readBuffer_.size(), len)) {
+                dataMisses_.fetch_add(1);
+            }
+        } else if (!dataLayer_->set(key, dataValue_.data(), dataValue_.size(), config_.dataTtlMs)) {
+            dataFailures_.fetch_add(1);
+        }
+        uint32_t latency = (uint32_t)(esp_timer_get_time() - before);
+
+        dataUs_[dataIndex_.fetch_add(1) % LATENCY_SAMPLES] = latency;
+        dataOps_.fetch_add(1);
+    }
+}
+
+uint32_t LoadGenApp::accrue(uint64_t& creditMilli, uint32_t ratePerSec, uint64_t elapsedUs, uint32_t capUnits) {
+    // rate [1/s] * elapsed [us] / 1000 = owed work in thousandths
+    creditMilli += (uint64_t)ratePerSec * elapsedUs / 1000;
+
+    // A stalled task shouldn't come back and flood the system to catch up
+    uint64_t capMilli = (uint64_t)capUnits * 1000;
+    if (creditMilli <= capMilli) {
+        return 0;
+    }
+    uint32_t dropped = (uint32_t)((creditMilli - capMilli) / 1000);
+    creditMilli -= (uint64_t)dropped * 1000;
+    return dropped;
+}
+
+void LoadGenApp::subscribeLoadTopics() {
+    auto loadCallback = [this](const uint8_t* data, size_t len, const std::string& topic) {
+        this->onLoadMessage(data, len, topic);
+    };
+
+    for (const std::string& topic : topicNames_) {
+        for (uint32_t i = 0; i < config_.fanout; i++) {
+            networkLayer_->subscribe(topic, "LoadGen" + std::to_string(i), loadCallback);
+        }
+    }
+}
+
+void LoadGenApp::unsubscribeLoadTopics() {
+    for (const std::string& topic : topicNames_) {
+        for (uint32_t i = 0; i < config_.fanout; i++) {
+            networkLayer_->unsubscribe(topic, "LoadGen" + std::to_string(i));
+        }
+    }
+}
+
+void LoadGenApp::resetConfig() {
+    config_.rate = 100;
+    config_.payloadSize = 32;
+    config_.burst = 1;
+    config_.fanout = 1;
+    config_.topics = 1;
+    config_.dataRate = 0;
+    config_.dataKeys = 64;
+    config_.dataSize = 16;
+    config_.readPercent = 80;
+    config_.dataTtlMs = DEFAULT_DATA_TTL_MS;
+    config_.durationMs = 0;
+}
+
+void LoadGenApp::resetCounters() {
+    published_ = 0;
+    publishFailures_ = 0;
+    delivered_ = 0;
+    behind_ = 0;
+    dataOps_ = 0;
+    dataFailures_ = 0;
+    dataMisses_ = 0;
+    deliveryIndex_ = 0;
+    dataIndex_ = 0;
+    publishCreditMilli_ = 0;
+    dataCreditMilli_ = 0;
+    nextTopic_ = 0;
+    sequence_ = 0;
+    stopUs_ = 0;
+}
+
+void LoadGenApp::publishReport() {
+    Report r = report();
+    networkLayer_->publish("loadgen/report", reinterpret_cast<const uint8_t*>(&r), sizeof(r), "LoadGenApp");
+
+    double seconds = r.elapsedMs / 1000.0;
+    char line[160];
+    snprintf(line, sizeof(line),
+             "LOAD %s t=%ums pub=%u (%.1f/s) fail=%u deliv=%u undeliv=%u behind=%u lat_us p50=%u p90=%u p99=%u max=%u\n",
+             state_ == STATE_IDLE ? "DONE" : "RUNNING", r.elapsedMs, r.published,
+             seconds > 0 ? r.published / seconds : 0.0, r.publishFailures, r.delivered, r.undelivered, r.behind,
+             r.delivery.p50Us, r.delivery.p90Us, r.delivery.p99Us, r.delivery.maxUs);
+    reply(line);
+
+    if (config_.dataRate > 0) {
+        snprintf(line, sizeof(line),
+                 "LOAD DATA ops=%u (%.1f/s) fail=%u miss=%u lat_us p50=%u p90=%u p99=%u max=%u\n",
+                 r.dataOps, seconds > 0 ? r.dataOps / seconds : 0.0, r.dataFailures, r.dataMisses,
+                 r.data.p50Us, r.data.p90Us, r.data.p99Us, r.data.maxUs);
+        reply(line);
+    }
+}
+
+void LoadGenApp::replyConfig() {
+    char line[192];
+    snprintf(line, sizeof(line),
+             "LOAD CONFIG RATE=%u SIZE=%u BURST=%u FANOUT=%u TOPICS=%u DATA_RATE=%u DATA_KEYS=%u "
+             "DATA_SIZE=%u READS=%u DATA_TTL=%u DURATION=%u\n",
+             config_.rate, config_.payloadSize, config_.burst, config_.fanout, config_.topics, config_.dataRate,
+             config_.dataKeys, config_.dataSize, config_.readPercent, config_.dataTtlMs, config_.durationMs);
+    reply(line);
+}
+
+void LoadGenApp::reply(const char* text) {
+    networkLayer_->publish("bluetooth/transmit", (const uint8_t*)text, strlen(text), "LoadGenApp");
+}
+
+uint32_t LoadGenApp::nextRandom() {
+    // xorshift32; fixed seed so simulated runs repeat exactly
+    random_ ^= random_ << 13;
+    random_ ^= random_ >> 17;
+    random_ ^= random_ << 5;
+    return random_;
+}
+
+LoadGenApp::Latency LoadGenApp::percentiles(const uint32_t* samples, uint32_t count) {
+    Latency latency = {0, 0, 0, 0};
+    if (count == 0) {
+        return latency;
+    }
+
+    std::vector<uint32_t> sorted(samples, samples + count);
+    std::sort(sorted.begin(), sorted.end());
+    latency.p50Us = sorted[(count - 1) * 50 / 100];
+    latency.p90Us = sorted[(count - 1) * 90 / 100];
+    latency.p99Us = sorted[(count - 1) * 99 / 100];
+    latency.maxUs = sorted[count - 1];
+    return latency;
+}
@@ -0,0 +1,178 @@
+#ifndef LOAD_GEN_APP_H
+#define LOAD_GEN_APP_H
+
+#include "../ApplicationInterface.h"
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <atomic>
+#include <string>
+#include <vector>
+
+// LoadGenApp
+// Synthetic load for soak-testing a production build in place. Publishes a configurable topic
+// mix to its own subscribers and runs a configurable DataLayer op mix, then reports achieved
+// throughput, lost deliveries and latency percentiles. Idle until told otherwise over
+// Bluetooth:
+//
+//   LOAD SET <PARAM> <VALUE>   Change a parameter (only while stopped)
+//   LOAD START / LOAD STOP     Run until STOP or DURATION elapses, then report
+//   LOAD STATUS                Report now (also while running)
+//   LOAD CONFIG / LOAD RESET   Show parameters / restore defaults
+class LoadGenApp : public ApplicationInterface {
+public:
+    struct Config {
+        uint32_t rate;         // RATE: messages per second across all topics (0 = no publishing)
+        uint32_t payloadSize;  // SIZE: bytes per message, at least 12 (timestamp + sequence)
+        uint32_t burst;        // BURST: messages published back to back per burst
+        uint32_t fanout;       // FANOUT: subscribers per topic
+        uint32_t topics;       // TOPICS: loadgen/t0 .. loadgen/t<n-1>, used round-robin
+        uint32_t dataRate;     // DATA_RATE: DataLayer ops per second (0 = none)
+        uint32_t dataKeys;     // DATA_KEYS: loadgen/k0 .. loadgen/k<n-1>, picked at random
+        uint32_t dataSize;     // DATA_SIZE: bytes per set
+        uint32_t readPercent;  // READS: share of ops that are gets, the rest are sets
+        uint32_t dataTtlMs;    // DATA_TTL: TTL for sets (0 = none, kept until deleted or reboot)
+        uint32_t durationMs;   // DURATION: stop by itself after this long (0 = until LOAD STOP)
+    };
+
+    struct Latency {
+        uint32_t p50Us;
+        uint32_t p90Us;
+        uint32_t p99Us;
+        uint32_t maxUs;
+    };
+
+    // Published as-is on loadgen/report alongside the text report on bluetooth/transmit
+    struct Report {
+        uint32_t elapsedMs;
+        uint32_t published;
+        uint32_t publishFailures;  // publish() returned false
+        uint32_t delivered;        // Subscriber callbacks run
+        uint32_t undelivered;      // published * fanout - delivered: in flight while running, lost once stopped
+        uint32_t behind;           // Messages or ops skipped because the task fell behind
+        uint32_t dataOps;
+        uint32_t dataFailures;     // Failed sets; misses on get are counted as hits and misses below
+        uint32_t dataMisses;
+        Latency delivery;          // Publish to subscriber callback
+        Latency data;              // One DataLayer call
+    };
+
+    LoadGenApp();
+    ~LoadGenApp();
+
+    bool setup();
+    void update();
+
+    bool isRunning() const { return state_ != STATE_IDLE; }
+    const Config& config() const { return config_; }
+    Report report() const;
+
+private:
+    enum State {
+        STATE_IDLE,
+        STATE_RUNNING,
+        STATE_DRAINING  // Stopped publishing, waiting for in-flight deliveries
+    };
+
+    enum Request {
+        REQUEST_START,
+        REQUEST_STOP,
+        REQUEST_STATUS,
+        REQUEST_CONFIG,
+        REQUEST_RESET,
+        REQUEST_SET
+    };
+
+    enum Param {
+        PARAM_RATE,
+        PARAM_SIZE,
+        PARAM_BURST,
+        PARAM_FANOUT,
+        PARAM_TOPICS,
+        PARAM_DATA_RATE,
+        PARAM_DATA_KEYS,
+        PARAM_DATA_SIZE,
+        PARAM_READS,
+        PARAM_DATA_TTL,
+        PARAM_DURATION,
+        PARAM_UNKNOWN
+    };
+
+    // Parsed on the broker task, applied by update() on the app task
+    struct Command {
+        uint8_t request;  // Request
+        uint8_t param;    // Param, for REQUEST_SET
+        uint32_t value;
+    };
+
+    static const size_t LATENCY_SAMPLES = 256;      // Most recent samples kept for percentiles
+    static const uint32_t MAX_BACKLOG_MS = 100;     // Owed work beyond this much is dropped as "behind"
+    static const uint32_t DEFAULT_DATA_TTL_MS = 60000; // loadgen/k* expire after a soak instead of lingering
+    static const uint32_t DRAIN_TIMEOUT_MS = 1000;
+    static const uint32_t MIN_PAYLOAD_SIZE = 12;
+    static const size_t COMMAND_QUEUE_DEPTH = 8;
+
+    bool initialized_;
+    Config config_;
+    State state_;
+    QueueHandle_t commands_;  // Commands in arrival order; config_ and state_ change only on the app task
+
+    // Generator state, owned by the app task
+    uint64_t startUs_;
+    uint64_t lastTickUs_;
+    uint64_t stopUs_;
+    uint64_t publishCreditMilli_;  // Messages owed, in thousandths
+    uint64_t dataCreditMilli_;
+    uint32_t nextTopic_;
+    uint32_t sequence_;
+    uint32_t random_;
+    std::vector<uint8_t> payload_;
+    std::vector<uint8_t> dataValue_;
+    std::vector<uint8_t> readBuffer_;  // DATA_SIZE bytes, so every get of a set value fits
+    std::vector<std::string> topicNames_;
+    std::vector<std::string> keyNames_;
+
+    // Counters; delivery callbacks run on broker tasks
+    std::atomic<uint32_t> published_;
+    std::atomic<uint32_t> publishFailures_;
+    std::atomic<uint32_t> delivered_;
+    std::atomic<uint32_t> behind_;
+    std::atomic<uint32_t> dataOps_;
+    std::atomic<uint32_t> dataFailures_;
+    std::atomic<uint32_t> dataMisses_;
+    std::atomic<uint32_t> deliveryIndex_;
+    std::atomic<uint32_t> dataIndex_;
+    uint32_t deliveryUs_[LATENCY_SAMPLES];
+    uint32_t dataUs_[LATENCY_SAMPLES];
+
+    // Network callbacks
+    void onBluetoothCommand(const uint8_t* data, size_t len, const std::string& topic);
+    void onLoadMessage(const uint8_t* data, size_t len, const std::string& topic);
+
+    // Command handlers
+    void handleCommand(const Command& command);
+    void handleSet(uint8_t param, uint32_t value);
+    void replyConfig();
+    static Param parseParam(const String& name);
+
+    // Load generation
+    void start();
+    void stop();
+    void finish();
+    void generateMessages(uint64_t nowUs);
+    void generateDataOps(uint64_t nowUs);
+    void subscribeLoadTopics();
+    void unsubscribeLoadTopics();
+
+    // Helper methods
+    void resetConfig();
+    void resetCounters();
+    void publishReport();
+    void reply(const char* text);
+    uint32_t nextRandom();
+    static Latency percentiles(const uint32_t* samples, uint32_t count);
+    // Add owed work for elapsedUs; returns units dropped beyond capUnits
+    static uint32_t accrue(uint64_t& creditMilli, uint32_t ratePerSec, uint64_t elapsedUs, uint32_t capUnits);
+};
+
+#endif // LOAD_GEN_APP_H
@@ -0,0 +1,174 @@
+#ifndef EXPORT_FRAME_H
+#define EXPORT_FRAME_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include "../mpu/MpuSample.h"
+#include "../../data/Crc32.h"
+
+// Binary export of a recording (MeasurementApp "FORMAT BIN"): fixed-size packed sample records
+// in frames that fit one Bluetooth SPP packet, each with its own CRC32 so the host can tell a
+// damaged frame from a good one and ask for the recording again.
+//
+// Frame (little-endian):
+//   sync 0xA5 0x5A | type u8 | version u8 | session u32 | sequence u16 | length u16 | payload | crc32 u32
+// crc32 (Crc32.h) covers everything from sync to the end of the payload. Frames reach the link
+// through the Bluetooth app's stream ring, written whole and in order.
+//
+// A recording is sent as HEADER, DATA..., END with sequence numbers 0, 1, 2, ... and the same
+// session id, which changes per recording but not when one recording is sent again (DATA).
+//   HEADER payload (24 bytes): format u8 | ranges u8 | record size u16 | sample count u32 |
+//                              rate mHz u32 | start_us u64 | data frames u32
+//   DATA payload:              first sample index u32 | records
+//   END payload (12 bytes):    sample count u32 | data frames u32 | crc32 of all records u32
+//
+// Records (t_us counts from the first sample, taken at start_us on the device's esp_timer clock):
+//   FORMAT_MPU_COUNTS (16 bytes): t_us u32 | ax ay az gx gy gz int16, counts at the header's ranges
+//   FORMAT_MPU_SI (28 bytes):     t_us u32 | ax ay az (m/s^2) gx gy gz (rad/s) float32
+namespace ExportFrame {
+
+static const uint8_t SYNC0 = 0xA5;
+static const uint8_t SYNC1 = 0x5A;
+static const uint8_t VERSION = 1;
+
+enum Type : uint8_t {
+    TYPE_HEADER = 1,
+    TYPE_DATA = 2,
+    TYPE_END = 3
+};
+
+enum Format : uint8_t {
+    FORMAT_MPU_COUNTS = 1,
+    FORMAT_MPU_SI = 2
+};
+
+static const size_t PREFIX_SIZE = 12;
+static const size_t CRC_SIZE = 4;
+static const size_t MAX_FRAME = 990;  // ESP32 SPP MTU
+static const size_t MAX_PAYLOAD = MAX_FRAME - PREFIX_SIZE - CRC_SIZE;
+static const size_t INFO_SIZE = 24;
+static const size_t END_SIZE = 12;
+static const size_t DATA_PREFIX_SIZE = 4;
+static const size_t COUNTS_RECORD_SIZE = 16;
+static const size_t SI_RECORD_SIZE = 28;
+
+// HEADER payload
+struct Info {
+    uint8_t format;
+    uint8_t ranges;
+    uint16_t recordSize;
+    uint32_t sampleCount;
+    uint32_t rateMilliHz;
+    uint64_t startUs;
+    uint32_t dataFrames;
+};
+
+// A frame checked by parse(); payload points into the caller's buffer
+struct View {
+    uint8_t type;
+    uint32_t session;
+    uint16_t sequence;
+    const uint8_t* payload;
+    size_t length;
+};
+
+inline size_t recordSize(uint8_t format) {
+    return format == FORMAT_MPU_SI ? SI_RECORD_SIZE : COUNTS_RECORD_SIZE;
+}
+
+inline size_t recordsPerFrame(uint8_t format) {
+    return (MAX_PAYLOAD - DATA_PREFIX_SIZE) / recordSize(format);
+}
+
+// Fills in the prefix and CRC around length payload bytes already at frame + PREFIX_SIZE;
+// returns the frame size
+inline size_t seal(uint8_t* frame, uint8_t type, uint32_t session, uint16_t sequence, size_t length) {
+    uint16_t length16 = (uint16_t)length;
+    frame[0] = SYNC0;
+    frame[1] = SYNC1;
+    frame[2] = type;
+    frame[3] = VERSION;
+    memcpy(frame + 4, &session, 4);
+    memcpy(frame + 8, &sequence, 2);
+    memcpy(frame + 10, &length16, 2);
+    uint32_t crc = crc32(frame, PREFIX_SIZE + length);
+    memcpy(frame + PREFIX_SIZE + length, &crc, CRC_SIZE);
+    return PREFIX_SIZE + length + CRC_SIZE;
+}
+
+inline void encodeInfo(uint8_t out[INFO_SIZE], const Info& info) {
+    out[0] = info.format;
+    out[1] = info.ranges;
+    memcpy(out + 2, &info.recordSize, 2);
+    memcpy(out + 4, &info.sampleCount, 4);
+    memcpy(out + 8, &info.rateMilliHz, 4);
+    memcpy(out + 12, &info.startUs, 8);
+    memcpy(out + 20, &info.dataFrames, 4);
+}
+
+inline bool decodeInfo(const uint8_t* payload, size_t length, Info& info) {
+    if (length < INFO_SIZE) {
+        return false;
+    }
+    info.format = payload[0];
+    info.ranges = payload[1];
+    memcpy(&info.recordSize, payload + 2, 2);
+    memcpy(&info.sampleCount, payload + 4, 4);
+    memcpy(&info.rateMilliHz, payload + 8, 4);
+    memcpy(&info.startUs, payload + 12, 8);
+    memcpy(&info.dataFrames, payload + 20, 4);
+    return true;
+}
+
+inline void encodeCounts(uint8_t out[COUNTS_RECORD_SIZE], uint32_t timeUs, const MpuRawCounts& counts) {
+    memcpy(out, &timeUs, 4);
+    memcpy(out + 4, &counts, MpuSample::COUNTS_SIZE);
+}
+
+inline void encodeSI(uint8_t out[SI_RECORD_SIZE], uint32_t timeUs, const MpuRawCounts& counts, uint8_t ranges) {
+    float values[6];
+    MpuSample::toSI(counts, ranges, values[0], values[1], values[2], values[3], values[4], values[5]);
+    memcpy(out, &timeUs, 4);
+    memcpy(out + 4, values, sizeof(values));
+}
+
+// Receiver side, for the frame starting at data[0]: its size once complete and intact, 0 if
+// more bytes are needed, -1 if there is no valid frame here (skip a byte and try again)
+inline int parse(const uint8_t* data, size_t len, View& view) {
+    if (len >= 1 && data[0] != SYNC0) {
+        return -1;
+    }
+    if (len >= 2 && data[1] != SYNC1) {
+        return -1;
+    }
+    if (len < PREFIX_SIZE) {
+        return 0;
+    }
+
+    uint16_t length;
+    memcpy(&length, data + 10, 2);
+    if (data[3] != VERSION || length > MAX_PAYLOAD) {
+        return -1;
+    }
+    if (len < PREFIX_SIZE + length + CRC_SIZE) {
+        return 0;
+    }
+
+    uint32_t crc;
+    memcpy(&crc, data + PREFIX_SIZE + length, CRC_SIZE);
+    if (crc != crc32(data, PREFIX_SIZE + length)) {
+        return -1;
+    }
+
+    view.type = data[2];
+    memcpy(&view.session, data + 4, 4);
+    memcpy(&view.sequence, data + 8, 2);
+    view.payload = data + PREFIX_SIZE;
+    view.length = length;
+    return (int)(PREFIX_SIZE + length + CRC_SIZE);
+}
+
+} // namespace ExportFrame
+
+#endif // EXPORT_FRAME_H
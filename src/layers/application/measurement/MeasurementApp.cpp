@@ -1,13 +1,27 @@
 #include "MeasurementApp.h"
 #include <Arduino.h>
+#include <esp_timer.h>
 
 MeasurementApp::MeasurementApp()
     : initialized_(false),
       recording_(false),
+      active_(false),
+      requests_(0),
+      startUs_(0),
+      stopUs_(0),
+      ring_(MpuSample::RAW_SIZE, RING_CAPACITY, true),
+      reportedDrops_(0),
+      firstSampleUs_(0),
+      recordedRanges_(0),
+      transmitSI_(false),
+      transmitBinary_(false),
+      sessionId_(0),
+      frameOutput_(nullptr),
       recordingStartTime_(0),
       sampleCount_(0) {
     Serial.println("[MeasurementApp] Created");
-    recordedData_.reserve(MAX_SAMPLES * VALUES_PER_SAMPLE);
+    recordedData_.reserve(MAX_SAMPLES);
+    recordedTimesUs_.reserve(MAX_SAMPLES);
 }
 
 MeasurementApp::~MeasurementApp() {
@@ -16,7 +30,7 @@ MeasurementApp::~MeasurementApp() {
         networkLayer_->unsubscribe("bluetooth/connected", "MeasurementApp");
         networkLayer_->unsubscribe("bluetooth/disconnected", "MeasurementApp");
         networkLayer_->unsubscribe("bluetooth/command", "MeasurementApp");
-        networkLayer_->unsubscribe("mpu/data", "MeasurementApp");
+        networkLayer_->unsubscribe("mpu/calibration", "MeasurementApp");
         Serial.println("[MeasurementApp] Cleaned up");
     }
 }
@@ -27,6 +41,11 @@ bool MeasurementApp::setup() {
         return false;
     }
 
+    if (!ring_.isValid()) {
+        Serial.println("[MeasurementApp] Failed to allocate sample ring");
+        return false;
+    }
+
     // Subscribe to Bluetooth connection events
     auto connectedCallback = [this](const uint8_t* data, size_t len, const std::string& topic) {
         this->onBluetoothConnected(data, len, topic);
@@ -40,8 +59,8 @@ bool MeasurementApp::setup() {
         this->onBluetoothCommand(data, len, topic);
     };
 
-    auto mpuDataCallback = [this](const uint8_t* data, size_t len, const std::string& topic) {
-        this->onMpuData(data, len, topic);
+    auto calibrationCallback = [this](const uint8_t* data, size_t len, const std::string& topic) {
+        this->onMpuCalibration(data, len, topic);
     };
 
     if (!networkLayer_->subscribe("bluetooth/connected", "MeasurementApp", connectedCallback)) {
@@ -59,8 +78,8 @@ bool MeasurementApp::setup() {
         return false;
     }
 
-    if (!networkLayer_->subscribe("mpu/data", "MeasurementApp", mpuDataCallback)) {
-        Serial.println("[MeasurementApp] Failed to subscribe to mpu/data");
+    if (!networkLayer_->subscribe("mpu/calibration", "MeasurementApp", calibrationCallback)) {
+        Serial.println("[MeasurementApp] Failed to subscribe to mpu/calibration");
         return false;
     }
 
@@ -74,6 +93,21 @@ void MeasurementApp::update() {
         return;
     }
 
+    uint32_t requests = requests_.exchange(0, std::memory_order_acquire);
+
+    // Everything before a START belongs to the previous recording, or to none
+    processRequests(requests & (REQUEST_CLEAR | REQUEST_ABORT | REQUEST_START));
+    drainRing();
+    processRequests(requests & (REQUEST_STOP | REQUEST_TRANSMIT));
+
+    uint32_t dropped = ring_.dropped();
+    if (dropped != reportedDrops_) {
+        if (active_) {
+            Serial.printf("[MeasurementApp] WARNING: %u samples lost (sample ring full)\n", dropped - reportedDrops_);
+        }
+        reportedDrops_ = dropped;
+    }
+
     // Log status periodically
     logRecordingStatus();
 }
@@ -83,14 +117,14 @@ bool MeasurementApp::isRecording() const {
 }
 
 size_t MeasurementApp::getRecordedSamplesCount() const {
-    return sampleCount_;
+    return sampleCount_.load();
 }
 
 void MeasurementApp::onBluetoothConnected(const uint8_t* data, size_t len, const std::string& topic) {
     Serial.println("[MeasurementApp] Bluetooth connected - Ready for commands");
     
     // Clear any previous recording data on new connection
-    clearRecordedData();
+    requests_.fetch_or(REQUEST_CLEAR, std::memory_order_release);
 }
 
 void MeasurementApp::onBluetoothDisconnected(const uint8_t* data, size_t len, const std::string& topic) {
@@ -100,6 +134,7 @@ void MeasurementApp::onBluetoothDisconnected(const uint8_t* data, size_t len, co
     if (recording_) {
         Serial.println("[MeasurementApp] Disabling recording due to disconnection");
         recording_ = false;
+        requests_.fetch_or(REQUEST_ABORT, std::memory_order_release);
     }
 }
 
@@ -138,53 +173,85 @@ void MeasurementApp::onBluetoothCommand(const uint8_t* data, size_t len, const s
         handleStopCommand();
     } else if (command == "DATA") {
         handleDataCommand();
+    } else if (command.startsWith("FORMAT ")) {
+        handleFormatCommand(command.substring(7));
+    } else if (command == "CALIBRATE" || command.startsWith("CALIBRATE ")) {
+        handleCalibrateCommand(command.substring(9));
     } else {
         Serial.printf("[MeasurementApp] Unknown command: '%s'\n", command.c_str());
     }
 }
 
-void MeasurementApp::onMpuData(const uint8_t* data, size_t len, const std::string& topic) {
-    // Fast path: return immediately if not recording
-    if (!recording_) {
+void MeasurementApp::processRequests(uint32_t requests) {
+    if (requests & (REQUEST_CLEAR | REQUEST_START)) {
+        clearRecordedData();
+    }
+    if (requests & REQUEST_ABORT) {
+        active_ = false;
+    }
+    if (requests & REQUEST_START) {
+        active_ = true;
+    }
+    if (requests & REQUEST_STOP) {
+        active_ = false;
+        unsigned long recordingDuration = millis() - recordingStartTime_;
+        Serial.printf("[MeasurementApp] Recording stopped. Duration: %lu ms, Samples: %u\n",
+                     recordingDuration, (unsigned)sampleCount_.load());
+    }
+    if (requests & (REQUEST_STOP | REQUEST_TRANSMIT)) {
+        transmitRecordedData();
+    }
+}
+
+void MeasurementApp::drainRing() {
+    uint8_t batch[DRAIN_BATCH * MpuSample::RAW_SIZE];
+    size_t n;
+    do {
+        n = ring_.pop(batch, DRAIN_BATCH);
+        if (!active_) {
+            continue; // Keep the ring empty while idle
+        }
+        for (size_t i = 0; i < n && active_; i++) {
+            recordSample(batch + i * MpuSample::RAW_SIZE);
+        }
+    } while (n == DRAIN_BATCH);
+}
+
+void MeasurementApp::recordSample(const uint8_t* record) {
+    // Keep the counts as they are; conversion happens at transmit time or on the host
+    uint64_t timestampUs;
+    uint8_t ranges;
+    MpuRawCounts counts;
+    if (!MpuSample::decode(record, MpuSample::RAW_SIZE, timestampUs, ranges, counts)) {
         return;
     }
 
-    // Ultra-fast data storage when recording - no validation for maximum speed
-    // MPU data format: timestamp(4) + ax(4) + ay(4) + az(4) + gx(4) + gy(4) + gz(4) = 28 bytes
+    // Samples queued before START, or taken after STOP, aren't part of this recording
+    if (timestampUs < startUs_ || (!recording_ && timestampUs > stopUs_)) {
+        return;
+    }
 
-    // Check buffer limits (fast check)
-    if (sampleCount_ >= MAX_SAMPLES) {
-        // Signal to stop recording due to buffer full
+    // Check buffer limits
+    size_t count = sampleCount_.load(std::memory_order_relaxed);
+    if (count >= MAX_SAMPLES) {
+        active_ = false;
         recording_ = false;
         Serial.println("[MeasurementApp] Buffer full, stopping recording");
         return;
     }
 
-    // Direct memory copy for maximum speed - skip timestamp, store only sensor values
-    // Skip first 4 bytes (timestamp), copy 24 bytes of sensor data (6 floats)
-    const size_t sensorDataOffset = 4;
-    const size_t sensorDataSize = 24; // 6 floats * 4 bytes each
-
-    if (len >= sensorDataOffset + sensorDataSize) {
-        // Store sensor values directly (ax, ay, az, gx, gy, gz)
-        const float* sensorValues = reinterpret_cast<const float*>(data + sensorDataOffset);
-
-        // Use push_back for safety instead of direct indexing
-        recordedData_.push_back(sensorValues[0]); // ax
-        recordedData_.push_back(sensorValues[1]); // ay
-        recordedData_.push_back(sensorValues[2]); // az
-        recordedData_.push_back(sensorValues[3]); // gx
-        recordedData_.push_back(sensorValues[4]); // gy
-        recordedData_.push_back(sensorValues[5]); // gz
-
-        sampleCount_++;
-
-        // Debug: Log every 50 samples
-        if (sampleCount_ % 50 == 0) {
-            Serial.printf("[MeasurementApp] Recorded %d samples so far\n", sampleCount_);
-        }
-    } else {
-        Serial.printf("[MeasurementApp] Invalid MPU data size: %d bytes\n", len);
+    if (count == 0) {
+        recordedRanges_ = ranges;
+        firstSampleUs_ = timestampUs;
+    }
+    // Reserved up front, so push_back never reallocates under a reader of earlier entries
+    recordedData_.push_back(counts);
+    recordedTimesUs_.push_back((uint32_t)(timestampUs - firstSampleUs_));
+    sampleCount_.store(count + 1, std::memory_order_release);
+
+    // Debug: Log every 50 samples
+    if ((count + 1) % 50 == 0) {
+        Serial.printf("[MeasurementApp] Recorded %u samples so far\n", (unsigned)(count + 1));
     }
 }
 
@@ -196,12 +263,12 @@ void MeasurementApp::handleStartCommand() {
 
     Serial.println("[MeasurementApp] Starting recording");
     
-    // Clear previous data
-    clearRecordedData();
-    
-    // Enable recording mode - MPU is already capturing at maximum speed
-    recording_ = true;
+    // Enable recording mode - MPU is already capturing at maximum speed; the app task clears
+    // the previous data and records from samples taken after this point
+    startUs_ = esp_timer_get_time();
     recordingStartTime_ = millis();
+    recording_ = true;
+    requests_.fetch_or(REQUEST_START, std::memory_order_release);
 
     // Notify via Bluetooth
     String response = "RECORDING_STARTED";
@@ -210,7 +277,80 @@ void MeasurementApp::handleStartCommand() {
 
 void MeasurementApp::handleDataCommand() {
     Serial.println("[MeasurementApp] DATA command received - transmitting recorded data");
-    transmitRecordedData();
+    requests_.fetch_or(REQUEST_TRANSMIT, std::memory_order_release);
+}
+
+void MeasurementApp::handleFormatCommand(const String& format) {
+    // Units and encoding are set independently
+    if (format == "RAW") {
+        transmitSI_ = false;
+    } else if (format == "SI") {
+        transmitSI_ = true;
+    } else if (format == "CSV") {
+        transmitBinary_ = false;
+    } else if (format == "BIN") {
+        if (frameOutput_ == nullptr) {
+            String response = "FORMAT:ERR no binary output\n";
+            networkLayer_->publish("bluetooth/transmit", (const uint8_t*)response.c_str(), response.length());
+            return;
+        }
+        transmitBinary_ = true;
+    } else {
+        Serial.printf("[MeasurementApp] Unknown format: '%s'\n", format.c_str());
+        return;
+    }
+
+    String response = String("FORMAT:") + format + "\n";
+    networkLayer_->publish("bluetooth/transmit", (const uint8_t*)response.c_str(), response.length());
+}
+
+void MeasurementApp::handleCalibrateCommand(const String& argument) {
+    String value = argument;
+    value.trim();
+
+    // Duration in ms for the MPU, 0 clears the stored profile
+    uint32_t durationMs = DEFAULT_CALIBRATION_MS;
+    if (value == "CLEAR") {
+        durationMs = 0;
+    } else if (value.length() > 0) {
+        long seconds = value.toInt();
+        if (seconds <= 0) {
+            Serial.printf("[MeasurementApp] Invalid calibration time: '%s'\n", value.c_str());
+            return;
+        }
+        durationMs = (uint32_t)seconds * 1000;
+    }
+
+    if (durationMs > 0) {
+        String response = "CALIBRATING: keep the sensor still\n";
+        networkLayer_->publish("bluetooth/transmit", (const uint8_t*)response.c_str(), response.length());
+    }
+    networkLayer_->publish("mpu/calibrate", (const uint8_t*)&durationMs, sizeof(durationMs));
+}
+
+void MeasurementApp::onMpuCalibration(const uint8_t* data, size_t len, const std::string& topic) {
+    MpuCalibration::Profile profile;
+    if (len < 1 + sizeof(profile)) {
+        return;
+    }
+    memcpy(&profile, data + 1, sizeof(profile));
+
+    static const char* const STATUS_NAMES[] = {"OK", "MOVING", "NOT_CAPTURING", "CLEARED", "BUSY"};
+    uint8_t status = data[0];
+    const char* name = status < sizeof(STATUS_NAMES) / sizeof(STATUS_NAMES[0]) ? STATUS_NAMES[status] : "ERROR";
+
+    // Counts at the recorded ranges; scales are Q14 (16384 = 1.0)
+    char response[160];
+    if (status == MpuCalibration::STATUS_OK) {
+        snprintf(response, sizeof(response),
+                 "CALIBRATION:OK accel_bias=%d,%d,%d accel_scale=%d,%d,%d gyro_bias=%d,%d,%d\n",
+                 profile.accelBias[0], profile.accelBias[1], profile.accelBias[2], profile.accelScale[0],
+                 profile.accelScale[1], profile.accelScale[2], profile.gyroBias[0], profile.gyroBias[1],
+                 profile.gyroBias[2]);
+    } else {
+        snprintf(response, sizeof(response), "CALIBRATION:%s\n", name);
+    }
+    networkLayer_->publish("bluetooth/transmit", (const uint8_t*)response, strlen(response));
 }
 
 void MeasurementApp::handleStopCommand() {
@@ -220,66 +360,175 @@ void MeasurementApp::handleStopCommand() {
     }
 
     Serial.println("[MeasurementApp] Stopping recording");
+    stopUs_ = esp_timer_get_time();
     recording_ = false;
 
-    unsigned long recordingDuration = millis() - recordingStartTime_;
-    Serial.printf("[MeasurementApp] Recording stopped. Duration: %lu ms, Samples: %d\n",
-                 recordingDuration, sampleCount_);
-
-    // Transmit recorded data
-    transmitRecordedData();
+    // The app task records what is still queued up to now, then transmits
+    requests_.fetch_or(REQUEST_STOP, std::memory_order_release);
 }
 
 void MeasurementApp::transmitRecordedData() {
-    if (sampleCount_ == 0) {
+    size_t sampleCount = sampleCount_.load();
+    bool transmitSI = transmitSI_.load();
+    if (sampleCount == 0) {
         Serial.println("[MeasurementApp] No data to transmit");
         String noDataMsg = "NO_DATA\n";
         networkLayer_->publish("bluetooth/transmit", (const uint8_t*)noDataMsg.c_str(), noDataMsg.length());
         return;
     }
 
-    Serial.printf("[MeasurementApp] Transmitting %d samples as CSV (%d floats)\n", sampleCount_, recordedData_.size());
+    if (transmitBinary_) {
+        transmitFrames(sampleCount, transmitSI);
+    } else {
+        transmitCsv(sampleCount, transmitSI);
+    }
+}
 
-    // Send header with sample count and CSV format info
-    String header = "DATA_START:" + String(sampleCount_) + "\n";
-    header += "Format: ax,ay,az,gx,gy,gz\n";
+void MeasurementApp::transmitCsv(size_t sampleCount, bool transmitSI) {
+    Serial.printf("[MeasurementApp] Transmitting %u samples as CSV (%s)\n", (unsigned)sampleCount, transmitSI ? "SI" : "raw counts");
+
+    // Send header with sample count and CSV format info; raw counts carry their scale so the
+    // host can convert them (value / lsb_per_unit). t_us counts from the first sample, taken at
+    // Start_us on the device's esp_timer clock.
+    String header = "DATA_START:" + String(sampleCount) + "\n";
+    char start[48];
+    snprintf(start, sizeof(start), "Start_us: %llu\n", (unsigned long long)firstSampleUs_);
+    header += start;
+    header += "Format: t_us,ax,ay,az,gx,gy,gz\n";
+    if (!transmitSI) {
+        char scale[96];
+        snprintf(scale, sizeof(scale), "Scale: accel_lsb_per_g=%.1f,gyro_lsb_per_dps=%.2f\n",
+                 MpuSample::accelLsbPerG(recordedRanges_), MpuSample::gyroLsbPerDps(recordedRanges_));
+        header += scale;
+    }
     networkLayer_->publish("bluetooth/transmit", (const uint8_t*)header.c_str(), header.length());
 
-    // Send data as CSV lines (6 floats per sample)
-    const size_t floatsPerSample = 6;
+    // Send data as CSV lines (time + 6 values per sample)
     char csvLine[128]; // Buffer for one CSV line
-    
-    for (size_t sample = 0; sample < sampleCount_; sample++) {
-        size_t baseIndex = sample * floatsPerSample;
-        
-        // Format: ax,ay,az,gx,gy,gz
-        snprintf(csvLine, sizeof(csvLine), "%.6f,%.6f,%.6f,%.6f,%.6f,%.6f\n",
-                recordedData_[baseIndex],     // ax
-                recordedData_[baseIndex + 1], // ay
-                recordedData_[baseIndex + 2], // az
-                recordedData_[baseIndex + 3], // gx
-                recordedData_[baseIndex + 4], // gy
-                recordedData_[baseIndex + 5]); // gz
-        
+
+    for (size_t sample = 0; sample < sampleCount; sample++) {
+        // Format: t_us,ax,ay,az,gx,gy,gz
+        int n = snprintf(csvLine, sizeof(csvLine), "%lu,", (unsigned long)recordedTimesUs_[sample]);
+        n += MpuSample::formatCsv(recordedData_[sample], recordedRanges_, transmitSI, csvLine + n,
+                                  sizeof(csvLine) - 1 - n);
+        csvLine[n++] = '\n';
+
         // Send the CSV line
-        networkLayer_->publish("bluetooth/transmit", 
-                              (const uint8_t*)csvLine, 
-                              strlen(csvLine));
-        
+        networkLayer_->publish("bluetooth/transmit", (const uint8_t*)csvLine, n);
+
         // Small delay between lines to prevent Bluetooth buffer overflow
-        delay(5);
+        delay(CSV_LINE_DELAY_MS);
     }
 
     // Send end marker
     String endMarker = "DATA_END\n";
     networkLayer_->publish("bluetooth/transmit", (const uint8_t*)endMarker.c_str(), endMarker.length());
 
-    Serial.printf("[MeasurementApp] CSV data transmission complete (%d samples sent)\n", sampleCount_);
+    Serial.printf("[MeasurementApp] CSV data transmission complete (%u samples sent)\n", (unsigned)sampleCount);
+}
+
+void MeasurementApp::transmitFrames(size_t sampleCount, bool transmitSI) {
+    // One id per recording, counted in the DataLayer so it also differs across reboots
+    if (sessionId_ == 0) {
+        int64_t session = 0;
+        if (!dataLayer_->incrBy("measurement/session", 1, session) || (uint32_t)session == 0) {
+            session = (int64_t)(esp_timer_get_time() | 1);
+        }
+        sessionId_ = (uint32_t)session;
+    }
+
+    ExportFrame::Info info;
+    info.format = transmitSI ? ExportFrame::FORMAT_MPU_SI : ExportFrame::FORMAT_MPU_COUNTS;
+    info.ranges = recordedRanges_;
+    info.recordSize = (uint16_t)ExportFrame::recordSize(info.format);
+    info.sampleCount = (uint32_t)sampleCount;
+    uint32_t spanUs = recordedTimesUs_[sampleCount - 1];
+    info.rateMilliHz = spanUs > 0 ? (uint32_t)((uint64_t)(sampleCount - 1) * 1000000000ull / spanUs) : 0;
+    info.startUs = firstSampleUs_;
+    size_t perFrame = ExportFrame::recordsPerFrame(info.format);
+    info.dataFrames = (uint32_t)((sampleCount + perFrame - 1) / perFrame);
+
+    Serial.printf("[MeasurementApp] Transmitting %u samples as %u frames, session %u (%s)\n", (unsigned)sampleCount,
+                  (unsigned)info.dataFrames + 2, (unsigned)sessionId_, transmitSI ? "SI" : "raw counts");
+
+    // Frames are built in place behind the length the frame output expects
+    uint8_t slot[FRAME_SLOT_SIZE];
+    uint8_t* payload = slot + 2 + ExportFrame::PREFIX_SIZE;
+    uint16_t sequence = 0;
+
+    ExportFrame::encodeInfo(payload, info);
+    if (!sendFrame(slot, ExportFrame::TYPE_HEADER, sequence, ExportFrame::INFO_SIZE)) {
+        return;
+    }
+
+    // Records packed back to back after the index of the first one
+    uint32_t recordsCrc = 0;
+    for (size_t first = 0; first < sampleCount; first += perFrame) {
+        size_t count = sampleCount - first < perFrame ? sampleCount - first : perFrame;
+        uint32_t firstIndex = (uint32_t)first;
+        memcpy(payload, &firstIndex, 4);
+
+        uint8_t* record = payload + ExportFrame::DATA_PREFIX_SIZE;
+        for (size_t i = first; i < first + count; i++) {
+            if (transmitSI) {
+                ExportFrame::encodeSI(record, recordedTimesUs_[i], recordedData_[i], recordedRanges_);
+            } else {
+                ExportFrame::encodeCounts(record, recordedTimesUs_[i], recordedData_[i]);
+            }
+            record += info.recordSize;
+        }
+
+        size_t recordBytes = count * info.recordSize;
+        recordsCrc = crc32Update(recordsCrc, payload + ExportFrame::DATA_PREFIX_SIZE, recordBytes);
+        if (!sendFrame(slot, ExportFrame::TYPE_DATA, sequence, ExportFrame::DATA_PREFIX_SIZE + recordBytes)) {
+            return;
+        }
+    }
+
+    uint32_t total = (uint32_t)sampleCount;
+    memcpy(payload, &total, 4);
+    memcpy(payload + 4, &info.dataFrames, 4);
+    memcpy(payload + 8, &recordsCrc, 4);
+    if (!sendFrame(slot, ExportFrame::TYPE_END, sequence, ExportFrame::END_SIZE)) {
+        return;
+    }
+
+    Serial.printf("[MeasurementApp] Binary data transmission complete (%u samples sent)\n", (unsigned)sampleCount);
+}
+
+bool MeasurementApp::sendFrame(uint8_t* slot, uint8_t type, uint16_t& sequence, size_t payloadLength) {
+    uint16_t size = (uint16_t)ExportFrame::seal(slot + 2, type, sessionId_, sequence++, payloadLength);
+    memcpy(slot, &size, sizeof(size));
+
+    // Wait for room instead of dropping: the output drains as fast as the link takes the frames.
+    // Only the consumer frees slots, so the check holds until the push
+    uint32_t waitedMs = 0;
+    while (frameOutput_->count() >= frameOutput_->capacity()) {
+        if (waitedMs >= FRAME_TIMEOUT_MS) {
+            Serial.printf("[MeasurementApp] Frame output stalled, transmission aborted at frame %u\n",
+                          (unsigned)(sequence - 1));
+            return false;
+        }
+        delay(FRAME_WAIT_MS);
+        waitedMs += FRAME_WAIT_MS;
+    }
+    return frameOutput_->push(slot);
+}
+
+bool MeasurementApp::setFrameOutput(SampleRing* ring) {
+    if (ring == nullptr || !ring->isValid() || ring->recordSize() != FRAME_SLOT_SIZE) {
+        Serial.println("[MeasurementApp] Frame output rejected: needs a ring of length-prefixed frames");
+        return false;
+    }
+    frameOutput_ = ring;
+    return true;
 }
 
 void MeasurementApp::clearRecordedData() {
     recordedData_.clear();
-    sampleCount_ = 0;
+    recordedTimesUs_.clear();
+    sampleCount_.store(0);
+    sessionId_ = 0;
     Serial.println("[MeasurementApp] Cleared recorded data");
 }
 
@@ -290,8 +539,8 @@ void MeasurementApp::logRecordingStatus() {
     // Log every 2 seconds when recording (main app runs at 10Hz)
     if (recording_ && (currentTime - lastLogTime >= 2000)) {
         unsigned long duration = currentTime - recordingStartTime_;
-        Serial.printf("[MeasurementApp] Recording... Duration: %lu ms, Samples: %d\n",
-                     duration, sampleCount_);
+        Serial.printf("[MeasurementApp] Recording... Duration: %lu ms, Samples: %u\n",
+                     duration, (unsigned)sampleCount_.load());
         lastLogTime = currentTime;
     }
 }
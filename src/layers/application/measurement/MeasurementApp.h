@@ -2,12 +2,30 @@
 #define MEASUREMENT_APP_H
 
 #include "../ApplicationInterface.h"
+#include "../mpu/MpuSample.h"
+#include "../mpu/MpuCalibration.h"
+#include "ExportFrame.h"
+#include "../../data/SampleRing.h"
 #include <Arduino.h>
+#include <atomic>
 #include <vector>
 
 // MeasurementApp
 // Coordinates MPU data collection triggered by Bluetooth commands
 // Stores MPU readings in memory on START, transmits compressed data on STOP
+// Samples are kept as raw int16 counts (12 bytes each) plus their sampling time as a 32-bit
+// microsecond offset from the first recorded sample (good for 71 minutes); the CSV carries
+// that offset as t_us and the header the absolute esp_timer time of the first sample.
+// FORMAT RAW|SI picks whether the records carry the counts (default, converted on the host) or
+// floats converted at transmit time, and FORMAT CSV|BIN how they are sent: CSV lines (default)
+// or CRC-checked binary frames of packed records (ExportFrame.h), which download the same
+// recording many times faster. CALIBRATE [seconds] asks the MPU to measure its bias from a
+// still period (CALIBRATE CLEAR drops the profile) and reports the outcome as a CALIBRATION line
+//
+// Samples arrive through sampleRing(), which main attaches to the MPU as a consumer, and only
+// the app task touches the recording: Bluetooth commands run on delivery tasks, so they just
+// post a request (with the esp_timer time they arrived) that update() carries out between
+// ring drains. Recording covers the samples taken between START and STOP.
 class MeasurementApp : public ApplicationInterface {
 public:
     MeasurementApp();
@@ -19,32 +37,76 @@ public:
     // State queries
     bool isRecording() const;
     size_t getRecordedSamplesCount() const;
+    size_t getSampleCapacity() const { return MAX_SAMPLES; }
+
+    // Ring to attach to the sample producer (MPU::attachConsumer)
+    SampleRing* sampleRing() { return &ring_; }
+
+    // Ordered output for binary frames (Bluetooth::streamRing()): records of a u16 length and
+    // up to ExportFrame::MAX_FRAME bytes. FORMAT BIN is refused until one is attached
+    bool setFrameOutput(SampleRing* ring);
 
 private:
+    // Commands handed from delivery tasks to update()
+    enum Request : uint32_t {
+        REQUEST_CLEAR = 1u << 0,    // Drop recorded data (new connection)
+        REQUEST_ABORT = 1u << 1,    // Stop recording without transmitting
+        REQUEST_START = 1u << 2,
+        REQUEST_STOP = 1u << 3,     // Stop recording and transmit
+        REQUEST_TRANSMIT = 1u << 4,
+    };
+
     // State
     bool initialized_;
-    bool recording_;
-    std::vector<float> recordedData_; // Stores [ax, ay, az, gx, gy, gz, ax, ay, ...]
+    std::atomic<bool> recording_;            // As reported to others; set by commands
+    bool active_;                            // Ring samples are being recorded; app task only
+    std::atomic<uint32_t> requests_;
+    uint64_t startUs_;                       // Written before REQUEST_START/STOP are posted
+    uint64_t stopUs_;
+    SampleRing ring_;
+    uint32_t reportedDrops_;
+    std::vector<MpuRawCounts> recordedData_; // One entry per sample, in arrival order
+    std::vector<uint32_t> recordedTimesUs_;  // Sample time minus firstSampleUs_, per entry
+    uint64_t firstSampleUs_;
+    uint8_t recordedRanges_;                 // Ranges of the recorded counts (MpuSample::packRanges)
+    std::atomic<bool> transmitSI_;
+    std::atomic<bool> transmitBinary_;
+    uint32_t sessionId_;                     // Binary export id of the recording, 0 until first sent
+    SampleRing* frameOutput_;                // This task is its only producer
     unsigned long recordingStartTime_;
-    size_t sampleCount_;
+    std::atomic<size_t> sampleCount_;
 
     // Configuration
-    static const size_t MAX_SAMPLES = 1000; // Max samples to store (prevents overflow)
-    static const size_t VALUES_PER_SAMPLE = 6; // ax, ay, az, gx, gy, gz
+    static const size_t MAX_SAMPLES = 2000;  // Max samples to store; 32 KB with timestamps
+    static const size_t RING_CAPACITY = 512; // 10 s at 50 Hz, 0.5 s at 1 kHz between drains; PSRAM
+    static const size_t DRAIN_BATCH = 32;
+    static const uint32_t DEFAULT_CALIBRATION_MS = 3000;
+    static const uint32_t CSV_LINE_DELAY_MS = 5;   // Keeps the Bluetooth buffer from overflowing
+    static const size_t FRAME_SLOT_SIZE = 2 + ExportFrame::MAX_FRAME;
+    static const uint32_t FRAME_WAIT_MS = 5;       // Poll interval while the frame output is full
+    static const uint32_t FRAME_TIMEOUT_MS = 2000; // Give up on a transfer the link doesn't take
 
     // Network callbacks
     void onBluetoothConnected(const uint8_t* data, size_t len, const std::string& topic);
     void onBluetoothDisconnected(const uint8_t* data, size_t len, const std::string& topic);
     void onBluetoothCommand(const uint8_t* data, size_t len, const std::string& topic);
-    void onMpuData(const uint8_t* data, size_t len, const std::string& topic);
+    void onMpuCalibration(const uint8_t* data, size_t len, const std::string& topic);
 
     // Command handlers
     void handleStartCommand();
     void handleStopCommand();
     void handleDataCommand();
+    void handleFormatCommand(const String& format);
+    void handleCalibrateCommand(const String& argument);
+    void processRequests(uint32_t requests);
+    void drainRing();
+    void recordSample(const uint8_t* record);
 
     // Data transmission
     void transmitRecordedData();
+    void transmitCsv(size_t sampleCount, bool transmitSI);
+    void transmitFrames(size_t sampleCount, bool transmitSI);
+    bool sendFrame(uint8_t* slot, uint8_t type, uint16_t& sequence, size_t payloadLength);
     void compressAndTransmit();
     void clearRecordedData();
 
@@ -0,0 +1,130 @@
+#include "ClockDriftEstimator.h"
+
+// Epoch minima needed before the period is measured; the window has to span several beats
+// between the drain and sample rates for the hull to reach undelayed points. With fewer, only
+// the offset is fitted against the current period
+static const size_t MIN_POINTS_FOR_PERIOD = 16;
+// Fitted periods further than this from nominal are rejected (datasheet tolerance is 1%)
+static const double MAX_PERIOD_ERROR = 0.05;
+
+ClockDriftEstimator::ClockDriftEstimator()
+    : nominalPeriodUs_(0),
+      periodUs_(0),
+      epochBestResidual_(0),
+      epochCount_(0),
+      pointCount_(0),
+      pointNext_(0),
+      fitted_(false),
+      refIndex_(0),
+      refTimeUs_(0) {
+    epochBest_.index = 0;
+    epochBest_.timeUs = 0;
+}
+
+void ClockDriftEstimator::reset(uint32_t nominalPeriodUs) {
+    if (nominalPeriodUs != nominalPeriodUs_) {
+        nominalPeriodUs_ = nominalPeriodUs;
+        periodUs_ = nominalPeriodUs;
+    }
+    epochCount_ = 0;
+    pointCount_ = 0;
+    pointNext_ = 0;
+    fitted_ = false;
+}
+
+void ClockDriftEstimator::addObservation(uint64_t index, int64_t observedUs) {
+    if (nominalPeriodUs_ == 0) {
+        return;
+    }
+
+    // Lateness relative to a line of the current period; any fixed origin works for comparing
+    double residual = (double)observedUs - periodUs_ * (double)index;
+    if (epochCount_ == 0 || residual < epochBestResidual_) {
+        epochBest_.index = index;
+        epochBest_.timeUs = observedUs;
+        epochBestResidual_ = residual;
+    }
+
+    if (++epochCount_ >= EPOCH_OBSERVATIONS) {
+        closeEpoch();
+    }
+}
+
+int64_t ClockDriftEstimator::timeOf(uint64_t index) const {
+    return refTimeUs_ + (int64_t)(periodUs_ * ((double)index - (double)refIndex_));
+}
+
+double ClockDriftEstimator::driftPpm() const {
+    if (nominalPeriodUs_ == 0) {
+        return 0;
+    }
+    return (periodUs_ / nominalPeriodUs_ - 1.0) * 1e6;
+}
+
+void ClockDriftEstimator::closeEpoch() {
+    points_[pointNext_] = epochBest_;
+    pointNext_ = (pointNext_ + 1) % EPOCH_COUNT;
+    if (pointCount_ < EPOCH_COUNT) {
+        pointCount_++;
+    }
+    epochCount_ = 0;
+    fit();
+}
+
+void ClockDriftEstimator::fit() {
+    // Chronological copy, relative to the oldest point so the doubles stay small
+    Point ordered[EPOCH_COUNT];
+    size_t oldest = (pointNext_ + EPOCH_COUNT - pointCount_) % EPOCH_COUNT;
+    for (size_t i = 0; i < pointCount_; i++) {
+        ordered[i] = points_[(oldest + i) % EPOCH_COUNT];
+    }
+
+    if (pointCount_ >= MIN_POINTS_FOR_PERIOD) {
+        // Lower convex hull: minima that still carry some lateness lie above it, so its edges
+        // follow the undelayed times. The edge spanning the middle of the window sets the slope.
+        size_t hull[EPOCH_COUNT];
+        size_t hullCount = 0;
+        for (size_t i = 0; i < pointCount_; i++) {
+            while (hullCount >= 2 && !turnsLeft(ordered[hull[hullCount - 2]], ordered[hull[hullCount - 1]], ordered[i])) {
+                hullCount--;
+            }
+            hull[hullCount++] = i;
+        }
+
+        uint64_t middle = ordered[0].index + (ordered[pointCount_ - 1].index - ordered[0].index) / 2;
+        size_t edge = 0;
+        while (edge + 2 < hullCount && ordered[hull[edge + 1]].index <= middle) {
+            edge++;
+        }
+        const Point& a = ordered[hull[edge]];
+        const Point& b = ordered[hull[edge + 1]];
+        if (b.index > a.index) {
+            double period = (double)(b.timeUs - a.timeUs) / (double)(b.index - a.index);
+            double error = period / nominalPeriodUs_ - 1.0;
+            if (error < MAX_PERIOD_ERROR && error > -MAX_PERIOD_ERROR) {
+                periodUs_ = period;
+            }
+        }
+    }
+
+    // Offset: the line of that period through the point that is earliest against it
+    size_t lowest = 0;
+    double lowestResidual = 0;
+    for (size_t i = 0; i < pointCount_; i++) {
+        double residual = (double)(ordered[i].timeUs - ordered[0].timeUs) -
+                          periodUs_ * (double)(ordered[i].index - ordered[0].index);
+        if (i == 0 || residual < lowestResidual) {
+            lowest = i;
+            lowestResidual = residual;
+        }
+    }
+    refIndex_ = ordered[lowest].index;
+    refTimeUs_ = ordered[lowest].timeUs;
+    fitted_ = true;
+}
+
+bool ClockDriftEstimator::turnsLeft(const Point& a, const Point& b, const Point& c) {
+    double abx = (double)(b.index - a.index), aby = (double)(b.timeUs - a.timeUs);
+    double acx = (double)(c.index - a.index), acy = (double)(c.timeUs - a.timeUs);
+    return abx * acy - aby * acx > 0;
+}
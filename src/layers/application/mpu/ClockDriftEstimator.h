@@ -0,0 +1,67 @@
+#ifndef CLOCK_DRIFT_ESTIMATOR_H
+#define CLOCK_DRIFT_ESTIMATOR_H
+
+#include <cstdint>
+#include <cstddef>
+
+// Maps sensor sample indices to CPU time (esp_timer microseconds) when the sensor runs on its
+// own clock, whose rate differs from nominal by up to +-1% and wanders with temperature.
+//
+// Each observation says "sample index n existed by CPU time t", e.g. the time a FIFO count
+// that included it was read. Such times are late by a variable amount (up to one period plus
+// bus latency) but never early, so the estimator keeps, per epoch of EPOCH_OBSERVATIONS, the
+// observation that lies lowest against the current line and takes the sample period from the
+// lower convex hull of the last EPOCH_COUNT epoch minima; the offset is the lower envelope of
+// those points. The window slides, so slow drift over a long session is followed, and the period
+// learned survives reset() (the sensor clock doesn't change when its FIFO is restarted).
+class ClockDriftEstimator {
+public:
+    static const size_t EPOCH_OBSERVATIONS = 8;
+    static const size_t EPOCH_COUNT = 32;
+
+    ClockDriftEstimator();
+
+    // Start a new index timeline; keeps the period estimate unless nominalPeriodUs changes it
+    void reset(uint32_t nominalPeriodUs);
+
+    // Sample index existed no later than observedUs
+    void addObservation(uint64_t index, int64_t observedUs);
+
+    // True once the first epoch has closed
+    bool isLocked() const { return fitted_; }
+
+    // Estimated CPU time of a sample; only meaningful once isLocked()
+    int64_t timeOf(uint64_t index) const;
+
+    // Measured sample period, and its deviation from nominal in parts per million
+    double periodUs() const { return periodUs_; }
+    double driftPpm() const;
+
+private:
+    struct Point {
+        uint64_t index;
+        int64_t timeUs;
+    };
+
+    uint32_t nominalPeriodUs_;
+    double periodUs_;
+
+    // Current epoch: lowest observation relative to the current period estimate
+    Point epochBest_;
+    double epochBestResidual_;
+    size_t epochCount_;
+
+    Point points_[EPOCH_COUNT];
+    size_t pointCount_;
+    size_t pointNext_;
+
+    bool fitted_;
+    uint64_t refIndex_;
+    int64_t refTimeUs_;
+
+    void closeEpoch();
+    void fit();
+    static bool turnsLeft(const Point& a, const Point& b, const Point& c);
+};
+
+#endif // CLOCK_DRIFT_ESTIMATOR_H
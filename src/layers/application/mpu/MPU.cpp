@@ -1,36 +1,178 @@
 #include "MPU.h"
 #include <Arduino.h>
+#include <esp_timer.h>
+#include <cstdio>
+#include "../../logging/Log.h"
+
+MPU::Sensor::Sensor(uint8_t index, uint8_t address, int8_t channel)
+    : index(index),
+      address(address),
+      channel(channel),
+      lastTimestampUs(0),
+      calibrationRequest(-1),
+      calibrationResult(-1),
+      historyStream(nullptr),
+      lastReadingSlot(nullptr),
+      consumerCount(0),
+      samples(0) {
+    // The first sensor keeps the single-sensor topic names
+    char name[8] = "mpu/";
+    if (index > 0) {
+        snprintf(name, sizeof(name), "mpu%u/", (unsigned)index);
+    }
+    prefix = name;
+    rawTopic = prefix + "raw";
+    rawSubscribed = false;
+    memset(&lastCounts, 0, sizeof(lastCounts));
+    memset(&calibrationProfile, 0, sizeof(calibrationProfile));
+    for (size_t i = 0; i < MAX_CONSUMERS; i++) {
+        consumers[i].store(nullptr);
+    }
+}
 
-MPU::MPU()
-    : initialized_(false),
+MPU::MPU(I2cBus* bus)
+    : bus_(bus),
+      sensorCount_(0),
+      fifoMode_(false),
+      fifoResetPending_(false),
+      acquisitionTask_(nullptr),
+      acquisitionStop_(false),
+      acquisitionRunning_(false),
+      initialized_(false),
       capturing_(false),
       lastReadingTime_(0),
-      last_ax_(0), last_ay_(0), last_az_(0), last_gx_(0), last_gy_(0), last_gz_(0) {
+      lastPollUs_(0),
+      pollIntervalUs_(0),
+      ranges_(0),
+      lastDriftLogMs_(0),
+      cycleCount_(0),
+      cycleTotalUs_(0),
+      cycleMaxUs_(0),
+      overflows_(0),
+      lastThroughputMs_(0) {
+    for (size_t i = 0; i < MAX_SENSORS; i++) {
+        sensors_[i] = nullptr;
+        cycleOrder_[i] = nullptr;
+    }
     Serial.println("[MPU] Created");
 }
 
 MPU::~MPU() {
+    if (acquisitionTask_ != nullptr) {
+        sensors_[0]->fifo.disableDataReadyInterrupt();
+        stopAcquisitionTask();
+    }
     if (initialized_) {
         // Unsubscribe from topics
         networkLayer_->unsubscribe("capture/start", "MPU");
         networkLayer_->unsubscribe("capture/stop", "MPU");
-        networkLayer_->unsubscribe("mpu/data_request", "MPU");
+        for (size_t i = 0; i < sensorCount_; i++) {
+            networkLayer_->unsubscribe(sensors_[i]->prefix + "data_request", "MPU");
+            networkLayer_->unsubscribe(sensors_[i]->prefix + "calibrate", "MPU");
+        }
         Serial.println("[MPU] Cleaned up");
     }
+    for (size_t i = 0; i < sensorCount_; i++) {
+        delete sensors_[i];
+    }
+}
+
+bool MPU::addSensor(uint8_t address, int8_t channel) {
+    if (initialized_ || sensorCount_ >= MAX_SENSORS) {
+        Serial.println("[MPU] Cannot add sensor");
+        return false;
+    }
+    if ((address != 0x68 && address != 0x69) || channel < I2cBus::NO_CHANNEL ||
+        channel >= (int8_t)I2cBus::MUX_CHANNELS) {
+        Serial.printf("[MPU] Invalid sensor 0x%02X on channel %d\n", address, channel);
+        return false;
+    }
+
+    // A sensor on the main bus answers whichever mux channel is open
+    for (size_t i = 0; i < sensorCount_; i++) {
+        if (sensors_[i]->address == address &&
+            (sensors_[i]->channel == channel || sensors_[i]->channel == I2cBus::NO_CHANNEL ||
+             channel == I2cBus::NO_CHANNEL)) {
+            Serial.printf("[MPU] Address 0x%02X on channel %d clashes with sensor %u\n", address, channel,
+                          (unsigned)sensors_[i]->index);
+            return false;
+        }
+    }
+
+    uint8_t index = sensorCount_ > 0 ? sensors_[sensorCount_ - 1]->index + 1 : 0;
+    sensors_[sensorCount_++] = new Sensor(index, address, channel);
+    return true;
 }
 
 bool MPU::setup() {
-    if (!networkLayer_ || !dataLayer_) {
+    if (!networkLayer_ || !dataLayer_ || !bus_ || !bus_->isRunning()) {
         Serial.println("[MPU] ERROR: Missing layer dependencies");
         return false;
     }
 
-    // Initialize MPU hardware
-    if (!initMPU()) {
-        Serial.println("[MPU] Failed to initialize MPU6050 sensor");
+    if (sensorCount_ == 0) {
+        addSensor(Mpu6050Fifo::DEFAULT_ADDRESS);
+    }
+
+    // Initialize MPU hardware; sensors that don't answer are left out, their namespaces unused
+    size_t found = 0;
+    for (size_t i = 0; i < sensorCount_; i++) {
+        if (initSensor(*sensors_[i])) {
+            sensors_[found++] = sensors_[i];
+        } else {
+            Serial.printf("[MPU] Failed to initialize MPU6050 sensor %u\n", (unsigned)sensors_[i]->index);
+            delete sensors_[i];
+        }
+    }
+    sensorCount_ = found;
+    if (sensorCount_ == 0) {
         return false;
     }
 
+    // One FIFO mode for all sensors, so a cycle is the same work for each of them
+    fifoMode_ = MPU_FIFO_RATE_HZ > 0;
+    for (size_t i = 0; i < sensorCount_ && fifoMode_; i++) {
+        // Keep the DLPF below Nyquist for the chosen rate (Adafruit band enums are DLPF_CFG values)
+        uint16_t rate = MPU_FIFO_RATE_HZ;
+        uint8_t dlpf = rate >= 400 ? MPU6050_BAND_184_HZ
+                     : rate >= 200 ? MPU6050_BAND_94_HZ
+                     : rate >= 100 ? MPU6050_BAND_44_HZ
+                     : rate >= 50  ? MPU6050_BAND_21_HZ
+                                   : MPU6050_BAND_10_HZ;
+        Sensor& sensor = *sensors_[i];
+        if (!sensor.fifo.begin(bus_, rate, (ranges_ >> 4) & 0x03, ranges_ & 0x03, dlpf, sensor.address,
+                               sensor.channel)) {
+            Serial.printf("[MPU] FIFO setup failed on sensor %u, falling back to polled reads\n",
+                          (unsigned)sensor.index);
+            fifoMode_ = false;
+        }
+    }
+    if (fifoMode_) {
+        Serial.printf("[MPU] %u MPU6050 initialized, FIFO sampling at %u Hz\n", (unsigned)sensorCount_,
+                      sensors_[0]->fifo.rateHz());
+    } else {
+        Serial.printf("[MPU] %u MPU6050 initialized for stable Bluetooth operation (50Hz)\n",
+                      (unsigned)sensorCount_);
+    }
+
+    // Cycle order: main bus first, then one mux selection per channel
+    for (size_t i = 0; i < sensorCount_; i++) {
+        size_t j = i;
+        while (j > 0 && cycleOrder_[j - 1]->channel > sensors_[i]->channel) {
+            cycleOrder_[j] = cycleOrder_[j - 1];
+            j--;
+        }
+        cycleOrder_[j] = sensors_[i];
+    }
+
+    for (size_t i = 0; i < sensorCount_; i++) {
+        // Stored bias/scale correction, applied before anything is published
+        loadCalibration(*sensors_[i]);
+        if (!setupSensorTopics(*sensors_[i])) {
+            return false;
+        }
+    }
+
     // Subscribe to network topics
     auto startCallback = [this](const uint8_t* data, size_t len, const std::string& topic) {
         this->onStartCapture(data, len, topic);
@@ -40,10 +182,6 @@ bool MPU::setup() {
         this->onStopCapture(data, len, topic);
     };
 
-    auto dataRequestCallback = [this](const uint8_t* data, size_t len, const std::string& topic) {
-        this->onDataRequest(data, len, topic);
-    };
-
     if (!networkLayer_->subscribe("capture/start", "MPU", startCallback)) {
         Serial.println("[MPU] Failed to subscribe to capture/start");
         return false;
@@ -54,9 +192,8 @@ bool MPU::setup() {
         return false;
     }
 
-    if (!networkLayer_->subscribe("mpu/data_request", "MPU", dataRequestCallback)) {
-        Serial.println("[MPU] Failed to subscribe to mpu/data_request");
-        return false;
+    if (fifoMode_ && MPU_INT_PIN >= 0 && !startAcquisitionTask()) {
+        Serial.println("[MPU] WARNING: Data-ready interrupt unavailable, draining FIFO from the app task");
     }
 
     initialized_ = true;
@@ -64,18 +201,88 @@ bool MPU::setup() {
     return true;
 }
 
+bool MPU::setupSensorTopics(Sensor& sensor) {
+    // Sensor history other apps can query by time range (6 int16 counts per record, stamped with
+    // the sample's 64-bit esp_timer time in µs, the same clock as <prefix>raw)
+    sensor.historyStream = dataLayer_->createStream(sensor.prefix + "history", MpuSample::COUNTS_SIZE,
+                                                    HISTORY_CAPACITY, true);
+    if (!sensor.historyStream) {
+        Serial.printf("[MPU] WARNING: Failed to create %shistory stream\n", sensor.prefix.c_str());
+    }
+
+    // Latest reading, readable via getHotSlot() or get() without contending with the sampler
+    sensor.lastReadingSlot = dataLayer_->registerHotSlot(sensor.prefix + "last_reading", MpuSample::RAW_SIZE,
+                                                         LAST_READING_TTL_MS);
+    if (!sensor.lastReadingSlot) {
+        Serial.printf("[MPU] WARNING: Failed to register %slast_reading hot slot\n", sensor.prefix.c_str());
+    }
+
+    Sensor* target = &sensor;
+    auto dataRequestCallback = [this, target](const uint8_t* data, size_t len, const std::string& topic) {
+        this->onDataRequest(*target);
+    };
+
+    auto calibrateCallback = [this, target](const uint8_t* data, size_t len, const std::string& topic) {
+        this->onCalibrate(*target, data, len);
+    };
+
+    if (!networkLayer_->subscribe(sensor.prefix + "data_request", "MPU", dataRequestCallback)) {
+        Serial.printf("[MPU] Failed to subscribe to %sdata_request\n", sensor.prefix.c_str());
+        return false;
+    }
+
+    if (!networkLayer_->subscribe(sensor.prefix + "calibrate", "MPU", calibrateCallback)) {
+        Serial.printf("[MPU] Failed to subscribe to %scalibrate\n", sensor.prefix.c_str());
+        return false;
+    }
+    return true;
+}
+
 void MPU::update() {
     if (!initialized_) {
         return;
     }
 
+    // Store and report finished calibration runs; flash and broker work stay off the sampling task
+    for (size_t i = 0; i < sensorCount_; i++) {
+        Sensor& sensor = *sensors_[i];
+        int32_t result = sensor.calibrationResult.exchange(-1, std::memory_order_acquire);
+        if (result < 0) {
+            continue;
+        }
+        MpuCalibration::Status status = (MpuCalibration::Status)result;
+        if (status == MpuCalibration::STATUS_OK) {
+            dataLayer_->setValue("config/" + sensor.prefix + "calibration", sensor.calibrationProfile);
+        } else if (status == MpuCalibration::STATUS_CLEARED) {
+            dataLayer_->del("config/" + sensor.prefix + "calibration");
+        }
+        publishCalibration(sensor, status, sensor.calibrationProfile);
+    }
+
     // Read and publish data if capturing
-    if (capturing_) {
+    if (capturing_ && fifoMode_) {
+        if (acquisitionTask_ == nullptr) {
+            runCycle();
+        }
+    } else if (capturing_) {
         unsigned long currentTime = millis();
         if (currentTime - lastReadingTime_ >= READING_INTERVAL_MS) {
-            readAndPublishData();
+            // The task period sets the real rate; calibration sizes its runs from it
+            uint64_t nowUs = esp_timer_get_time();
+            if (lastPollUs_ != 0) {
+                uint32_t intervalUs = (uint32_t)(nowUs - lastPollUs_);
+                pollIntervalUs_ = pollIntervalUs_ == 0 ? intervalUs : (pollIntervalUs_ * 7 + intervalUs) / 8;
+            }
+            lastPollUs_ = nowUs;
+            runCycle();
             lastReadingTime_ = currentTime;
         }
+    } else {
+        lastPollUs_ = 0;
+    }
+
+    if (capturing_ && millis() - lastThroughputMs_ >= THROUGHPUT_INTERVAL_MS) {
+        publishThroughput();
     }
 }
 
@@ -85,8 +292,10 @@ void MPU::startCapture() {
         return;
     }
 
+    fifoResetPending_ = true; // Drop what queued up while idle
     capturing_ = true;
     lastReadingTime_ = millis();
+    lastThroughputMs_ = lastReadingTime_;
     Serial.println("[MPU] Capture started");
 
     // Publish capture started event
@@ -111,21 +320,51 @@ bool MPU::isCapturing() const {
     return capturing_;
 }
 
-bool MPU::getLastReading(float& ax, float& ay, float& az, float& gx, float& gy, float& gz) const {
-    if (!initialized_) {
+bool MPU::attachConsumer(SampleRing* ring, size_t sensorIndex) {
+    if (ring == nullptr || !ring->isValid() || ring->recordSize() != MpuSample::RAW_SIZE) {
+        Serial.println("[MPU] Invalid sample ring");
+        return false;
+    }
+
+    Sensor* sensor = nullptr;
+    for (size_t i = 0; i < sensorCount_; i++) {
+        if (sensors_[i]->index == sensorIndex) {
+            sensor = sensors_[i];
+        }
+    }
+    if (sensor == nullptr) {
+        Serial.printf("[MPU] No sensor %u to attach to\n", (unsigned)sensorIndex);
         return false;
     }
 
-    ax = last_ax_;
-    ay = last_ay_;
-    az = last_az_;
-    gx = last_gx_;
-    gy = last_gy_;
-    gz = last_gz_;
+    // Attached from setup code only; the sampling task sees the slot before the new count
+    size_t count = sensor->consumerCount.load();
+    if (count >= MAX_CONSUMERS) {
+        Serial.println("[MPU] No free consumer slot");
+        return false;
+    }
+    sensor->consumers[count].store(ring, std::memory_order_relaxed);
+    sensor->consumerCount.store(count + 1, std::memory_order_release);
 
+    Serial.printf("[MPU] Consumer ring attached to %s: %u samples\n", sensor->prefix.c_str(),
+                  (unsigned)ring->capacity());
     return true;
 }
 
+bool MPU::getLastReading(float& ax, float& ay, float& az, float& gx, float& gy, float& gz, size_t sensor) const {
+    if (!initialized_) {
+        return false;
+    }
+
+    for (size_t i = 0; i < sensorCount_; i++) {
+        if (sensors_[i]->index == sensor) {
+            MpuSample::toSI(sensors_[i]->lastCounts, ranges_, ax, ay, az, gx, gy, gz);
+            return true;
+        }
+    }
+    return false;
+}
+
 void MPU::onStartCapture(const uint8_t* data, size_t len, const std::string& topic) {
     Serial.println("[MPU] Received start capture command via network");
     startCapture();
@@ -136,89 +375,355 @@ void MPU::onStopCapture(const uint8_t* data, size_t len, const std::string& topi
     stopCapture();
 }
 
-void MPU::onDataRequest(const uint8_t* data, size_t len, const std::string& topic) {
-    Serial.println("[MPU] Data request received");
+void MPU::onDataRequest(Sensor& sensor) {
+    Serial.printf("[MPU] Data request received for %s\n", sensor.prefix.c_str());
 
-    // Send current sensor reading
-    float ax, ay, az, gx, gy, gz;
-    if (getLastReading(ax, ay, az, gx, gy, gz)) {
-        publishSensorData(ax, ay, az, gx, gy, gz);
+    // Send current sensor reading, with the time it was taken. Broker only: the consumer rings
+    // have the sampling task as their single producer
+    uint8_t raw[MpuSample::RAW_SIZE];
+    MpuSample::encode(raw, sensor.lastTimestampUs, ranges_, sensor.lastCounts);
+    networkLayer_->publish(sensor.rawTopic, raw, sizeof(raw));
+}
+
+void MPU::onCalibrate(Sensor& sensor, const uint8_t* data, size_t len) {
+    uint32_t durationMs = 0;
+    if (len >= sizeof(durationMs)) {
+        memcpy(&durationMs, data, sizeof(durationMs));
+    }
+    if (durationMs > MAX_CALIBRATION_MS) {
+        durationMs = MAX_CALIBRATION_MS;
+    }
+
+    if (durationMs > 0 && !capturing_) {
+        publishCalibration(sensor, MpuCalibration::STATUS_NOT_CAPTURING, sensor.calibration.profile());
+        return;
+    }
+    if (durationMs == 0 && !capturing_) {
+        // No sampling task to pick the request up; update() drops the stored profile and reports
+        sensor.calibration.reset(ranges_);
+        sensor.calibrationProfile = sensor.calibration.profile();
+        sensor.calibrationResult.store(MpuCalibration::STATUS_CLEARED, std::memory_order_release);
+        return;
+    }
+
+    // Picked up by the sampling task with the sensor's next batch
+    int32_t expected = -1;
+    if (!sensor.calibrationRequest.compare_exchange_strong(expected, (int32_t)durationMs)) {
+        publishCalibration(sensor, MpuCalibration::STATUS_BUSY, sensor.calibration.profile());
+        return;
+    }
+    Serial.printf("[MPU] Calibration of %s requested (%u ms)\n", sensor.prefix.c_str(), (unsigned)durationMs);
+}
+
+void MPU::collectCalibration(Sensor& sensor, const MpuRawCounts* samples, size_t count) {
+    int32_t request = sensor.calibrationRequest.exchange(-1, std::memory_order_acquire);
+    if (request == 0) {
+        sensor.calibration.reset(ranges_);
+        sensor.calibrationProfile = sensor.calibration.profile();
+        sensor.calibrationResult.store(MpuCalibration::STATUS_CLEARED, std::memory_order_release);
+    } else if (request > 0 && sensor.calibration.isCollecting()) {
+        LOG_WARN(MPU, "Sensor %u calibration already running, request ignored", sensor.index);
+    } else if (request > 0 && fifoMode_) {
+        sensor.calibration.begin((uint32_t)request * sensor.fifo.rateHz() / 1000);
+    } else if (request > 0) {
+        // One sample per polled cycle, at the measured period
+        uint32_t periodUs = pollIntervalUs_ > 0 ? pollIntervalUs_ : READING_INTERVAL_MS * 1000;
+        sensor.calibration.begin((uint32_t)((uint64_t)request * 1000 / periodUs));
+    }
+
+    if (sensor.calibration.isCollecting() && sensor.calibration.accumulate(samples, count)) {
+        MpuCalibration::Status status = sensor.calibration.finish();
+        sensor.calibrationProfile = sensor.calibration.profile();
+        sensor.calibrationResult.store(status, std::memory_order_release);
+    }
+}
+
+void MPU::publishCalibration(Sensor& sensor, MpuCalibration::Status status, const MpuCalibration::Profile& profile) {
+    uint8_t message[1 + sizeof(MpuCalibration::Profile)];
+    message[0] = status;
+    memcpy(message + 1, &profile, sizeof(profile));
+    networkLayer_->publish(sensor.prefix + "calibration", message, sizeof(message));
+
+    if (status == MpuCalibration::STATUS_OK) {
+        LOG_INFO(MPU, "Sensor %u calibrated: accel bias %d,%d,%d scale %d,%d,%d (Q14), gyro bias %d,%d,%d",
+                 sensor.index, profile.accelBias[0], profile.accelBias[1], profile.accelBias[2],
+                 profile.accelScale[0], profile.accelScale[1], profile.accelScale[2], profile.gyroBias[0],
+                 profile.gyroBias[1], profile.gyroBias[2]);
     } else {
-        Serial.println("[MPU] Failed to get sensor reading for data request");
+        LOG_WARN(MPU, "Sensor %u calibration: status %u", sensor.index, (unsigned)status);
     }
 }
 
-void MPU::readAndPublishData() {
+void MPU::loadCalibration(Sensor& sensor) {
+    sensor.calibration.reset(ranges_);
+
+    MpuCalibration::Profile stored;
+    if (!dataLayer_->getValue("config/" + sensor.prefix + "calibration", stored)) {
+        Serial.printf("[MPU] No stored calibration for %s, publishing uncorrected counts\n", sensor.prefix.c_str());
+        return;
+    }
+    if (!sensor.calibration.load(stored)) {
+        Serial.printf("[MPU] WARNING: Stored calibration for %s is for other ranges, ignoring it\n",
+                      sensor.prefix.c_str());
+        return;
+    }
+    Serial.printf("[MPU] Stored calibration for %s loaded\n", sensor.prefix.c_str());
+}
+
+void MPU::runCycle() {
+    uint64_t startUs = esp_timer_get_time();
+    bool resetFifos = fifoResetPending_.exchange(false);
+    uint32_t overflows = 0;
+
+    for (size_t i = 0; i < sensorCount_; i++) {
+        Sensor& sensor = *cycleOrder_[i];
+        // One subscriber lookup per cycle instead of a broker copy and task per sample for nobody;
+        // a traffic recorder counts as a listener so captures keep the raw stream
+        sensor.rawSubscribed = networkLayer_->hasSubscribers(sensor.rawTopic) || networkLayer_->hasTap();
+        if (!fifoMode_) {
+            readAndPublishData(sensor);
+            continue;
+        }
+        if (resetFifos) {
+            sensor.fifo.resetFifo();
+        }
+        drainFifo(sensor);
+        overflows += sensor.fifo.overflowCount();
+    }
+
+    // Single writer; update() only reads and resets these
+    uint32_t elapsedUs = (uint32_t)(esp_timer_get_time() - startUs);
+    cycleCount_.fetch_add(1, std::memory_order_relaxed);
+    cycleTotalUs_.fetch_add(elapsedUs, std::memory_order_relaxed);
+    if (elapsedUs > cycleMaxUs_.load(std::memory_order_relaxed)) {
+        cycleMaxUs_.store(elapsedUs, std::memory_order_relaxed);
+    }
+    overflows_.store(overflows, std::memory_order_relaxed);
+
+    uint32_t now = millis();
+    if (fifoMode_ && now - lastDriftLogMs_ >= DRIFT_LOG_INTERVAL_MS) {
+        for (size_t i = 0; i < sensorCount_; i++) {
+            LOG_INFO(MPU, "Sensor %u clock %+.0f ppm vs CPU, %u FIFO overflows", sensors_[i]->index,
+                     sensors_[i]->fifo.clockDriftPpm(), sensors_[i]->fifo.overflowCount());
+        }
+        lastDriftLogMs_ = now;
+    }
+}
+
+void MPU::readAndPublishData(Sensor& sensor) {
     float ax, ay, az, gx, gy, gz;
 
-    if (readMPUData(ax, ay, az, gx, gy, gz)) {
-        publishSensorData(ax, ay, az, gx, gy, gz);
-        logSensorData(ax, ay, az, gx, gy, gz);
+    if (readMPUData(sensor, ax, ay, az, gx, gy, gz)) {
+        // Quantized to the configured ranges, so consumers see one format in both modes
+        MpuRawCounts raw = MpuSample::fromSI(ranges_, ax, ay, az, gx, gy, gz);
+        collectCalibration(sensor, &raw, 1);
+        sensor.lastCounts = sensor.calibration.apply(raw);
+        sensor.lastTimestampUs = esp_timer_get_time();
+        publishSample(sensor, sensor.lastTimestampUs, sensor.lastCounts);
+        sensor.samples.fetch_add(1, std::memory_order_relaxed);
+        if (&sensor == sensors_[0]) {
+            logSensorData(sensor.lastCounts);
+        }
     } else {
-        Serial.println("[MPU] Failed to read sensor data");
+        Serial.printf("[MPU] Failed to read sensor %u data\n", (unsigned)sensor.index);
+    }
+}
+
+bool MPU::startAcquisitionTask() {
+    acquisitionStop_.store(false);
+    acquisitionRunning_.store(true);
+    if (xTaskCreate(acquisitionTaskFunction, "MPUAcq", 4096, this, ACQUISITION_PRIORITY, &acquisitionTask_) != pdPASS) {
+        acquisitionRunning_.store(false);
+        acquisitionTask_ = nullptr;
+        return false;
+    }
+
+    // The first sensor's interrupts pace the cycle for all of them
+    Mpu6050Fifo& fifo = sensors_[0]->fifo;
+    uint32_t notifyEvery = fifo.rateHz() * ACQUISITION_WAKE_MS / 1000;
+    if (!fifo.enableDataReadyInterrupt(MPU_INT_PIN, acquisitionTask_, notifyEvery)) {
+        stopAcquisitionTask();
+        return false;
+    }
+
+    Serial.printf("[MPU] Data-ready interrupt on GPIO %d, waking every %u samples\n", MPU_INT_PIN,
+                  (unsigned)(notifyEvery > 0 ? notifyEvery : 1));
+    return true;
+}
+
+// Lets a cycle in progress finish and the task exit: deleting it mid-cycle could leave the bus
+// mutex taken or a Wire transaction half done
+void MPU::stopAcquisitionTask() {
+    acquisitionStop_.store(true);
+    xTaskNotifyGive(acquisitionTask_);
+    while (acquisitionRunning_.load()) {
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+    acquisitionTask_ = nullptr;
+}
+
+void MPU::acquisitionTaskFunction(void* parameter) {
+    MPU* mpu = static_cast<MPU*>(parameter);
+    while (true) {
+        // Sleeps between interrupts; the timeout keeps samples flowing if INT isn't wired
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ACQUISITION_TIMEOUT_MS));
+        if (mpu->acquisitionStop_.load()) {
+            break;
+        }
+        if (mpu->capturing_) {
+            mpu->runCycle();
+        }
     }
+
+    mpu->acquisitionRunning_.store(false);
+    vTaskDelete(nullptr);
 }
 
-void MPU::publishSensorData(float ax, float ay, float az, float gx, float gy, float gz) {
-    // Create binary data packet: timestamp(4) + ax(4) + ay(4) + az(4) + gx(4) + gy(4) + gz(4) = 28 bytes
-    uint8_t data[28];
-    uint32_t timestamp = millis();
+void MPU::drainFifo(Sensor& sensor) {
+    Mpu6050Fifo::RawSample samples[FIFO_DRAIN_BATCH];
+    int count;
+    do {
+        uint64_t firstIndex = 0;
+        count = sensor.fifo.readSamples(samples, FIFO_DRAIN_BATCH, firstIndex);
+        if (count < 0) {
+            LOG_ERROR(MPU, "Sensor %u FIFO read failed", sensor.index);
+            return;
+        }
+
+        // Calibration runs see the sensor's own counts
+        collectCalibration(sensor, samples, count);
+
+        for (int i = 0; i < count; i++) {
+            sensor.lastCounts = sensor.calibration.apply(samples[i]);
 
+            // ISR or sensor-clock time, so wake-up jitter of this task doesn't reach the timeline
+            sensor.lastTimestampUs = sensor.fifo.sampleTimeUs(firstIndex + i);
+            publishSample(sensor, sensor.lastTimestampUs, sensor.lastCounts);
+        }
+        sensor.samples.fetch_add(count, std::memory_order_relaxed);
+        if (count > 0 && &sensor == sensors_[0]) {
+            logSensorData(sensor.lastCounts);
+        }
+    } while (count == (int)FIFO_DRAIN_BATCH);
+}
+
+void MPU::publishSample(Sensor& sensor, uint64_t timestampUs, const MpuRawCounts& counts) {
+    uint8_t raw[MpuSample::RAW_SIZE];
+    MpuSample::encode(raw, timestampUs, ranges_, counts);
+
+    // Hot slot and legacy SI packet carry 32-bit millis()
+    uint32_t timestamp = (uint32_t)(timestampUs / 1000);
+
+    // Attached consumers first: a copy into each ring, never blocks
+    size_t consumers = sensor.consumerCount.load(std::memory_order_acquire);
+    for (size_t i = 0; i < consumers; i++) {
+        sensor.consumers[i].load(std::memory_order_relaxed)->push(raw);
+    }
+
+    // Publish to network for everything else subscribed to <prefix>raw
+    if (sensor.rawSubscribed) {
+        networkLayer_->publish(sensor.rawTopic, raw, sizeof(raw));
+    }
+
+#if MPU_PUBLISH_SI
+    // Legacy packet: timestamp(4) + ax(4) + ay(4) + az(4) + gx(4) + gy(4) + gz(4) = 28 bytes
+    float values[6];
+    MpuSample::toSI(counts, ranges_, values[0], values[1], values[2], values[3], values[4], values[5]);
+    uint8_t data[SI_READING_SIZE];
     memcpy(data, &timestamp, 4);
-    memcpy(data + 4, &ax, 4);
-    memcpy(data + 8, &ay, 4);
-    memcpy(data + 12, &az, 4);
-    memcpy(data + 16, &gx, 4);
-    memcpy(data + 20, &gy, 4);
-    memcpy(data + 24, &gz, 4);
+    memcpy(data + 4, values, sizeof(values));
+    networkLayer_->publish(sensor.prefix + "data", data, sizeof(data));
+#endif
 
-    // Publish to network
-    networkLayer_->publish("mpu/data", data, sizeof(data));
+    // Store in data layer for other applications to access (single writer, never blocks)
+    if (sensor.lastReadingSlot) {
+        sensor.lastReadingSlot->write(raw, timestamp);
+    }
 
-    // Store in data layer for other applications to access
-    std::vector<uint8_t> dataVector(data, data + sizeof(data));
-    dataLayer_->set("mpu/last_reading", dataVector, 1000); // 1 second TTL
+    if (sensor.historyStream) {
+        // 64-bit µs: a 32-bit ms stamp wraps after 49.7 days and the stream refuses to go backwards
+        sensor.historyStream->append(timestampUs, reinterpret_cast<const uint8_t*>(&counts));
+    }
 }
 
-void MPU::logSensorData(float ax, float ay, float az, float gx, float gy, float gz) {
+void MPU::publishThroughput() {
+    uint32_t now = millis();
+    Throughput report;
+    report.sensors = sensorCount_;
+    report.windowMs = now - lastThroughputMs_;
+    lastThroughputMs_ = now;
+
+    report.samples = 0;
+    for (size_t i = 0; i < sensorCount_; i++) {
+        uint32_t samples = sensors_[i]->samples.exchange(0, std::memory_order_relaxed);
+        report.samples += samples;
+        if (sensorCount_ > 1) {
+            LOG_INFO(MPU, "Sensor %u: %u samples/s", sensors_[i]->index,
+                     report.windowMs ? (unsigned)((uint64_t)samples * 1000 / report.windowMs) : 0u);
+        }
+    }
+    report.samplesPerSecond = report.windowMs ? (uint32_t)((uint64_t)report.samples * 1000 / report.windowMs) : 0;
+
+    report.cycles = cycleCount_.exchange(0, std::memory_order_relaxed);
+    uint32_t totalUs = cycleTotalUs_.exchange(0, std::memory_order_relaxed);
+    report.cycleAvgUs = report.cycles ? totalUs / report.cycles : 0;
+    report.cycleMaxUs = cycleMaxUs_.exchange(0, std::memory_order_relaxed);
+    report.perSensorUs = report.sensors ? report.cycleAvgUs / report.sensors : 0;
+    report.overflows = overflows_.load(std::memory_order_relaxed);
+
+    networkLayer_->publish("diagnostics/mpu", reinterpret_cast<const uint8_t*>(&report), sizeof(report));
+    LOG_INFO(MPU, "%u sensors, %u samples/s: cycle avg %u us (%u us/sensor), max %u us", report.sensors,
+             report.samplesPerSecond, report.cycleAvgUs, report.perSensorUs, report.cycleMaxUs);
+}
+
+void MPU::logSensorData(const MpuRawCounts& counts) {
     static unsigned long lastLogTime = 0;
     unsigned long currentTime = millis();
 
-    // Log every 500ms to avoid spam
+    // Log every 500ms to avoid spam; the only place floats are needed on this task
     if (currentTime - lastLogTime >= 500) {
-        Serial.printf("[MPU] Accel: %.2f, %.2f, %.2f | Gyro: %.2f, %.2f, %.2f\n",
-                     ax, ay, az, gx, gy, gz);
+        float ax, ay, az, gx, gy, gz;
+        MpuSample::toSI(counts, ranges_, ax, ay, az, gx, gy, gz);
+        LOG_INFO(MPU, "Accel: %.2f, %.2f, %.2f | Gyro: %.2f, %.2f, %.2f", ax, ay, az, gx, gy, gz);
         lastLogTime = currentTime;
     }
 }
 
 // MPU hardware implementation
-bool MPU::initMPU() {
-    if (!mpu_.begin()) {
-        Serial.println("[MPU] Failed to find MPU6050 chip");
+bool MPU::initSensor(Sensor& sensor) {
+    // The Adafruit driver talks to Wire directly
+    bus_->acquire();
+    if (!bus_->selectChannel(sensor.channel) || !sensor.driver.begin(sensor.address, bus_->wire())) {
+        bus_->release();
+        Serial.printf("[MPU] Failed to find MPU6050 chip at 0x%02X, channel %d\n", sensor.address, sensor.channel);
         return false;
     }
 
     // Configure for maximum speed - disable motion detection for faster readings
-    // mpu_.setHighPassFilter(MPU6050_HIGHPASS_0_63_HZ);
-    // mpu_.setMotionDetectionThreshold(1);
-    // mpu_.setMotionDetectionDuration(20);
-    // mpu_.setInterruptPinLatch(true);
-    // mpu_.setInterruptPinPolarity(true);
-    // mpu_.setMotionInterrupt(true);
+    // sensor.driver.setHighPassFilter(MPU6050_HIGHPASS_0_63_HZ);
+    // sensor.driver.setMotionDetectionThreshold(1);
+    // sensor.driver.setMotionDetectionDuration(20);
+    // sensor.driver.setInterruptPinLatch(true);
+    // sensor.driver.setInterruptPinPolarity(true);
+    // sensor.driver.setMotionInterrupt(true);
 
     // Set accelerometer range for optimal performance
-    mpu_.setAccelerometerRange(MPU6050_RANGE_4_G);
-    mpu_.setGyroRange(MPU6050_RANGE_500_DEG);
-    mpu_.setFilterBandwidth(MPU6050_BAND_260_HZ);
-
-    Serial.println("[MPU] MPU6050 initialized for stable Bluetooth operation (50Hz)");
+    sensor.driver.setAccelerometerRange(MPU6050_RANGE_4_G);
+    sensor.driver.setGyroRange(MPU6050_RANGE_500_DEG);
+    sensor.driver.setFilterBandwidth(MPU6050_BAND_260_HZ);
+    ranges_ = MpuSample::packRanges(sensor.driver.getAccelerometerRange(), sensor.driver.getGyroRange());
+    bus_->release();
     return true;
 }
 
-bool MPU::readMPUData(float& ax, float& ay, float& az, float& gx, float& gy, float& gz) {
+bool MPU::readMPUData(Sensor& sensor, float& ax, float& ay, float& az, float& gx, float& gy, float& gz) {
     sensors_event_t a, g, temp;
-    mpu_.getEvent(&a, &g, &temp);
+    bus_->acquire();
+    bool ok = bus_->selectChannel(sensor.channel) && sensor.driver.getEvent(&a, &g, &temp);
+    bus_->release();
+    if (!ok) {
+        return false;
+    }
 
     ax = a.acceleration.x;
     ay = a.acceleration.y;
@@ -227,13 +732,5 @@ bool MPU::readMPUData(float& ax, float& ay, float& az, float& gx, float& gy, flo
     gy = g.gyro.y;
     gz = g.gyro.z;
 
-    // Store last reading
-    last_ax_ = ax;
-    last_ay_ = ay;
-    last_az_ = az;
-    last_gx_ = gx;
-    last_gy_ = gy;
-    last_gz_ = gz;
-
     return true;
-}
\ No newline at end of file
+}
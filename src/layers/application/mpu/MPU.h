@@ -2,18 +2,104 @@
 #define MPU_H
 
 #include "../ApplicationInterface.h"
+#include "Mpu6050Fifo.h"
+#include "MpuSample.h"
+#include "MpuCalibration.h"
+#include "../../hardware/I2cBus.h"
+#include "../../data/SampleRing.h"
 #include <Adafruit_MPU6050.h>
 #include <Adafruit_Sensor.h>
-#include <Wire.h>
 #include <Arduino.h>
+#include <atomic>
+#include <string>
+
+// Acquisition mode:
+//   -DMPU_FIFO_RATE_HZ=N   Sample at N Hz (1000 / n, up to 1000) on the sensor clock and drain the
+//                          on-chip FIFO in burst reads every task tick (default 50)
+//   -DMPU_FIFO_RATE_HZ=0   Poll getEvent() once per READING_INTERVAL_MS instead
+//   -DMPU_INT_PIN=13       GPIO wired to the first sensor's INT pin: DATA_RDY interrupts timestamp
+//                          each sample and wake a dedicated acquisition task (default 13)
+//   -DMPU_INT_PIN=-1       No INT wiring; the FIFO is drained from the app task tick
+//   -DMPU_PUBLISH_SI=1     Also publish the legacy 28-byte float packets on mpu/data
+//   -DMPU_SENSORS="{0x68,-1},{0x68,0},{0x69,0}"
+//                          Sensors main.cpp adds, as {address, mux channel} (-1: main bus);
+//                          default one at 0x68
+//   -DMPU_MUX_ADDRESS=0x70 TCA9548A the channels refer to (default 0x70)
+//
+// Sensors: addSensor() before setup() registers each MPU6050 by address (0x68, or 0x69 with AD0
+// high) and TCA9548A channel; with none added there is one sensor at 0x68 on the main bus. All
+// sensors are drained in one acquisition cycle, ordered by mux channel so each channel is
+// selected once per cycle, with the same fixed cost per sensor (a FIFO count read and the burst
+// reads for its samples). Only the first sensor's INT pin is wired: its interrupts time the cycle,
+// and the others are timestamped from their own sensor clocks. If any sensor's FIFO can't be
+// set up, every sensor is polled instead.
+//
+// Each sensor has its own topic namespace: "mpu/" for the first, "mpu<n>/" for sensor n. Under
+// it, samples are published as native int16 counts on raw (see MpuSample.h) and pushed, as the
+// same record, into every ring attached to that sensor with attachConsumer(); counts are
+// bias/scale corrected by the sensor's stored calibration profile (MpuCalibration.h) when
+// there is one. Aggregate throughput goes out on diagnostics/mpu every THROUGHPUT_INTERVAL_MS.
+//
+// Calibration: a uint32 duration in ms on <namespace>calibrate averages a still period of that
+// length on the sampling task (0 clears the profile). The outcome goes out on
+// <namespace>calibration as a status byte (MpuCalibration::Status) followed by the resulting
+// Profile, and the profile is stored under config/<namespace>calibration so it survives reboots.
+#ifndef MPU_FIFO_RATE_HZ
+#define MPU_FIFO_RATE_HZ 50
+#endif
+
+#ifndef MPU_INT_PIN
+#define MPU_INT_PIN 13
+#endif
+
+#ifndef MPU_PUBLISH_SI
+#define MPU_PUBLISH_SI 0
+#endif
+
+#ifndef MPU_SENSORS
+#define MPU_SENSORS {0x68, -1}
+#endif
+
+#ifndef MPU_MUX_ADDRESS
+#define MPU_MUX_ADDRESS 0x70
+#endif
 
 // MPU Application
 // Handles MPU6050 sensor data collection, processing, and transmission
+// All bus traffic goes through the shared I2cBus; the Adafruit driver (setup and polled mode)
+// runs with the bus acquired
 class MPU : public ApplicationInterface {
 public:
-    MPU();
+    static const size_t MAX_SENSORS = 16;   // 0x68 and 0x69 on each of 8 mux channels
+    static const size_t MAX_CONSUMERS = 4;  // Rings per sensor
+
+    // Sensor wiring: I2C address and TCA9548A channel (I2cBus::NO_CHANNEL on the main bus)
+    struct SensorConfig {
+        uint8_t address;
+        int8_t channel;
+    };
+
+    // Payload of diagnostics/mpu (little-endian uint32_t fields), one window per report
+    struct Throughput {
+        uint32_t sensors;
+        uint32_t windowMs;
+        uint32_t samples;           // All sensors, in the window
+        uint32_t samplesPerSecond;  // All sensors
+        uint32_t cycles;            // Acquisition cycles in the window
+        uint32_t cycleAvgUs;
+        uint32_t cycleMaxUs;
+        uint32_t perSensorUs;       // cycleAvgUs / sensors
+        uint32_t overflows;         // FIFO overflows, all sensors, since boot
+    };
+
+    MPU(I2cBus* bus);
     ~MPU();
 
+    // Before setup(); false if the table is full or the address/channel pair is taken. The bus
+    // must have a mux (I2cBus::setMux()) for channel >= 0.
+    bool addSensor(uint8_t address, int8_t channel = I2cBus::NO_CHANNEL);
+    size_t sensorCount() const { return sensorCount_; }
+
     bool setup();
     void update();
 
@@ -22,35 +108,110 @@ public:
     void stopCapture();
     bool isCapturing() const;
 
-    // Data access
-    bool getLastReading(float& ax, float& ay, float& az, float& gx, float& gy, float& gz) const;
+    // Recorders and streamers read samples from their own ring, filled directly by the sampling
+    // task: no broker copy, task or lock per sample. Attach before capture starts; a consumer
+    // that falls behind loses samples in its ring only. Up to MAX_CONSUMERS rings of
+    // MpuSample::RAW_SIZE records per sensor.
+    bool attachConsumer(SampleRing* ring, size_t sensor = 0);
+
+    // Data access (converted from the last counts on each call)
+    bool getLastReading(float& ax, float& ay, float& az, float& gx, float& gy, float& gz,
+                        size_t sensor = 0) const;
 
 private:
+    // One MPU6050; everything the sampling path touches for it sits together
+    struct Sensor {
+        uint8_t index;              // Order added; names the topic namespace
+        uint8_t address;
+        int8_t channel;
+        Adafruit_MPU6050 driver;
+        Mpu6050Fifo fifo;
+        std::string prefix;         // "mpu/" or "mpu<n>/"
+        std::string rawTopic;
+        bool rawSubscribed;         // rawTopic has a subscriber or a publish tap records it; once per cycle
+        MpuRawCounts lastCounts;
+        uint64_t lastTimestampUs;   // When lastCounts was sampled
+
+        // Calibration: the profile and the run in progress belong to the sampling path;
+        // requests come in and results go out through the atomics
+        MpuCalibration calibration;
+        std::atomic<int32_t> calibrationRequest; // Duration in ms, 0 = clear, -1 = none
+        std::atomic<int32_t> calibrationResult;  // MpuCalibration::Status, -1 = none
+        MpuCalibration::Profile calibrationProfile; // Published with the result
+
+        DataStream* historyStream;  // "<prefix>history": ax..gz counts per sample by esp_timer µs, shared with other apps
+        HotSlot* lastReadingSlot;   // "<prefix>last_reading": raw record, written lock-free at the sampling rate
+        std::atomic<SampleRing*> consumers[MAX_CONSUMERS];
+        std::atomic<size_t> consumerCount;
+        std::atomic<uint32_t> samples; // Published since the last throughput report
+
+        Sensor(uint8_t index, uint8_t address, int8_t channel);
+    };
+
     // MPU6050 hardware
-    Adafruit_MPU6050 mpu_;
+    I2cBus* bus_;
+    Sensor* sensors_[MAX_SENSORS];  // Order added
+    Sensor* cycleOrder_[MAX_SENSORS]; // Sorted by mux channel
+    size_t sensorCount_;
+    bool fifoMode_;
+    std::atomic<bool> fifoResetPending_; // Set by startCapture(), handled on the sampling task
+    TaskHandle_t acquisitionTask_;       // Runs the cycle when woken by the data-ready ISR
+    std::atomic<bool> acquisitionStop_;  // Asks the acquisition task to exit between cycles
+    std::atomic<bool> acquisitionRunning_;
 
     // State
     bool initialized_;
     bool capturing_;
     unsigned long lastReadingTime_;
-    float last_ax_, last_ay_, last_az_, last_gx_, last_gy_, last_gz_;
+    uint64_t lastPollUs_;       // Polled mode: when the last cycle ran, 0 when not capturing
+    uint32_t pollIntervalUs_;   // Polled mode: measured cycle period (task period, not READING_INTERVAL_MS)
+    uint8_t ranges_;            // MpuSample::packRanges() of the configured ranges
+    uint32_t lastDriftLogMs_;
+
+    // Cycle timing, accumulated by the sampling task and reported from update()
+    std::atomic<uint32_t> cycleCount_;
+    std::atomic<uint32_t> cycleTotalUs_;
+    std::atomic<uint32_t> cycleMaxUs_;
+    std::atomic<uint32_t> overflows_;
+    uint32_t lastThroughputMs_;
 
     // Configuration
     static const unsigned long READING_INTERVAL_MS = 10; // 100 Hz
+    static const size_t HISTORY_CAPACITY = 3000;         // 30 s at 100 Hz, kept in PSRAM
+    static const size_t SI_READING_SIZE = 28;            // mpu/data: timestamp + 6 floats
+    static const uint32_t MAX_CALIBRATION_MS = 30000;
+    static const uint32_t LAST_READING_TTL_MS = 1000;
+    static const size_t FIFO_DRAIN_BATCH = 32;           // Samples per readSamples() call
+    static const UBaseType_t ACQUISITION_PRIORITY = 5;   // Above the apps and message delivery
+    static const uint32_t ACQUISITION_WAKE_MS = 10;      // Interrupts are batched to about this
+    static const uint32_t ACQUISITION_TIMEOUT_MS = 50;   // Drain anyway if interrupts stop
+    static const uint32_t DRIFT_LOG_INTERVAL_MS = 60000;
+    static const uint32_t THROUGHPUT_INTERVAL_MS = 10000;
 
     // Network callbacks
     void onStartCapture(const uint8_t* data, size_t len, const std::string& topic);
     void onStopCapture(const uint8_t* data, size_t len, const std::string& topic);
-    void onDataRequest(const uint8_t* data, size_t len, const std::string& topic);
+    void onDataRequest(Sensor& sensor);
+    void onCalibrate(Sensor& sensor, const uint8_t* data, size_t len);
 
     // MPU hardware methods
-    bool initMPU();
-    bool readMPUData(float& ax, float& ay, float& az, float& gx, float& gy, float& gz);
+    bool initSensor(Sensor& sensor);
+    bool startAcquisitionTask();
+    void stopAcquisitionTask();
+    static void acquisitionTaskFunction(void* parameter);
+    bool readMPUData(Sensor& sensor, float& ax, float& ay, float& az, float& gx, float& gy, float& gz);
 
     // Helper methods
-    void readAndPublishData();
-    void publishSensorData(float ax, float ay, float az, float gx, float gy, float gz);
-    void logSensorData(float ax, float ay, float az, float gx, float gy, float gz);
+    bool setupSensorTopics(Sensor& sensor);
+    void runCycle();
+    void readAndPublishData(Sensor& sensor);
+    void drainFifo(Sensor& sensor);
+    void publishSample(Sensor& sensor, uint64_t timestampUs, const MpuRawCounts& counts);
+    void collectCalibration(Sensor& sensor, const MpuRawCounts* samples, size_t count);
+    void publishCalibration(Sensor& sensor, MpuCalibration::Status status, const MpuCalibration::Profile& profile);
+    void loadCalibration(Sensor& sensor);
+    void publishThroughput();
+    void logSensorData(const MpuRawCounts& counts);
 };
 
 #endif // MPU_H
\ No newline at end of file
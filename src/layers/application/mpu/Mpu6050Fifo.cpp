@@ -0,0 +1,264 @@
+#include "Mpu6050Fifo.h"
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <cstring>
+#include "../../logging/Log.h"
+
+// MPU6050 registers (RM-MPU-6000A)
+static const uint8_t REG_SMPLRT_DIV = 0x19;
+static const uint8_t REG_CONFIG = 0x1A;
+static const uint8_t REG_GYRO_CONFIG = 0x1B;
+static const uint8_t REG_ACCEL_CONFIG = 0x1C;
+static const uint8_t REG_FIFO_EN = 0x23;
+static const uint8_t REG_INT_PIN_CFG = 0x37;
+static const uint8_t REG_INT_ENABLE = 0x38;
+static const uint8_t REG_USER_CTRL = 0x6A;
+static const uint8_t REG_PWR_MGMT_1 = 0x6B;
+static const uint8_t REG_FIFO_COUNT_H = 0x72;
+static const uint8_t REG_FIFO_R_W = 0x74;
+
+static const uint8_t FIFO_EN_GYRO_ACCEL = 0x78;   // XG, YG, ZG, ACCEL
+static const uint8_t USER_CTRL_FIFO_EN = 0x40;
+static const uint8_t USER_CTRL_FIFO_RESET = 0x04;
+static const uint8_t PWR_CLKSEL_PLL_XGYRO = 0x01; // Gyro-referenced clock, steadier than the internal RC
+static const uint8_t INT_PIN_PUSH_PULL_PULSE = 0x00; // Active high, 50 us pulse
+static const uint8_t INT_ENABLE_DATA_RDY = 0x01;
+
+// ISR timestamps this close to being overwritten are not trusted (64-bit stores aren't atomic)
+static const uint32_t IRQ_RING_GUARD = 16;
+
+Mpu6050Fifo::Mpu6050Fifo()
+    : periodUs_(0),
+      anchorUs_(0),
+      nextIndex_(0),
+      overflows_(0),
+      ranges_(0),
+      irqCount_(0),
+      irqGpio_(-1),
+      irqTask_(nullptr),
+      irqNotifyEvery_(1),
+      irqBase_(0),
+      irqBaseCandidate_(0),
+      irqSynced_(false),
+      irqCandidateValid_(false) {
+    memset(irqTimes_, 0, sizeof(irqTimes_));
+}
+
+bool Mpu6050Fifo::begin(I2cBus* bus, uint16_t rateHz, uint8_t accelRange, uint8_t gyroRange, uint8_t dlpf,
+                        uint8_t address, int8_t channel) {
+    if (rateHz == 0 || !device_.attach(bus, address, I2cBus::PRIORITY_HIGH, channel)) {
+        return false;
+    }
+
+    if (rateHz > MAX_RATE_HZ) {
+        rateHz = MAX_RATE_HZ;
+    }
+    uint16_t divider = (MAX_RATE_HZ + rateHz / 2) / rateHz;
+    if (divider > 256) {
+        divider = 256;
+    }
+    periodUs_ = 1000u * divider;
+
+    accelRange &= 0x03;
+    gyroRange &= 0x03;
+    if (dlpf == 0 || dlpf > 6) {
+        dlpf = 1;
+    }
+
+    ranges_ = MpuSample::packRanges(accelRange, gyroRange);
+
+    if (!device_.writeRegister(REG_PWR_MGMT_1, PWR_CLKSEL_PLL_XGYRO) ||
+        !device_.writeRegister(REG_SMPLRT_DIV, (uint8_t)(divider - 1)) ||
+        !device_.writeRegister(REG_CONFIG, dlpf) ||
+        !device_.writeRegister(REG_GYRO_CONFIG, gyroRange << 3) ||
+        !device_.writeRegister(REG_ACCEL_CONFIG, accelRange << 3) ||
+        !device_.writeRegister(REG_FIFO_EN, FIFO_EN_GYRO_ACCEL)) {
+        LOG_ERROR(MPU, "FIFO configuration failed");
+        return false;
+    }
+
+    return resetFifo();
+}
+
+bool Mpu6050Fifo::resetFifo() {
+    if (!device_.isAttached()) {
+        return false;
+    }
+
+    // Stop, flush and restart; the first new sample lands one period after re-enabling
+    if (!device_.writeRegister(REG_USER_CTRL, 0) ||
+        !device_.writeRegister(REG_USER_CTRL, USER_CTRL_FIFO_RESET) ||
+        !device_.writeRegister(REG_USER_CTRL, USER_CTRL_FIFO_EN)) {
+        return false;
+    }
+    anchorUs_ = esp_timer_get_time() + periodUs_;
+    nextIndex_ = 0;
+    clock_.reset(periodUs_);
+    irqSynced_ = false;
+    irqCandidateValid_ = false;
+    return true;
+}
+
+bool Mpu6050Fifo::enableDataReadyInterrupt(uint8_t gpio, TaskHandle_t task, uint32_t notifyEvery) {
+    if (!device_.isAttached() || task == nullptr) {
+        return false;
+    }
+
+    irqTask_ = task;
+    irqNotifyEvery_ = notifyEvery > 0 ? notifyEvery : 1;
+    irqSynced_ = false;
+    irqCandidateValid_ = false;
+
+    pinMode(gpio, INPUT);
+    attachInterruptArg(gpio, onDataReady, this, RISING);
+    if (!device_.writeRegister(REG_INT_PIN_CFG, INT_PIN_PUSH_PULL_PULSE) ||
+        !device_.writeRegister(REG_INT_ENABLE, INT_ENABLE_DATA_RDY)) {
+        detachInterrupt(gpio);
+        return false;
+    }
+    irqGpio_ = gpio;
+    return true;
+}
+
+void Mpu6050Fifo::disableDataReadyInterrupt() {
+    if (irqGpio_ < 0) {
+        return;
+    }
+    device_.writeRegister(REG_INT_ENABLE, 0);
+    detachInterrupt(irqGpio_);
+    irqGpio_ = -1;
+    irqSynced_ = false;
+}
+
+void IRAM_ATTR Mpu6050Fifo::onDataReady(void* arg) {
+    int64_t now = esp_timer_get_time();
+    Mpu6050Fifo* self = static_cast<Mpu6050Fifo*>(arg);
+
+    uint32_t n = self->irqCount_.load(std::memory_order_relaxed);
+    self->irqTimes_[n & (IRQ_RING_SIZE - 1)] = now;
+    self->irqCount_.store(n + 1, std::memory_order_release);
+
+    if ((n + 1) % self->irqNotifyEvery_ == 0) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(self->irqTask_, &woken);
+        if (woken == pdTRUE) {
+            portYIELD_FROM_ISR();
+        }
+    }
+}
+
+uint64_t Mpu6050Fifo::sampleTimeUs(uint64_t index) const {
+    if (irqSynced_) {
+        uint32_t irq = irqBase_ + (uint32_t)index;
+        uint32_t age = irqCount_.load(std::memory_order_acquire) - irq;
+        if (age >= 1 && age <= IRQ_RING_SIZE - IRQ_RING_GUARD) {
+            return (uint64_t)irqTimes_[irq & (IRQ_RING_SIZE - 1)];
+        }
+    }
+    if (clock_.isLocked()) {
+        int64_t t = clock_.timeOf(index);
+        return t > 0 ? (uint64_t)t : 0;
+    }
+    return anchorUs_ + index * periodUs_;
+}
+
+int Mpu6050Fifo::readSamples(RawSample* out, size_t maxSamples, uint64_t& firstIndex) {
+    firstIndex = nextIndex_;
+    if (!device_.isAttached() || out == nullptr || maxSamples == 0) {
+        return 0;
+    }
+
+    uint32_t irqBefore = irqCount_.load(std::memory_order_acquire);
+    uint8_t countBytes[2];
+    if (!device_.readRegisters(REG_FIFO_COUNT_H, countBytes, sizeof(countBytes))) {
+        return -1;
+    }
+    uint32_t irqAfter = irqCount_.load(std::memory_order_acquire);
+    int64_t countReadUs = esp_timer_get_time();
+    size_t count = ((size_t)countBytes[0] << 8) | countBytes[1];
+
+    // A full FIFO, or a count that isn't whole samples, means bytes were overwritten
+    if (count > FIFO_BYTES - SAMPLE_BYTES || count % SAMPLE_BYTES != 0) {
+        overflows_++;
+        LOG_WARN(MPU, "FIFO overflow (%u bytes queued), resetting", count);
+        if (!resetFifo()) {
+            return -1;
+        }
+        firstIndex = nextIndex_;
+        return 0;
+    }
+
+    size_t available = count / SAMPLE_BYTES;
+    if (irqGpio_ >= 0 && irqBefore == irqAfter) {
+        syncInterrupts(irqAfter, nextIndex_ + available);
+    }
+    if (available > 0) {
+        // Every counted sample existed when the count was read; the ISR time is exact when known
+        uint64_t newest = nextIndex_ + available - 1;
+        int64_t existedUs = countReadUs;
+        if (irqSynced_ && irqBefore == irqAfter && irqAfter - (irqBase_ + (uint32_t)newest) == 1) {
+            existedUs = irqTimes_[(irqAfter - 1) & (IRQ_RING_SIZE - 1)];
+        }
+        clock_.addObservation(newest, existedUs);
+    }
+    size_t total = available < maxSamples ? available : maxSamples;
+    uint8_t burst[I2cBus::Device::MAX_QUEUED][MAX_BURST_SAMPLES * SAMPLE_BYTES];
+    static const uint8_t fifoRegister = REG_FIFO_R_W;
+
+    for (size_t done = 0; done < total;) {
+        // Queue a round of bursts back to back and sleep once while the bus task runs them
+        size_t queued = 0;
+        size_t round = 0;
+        while (done + round < total && queued < I2cBus::Device::MAX_QUEUED) {
+            size_t n = total - done - round;
+            if (n > MAX_BURST_SAMPLES) {
+                n = MAX_BURST_SAMPLES;
+            }
+            if (!device_.queue(&fifoRegister, 1, burst[queued], n * SAMPLE_BYTES)) {
+                break;
+            }
+            queued++;
+            round += n;
+        }
+        if (!device_.wait() || queued == 0) {
+            // Part of a sample may have been consumed; resync rather than misframe
+            resetFifo();
+            return done > 0 ? (int)done : -1;
+        }
+
+        for (size_t i = 0; i < round; i++) {
+            const uint8_t* p = burst[i / MAX_BURST_SAMPLES] + (i % MAX_BURST_SAMPLES) * SAMPLE_BYTES;
+            RawSample& s = out[done + i];
+            s.ax = (int16_t)((p[0] << 8) | p[1]);
+            s.ay = (int16_t)((p[2] << 8) | p[3]);
+            s.az = (int16_t)((p[4] << 8) | p[5]);
+            s.gx = (int16_t)((p[6] << 8) | p[7]);
+            s.gy = (int16_t)((p[8] << 8) | p[9]);
+            s.gz = (int16_t)((p[10] << 8) | p[11]);
+        }
+        done += round;
+    }
+
+    nextIndex_ += total;
+    return (int)total;
+}
+
+void Mpu6050Fifo::syncInterrupts(uint32_t irqCount, uint64_t produced) {
+    // No sample landed while the count was read, so interrupt irqCount - 1 is sample produced - 1
+    if (produced == 0) {
+        return;
+    }
+    uint32_t base = irqCount - (uint32_t)produced;
+    if (!irqCandidateValid_ || base != irqBaseCandidate_) {
+        irqBaseCandidate_ = base;
+        irqCandidateValid_ = true;
+        return;
+    }
+    irqBase_ = base;
+    irqSynced_ = true;
+
+    // Keep the fallback timeline on the ISR clock too, so it doesn't drift with the sensor clock
+    int64_t newest = irqTimes_[(irqCount - 1) & (IRQ_RING_SIZE - 1)];
+    int64_t anchor = newest - (int64_t)((produced - 1) * periodUs_);
+    anchorUs_ = anchor > 0 ? (uint64_t)anchor : 0;
+}
@@ -0,0 +1,107 @@
+#ifndef MPU6050_FIFO_H
+#define MPU6050_FIFO_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include "MpuSample.h"
+#include "ClockDriftEstimator.h"
+#include "../../hardware/I2cBus.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// Register-level MPU6050 acquisition through the on-chip FIFO.
+//
+// The sensor samples on its own clock (1 kHz / (1 + SMPLRT_DIV)) and queues accel + gyro
+// (12 bytes per sample) into its 1024-byte FIFO; the host drains it with one FIFO_COUNT read
+// and burst reads of up to MAX_BURST_SAMPLES samples each, queued on the shared I2cBus at high
+// priority and awaited together, instead of the several small
+// transactions and the temperature read of Adafruit's getEvent(). Samples are timestamped
+// from the sensor clock, so jitter in the draining task does not show up in the timeline:
+// each drain tells a ClockDriftEstimator which sample index existed by when, and it maps
+// indices to esp_timer time with the sensor's measured period (nominal until the first epoch
+// closes), following the sensor clock's drift against the CPU clock over long sessions.
+//
+// When the FIFO overflows it keeps writing over the oldest bytes and the 12-byte framing is
+// lost; readSamples() detects that from the byte count, resets the FIFO and re-anchors.
+//
+// With the INT pin wired, enableDataReadyInterrupt() timestamps every sample in the GPIO ISR
+// with esp_timer_get_time() and wakes a task every few samples. Each drain lines the ISR count
+// up with the FIFO position, so sample times come from the ISR (microsecond accurate, and
+// immune to the sensor clock's +-1% tolerance) and fall back to the drift-corrected sensor
+// clock for samples whose interrupt was missed or has left the timestamp ring.
+class Mpu6050Fifo {
+public:
+    // One FIFO entry in sensor units (big-endian on the wire, host order here)
+    typedef MpuRawCounts RawSample;
+
+    static const uint8_t DEFAULT_ADDRESS = 0x68;
+    static const uint16_t MAX_RATE_HZ = 1000;
+    static const size_t SAMPLE_BYTES = 12;
+    static const size_t FIFO_BYTES = 1024;
+    static const size_t MAX_BURST_SAMPLES = 10; // 120 bytes, within the 128-byte Wire buffer
+    static const size_t IRQ_RING_SIZE = 256;    // ISR timestamps kept, power of two
+
+    Mpu6050Fifo();
+
+    // Configure sample rate, ranges (0-3, as the Adafruit range enums) and DLPF, then start
+    // the FIFO. The rate is rounded to 1000 / n Hz; dlpf 0 is raised to 1 because the
+    // unfiltered gyro runs at 8 kHz and would break the 1 kHz base rate. channel is the
+    // TCA9548A channel the sensor sits behind (I2cBus::NO_CHANNEL on the main bus).
+    bool begin(I2cBus* bus, uint16_t rateHz, uint8_t accelRange, uint8_t gyroRange, uint8_t dlpf,
+               uint8_t address = DEFAULT_ADDRESS, int8_t channel = I2cBus::NO_CHANNEL);
+
+    // Drain up to maxSamples queued samples. firstIndex receives the sensor-clock index of
+    // out[0]; indices run consecutively within one call. Returns -1 on a bus error.
+    int readSamples(RawSample* out, size_t maxSamples, uint64_t& firstIndex);
+
+    // Discard queued data and restart the timeline from now
+    bool resetFifo();
+
+    // Route DATA_RDY to gpio (rising edge) and notify task after every notifyEvery samples
+    bool enableDataReadyInterrupt(uint8_t gpio, TaskHandle_t task, uint32_t notifyEvery);
+    void disableDataReadyInterrupt();
+    bool interruptEnabled() const { return irqGpio_ >= 0; }
+
+    // Timestamp (esp_timer microseconds) of a sample index from the current readSamples() timeline
+    uint64_t sampleTimeUs(uint64_t index) const;
+
+    uint16_t rateHz() const { return periodUs_ ? (uint16_t)(1000000 / periodUs_) : 0; }
+    uint32_t periodUs() const { return periodUs_; }
+    uint32_t overflowCount() const { return overflows_; }
+    uint32_t interruptCount() const { return irqCount_.load(); }
+
+    // Sensor clock against esp_timer, in parts per million (positive: sensor runs slow)
+    double clockDriftPpm() const { return clock_.driftPpm(); }
+
+    // Configured ranges in MpuSample::packRanges() form, for converting the counts
+    uint8_t ranges() const { return ranges_; }
+
+private:
+    I2cBus::Device device_;
+    uint32_t periodUs_;
+    uint64_t anchorUs_;
+    uint64_t nextIndex_;
+    uint32_t overflows_;
+    uint8_t ranges_;
+    ClockDriftEstimator clock_;
+
+    // Written by the ISR
+    int64_t irqTimes_[IRQ_RING_SIZE];
+    std::atomic<uint32_t> irqCount_;
+    int irqGpio_;
+    TaskHandle_t irqTask_;
+    uint32_t irqNotifyEvery_;
+
+    // ISR count of FIFO sample 0, re-derived on every drain; a new value is adopted once two
+    // drains agree, so an interrupt serviced late can't shift the mapping by one sample
+    uint32_t irqBase_;
+    uint32_t irqBaseCandidate_;
+    bool irqSynced_;
+    bool irqCandidateValid_;
+
+    static void onDataReady(void* arg);
+    void syncInterrupts(uint32_t irqCount, uint64_t produced);
+};
+
+#endif // MPU6050_FIFO_H
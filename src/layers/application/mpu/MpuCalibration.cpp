@@ -0,0 +1,158 @@
+#include "MpuCalibration.h"
+#include <cmath>
+#include <cstring>
+
+// A still board shows sensor noise only: about 0.05 deg/s and a few mg RMS on the MPU6050
+static const float MAX_STILL_GYRO_DPS = 1.0f;
+static const float MAX_STILL_ACCEL_G = 0.03f;
+// An axis within this of 1 g counts as vertical; the others must be within it of 0 g
+static const float MAX_POSE_ERROR_G = 0.2f;
+
+MpuCalibration::MpuCalibration()
+    : target_(0),
+      collected_(0) {
+    reset(0);
+}
+
+void MpuCalibration::reset(uint8_t ranges) {
+    memset(&profile_, 0, sizeof(profile_));
+    profile_.version = PROFILE_VERSION;
+    profile_.ranges = ranges;
+    for (int axis = 0; axis < 3; axis++) {
+        profile_.accelScale[axis] = SCALE_ONE;
+    }
+    derive();
+}
+
+bool MpuCalibration::load(const Profile& profile) {
+    if (profile.version != PROFILE_VERSION || profile.ranges != profile_.ranges) {
+        return false;
+    }
+    profile_ = profile;
+    derive();
+    return true;
+}
+
+void MpuCalibration::begin(uint32_t samples) {
+    memset(sum_, 0, sizeof(sum_));
+    memset(sumSquares_, 0, sizeof(sumSquares_));
+    collected_ = 0;
+    target_ = samples > 0 ? samples : 1;
+}
+
+bool MpuCalibration::accumulate(const MpuRawCounts* samples, size_t count) {
+    if (target_ == 0) {
+        return false;
+    }
+    if (count > target_ - collected_) {
+        count = target_ - collected_;
+    }
+
+    // Six packed int16 channels per sample, walked as one flat array. Sums and squares go into
+    // 32-bit lanes (no 64-bit adds in the inner loop) for up to LANE_SAMPLES samples at a
+    // time: 3 * 32768^2 fits an unsigned 32-bit square sum (4 would be exactly 2^32 and wrap).
+    static const size_t LANE_SAMPLES = 3;
+    const int16_t* values = reinterpret_cast<const int16_t*>(samples);
+    size_t done = 0;
+    while (done < count) {
+        size_t batch = count - done < LANE_SAMPLES ? count - done : LANE_SAMPLES;
+        int32_t sums[6] = {0, 0, 0, 0, 0, 0};
+        uint32_t squares[6] = {0, 0, 0, 0, 0, 0};
+        for (const int16_t* v = values; v < values + batch * 6; v += 6) {
+            for (size_t c = 0; c < 6; c++) {
+                sums[c] += v[c];
+                squares[c] += (uint32_t)((int32_t)v[c] * v[c]);
+            }
+        }
+        for (size_t c = 0; c < 6; c++) {
+            sum_[c] += sums[c];
+            sumSquares_[c] += squares[c];
+        }
+        values += batch * 6;
+        done += batch;
+    }
+
+    collected_ += count;
+    return collected_ >= target_;
+}
+
+MpuCalibration::Status MpuCalibration::finish() {
+    uint32_t n = collected_;
+    target_ = 0;
+    collected_ = 0;
+    if (n == 0) {
+        return STATUS_NOT_CAPTURING;
+    }
+
+    float mean[6];
+    float spread[6];
+    for (int c = 0; c < 6; c++) {
+        mean[c] = (float)((double)sum_[c] / n);
+        double variance = (double)sumSquares_[c] / n - (double)mean[c] * mean[c];
+        spread[c] = variance > 0 ? (float)sqrt(variance) : 0.0f;
+    }
+
+    const float lsbPerG = MpuSample::accelLsbPerG(profile_.ranges);
+    const float lsbPerDps = MpuSample::gyroLsbPerDps(profile_.ranges);
+    for (int axis = 0; axis < 3; axis++) {
+        if (spread[axis] > MAX_STILL_ACCEL_G * lsbPerG || spread[3 + axis] > MAX_STILL_GYRO_DPS * lsbPerDps) {
+            return STATUS_MOVING;
+        }
+    }
+
+    // The vertical axis reads about +-1 g, the others about 0 g; anything else isn't a pose
+    int vertical = 0;
+    for (int axis = 1; axis < 3; axis++) {
+        if (fabsf(mean[axis]) > fabsf(mean[vertical])) {
+            vertical = axis;
+        }
+    }
+    for (int axis = 0; axis < 3; axis++) {
+        float expected = axis == vertical ? lsbPerG : 0.0f;
+        if (fabsf(fabsf(mean[axis]) - expected) > MAX_POSE_ERROR_G * lsbPerG) {
+            return STATUS_MOVING;
+        }
+    }
+
+    int down = mean[vertical] < 0 ? 1 : 0;
+    profile_.gravity[vertical][down] = (int16_t)lroundf(mean[vertical]);
+    profile_.poses |= (uint8_t)(1u << (2 * vertical + down));
+    for (int axis = 0; axis < 3; axis++) {
+        if (axis != vertical) {
+            profile_.level[axis] = (int16_t)lroundf(mean[axis]);
+            profile_.levels |= (uint8_t)(1u << axis);
+        }
+        profile_.gyroBias[axis] = (int16_t)lroundf(mean[3 + axis]);
+    }
+
+    derive();
+    return STATUS_OK;
+}
+
+void MpuCalibration::derive() {
+    const float lsbPerG = MpuSample::accelLsbPerG(profile_.ranges);
+    for (int axis = 0; axis < 3; axis++) {
+        bool up = profile_.poses & (1u << (2 * axis));
+        bool down = profile_.poses & (1u << (2 * axis + 1));
+        int16_t bias = 0;
+        int16_t scale = SCALE_ONE;
+        if (up && down && profile_.gravity[axis][0] > profile_.gravity[axis][1]) {
+            // Both poses: the midpoint is the bias, the span is 2 g
+            float plus = profile_.gravity[axis][0];
+            float minus = profile_.gravity[axis][1];
+            bias = (int16_t)lroundf((plus + minus) / 2);
+            scale = (int16_t)lroundf(2 * lsbPerG / (plus - minus) * SCALE_ONE);
+        } else if (profile_.levels & (1u << axis)) {
+            bias = profile_.level[axis];
+        } else if (up || down) {
+            // Only one pose: assume the nominal scale
+            bias = (int16_t)lroundf(profile_.gravity[axis][up ? 0 : 1] - (up ? lsbPerG : -lsbPerG));
+        }
+        profile_.accelBias[axis] = bias;
+        profile_.accelScale[axis] = scale;
+
+        accelBias_[axis] = bias;
+        accelScale_[axis] = scale;
+        gyroBias_[axis] = profile_.gyroBias[axis];
+    }
+}
@@ -0,0 +1,99 @@
+#ifndef MPU_CALIBRATION_H
+#define MPU_CALIBRATION_H
+
+#include "MpuSample.h"
+#include <cstdint>
+#include <cstddef>
+
+// Per-axis bias and scale correction for MPU6050 counts, estimated from still periods.
+//
+// Each calibration run averages the samples of a still period (and rejects it if the spread
+// shows the board moved). The gyro bias is the mean. For the accelerometer, the axis closest
+// to vertical gives a gravity reading (+g or -g pose) and the two level axes give their bias
+// directly; once an axis has been measured pointing both up and down, its bias and scale come
+// from the pair. Poses accumulate across runs, so turning the board onto each face and
+// calibrating once per face yields a full six-pose accelerometer calibration.
+//
+// The correction is applied in fixed point on the acquisition path:
+//   accel: ((raw - bias) * scale + 2^13) >> 14, scale in Q14 (16384 = 1.0), saturated to int16
+//   gyro:  raw - bias, saturated to int16
+class MpuCalibration {
+public:
+    static const uint8_t PROFILE_VERSION = 1;
+    static const int16_t SCALE_ONE = 16384; // Q14
+
+    // Persisted as-is (DataLayer key config/mpu/calibration) and published on mpu/calibration
+    struct Profile {
+        uint8_t version;
+        uint8_t ranges;         // MpuSample::packRanges() the counts were taken at
+        uint8_t poses;          // Bit 2 * axis: axis measured pointing up (+1 g), bit 2 * axis + 1: down
+        uint8_t levels;         // Bit axis: axis measured level (0 g)
+        int16_t gravity[3][2];  // Mean accel reading of each axis up / down
+        int16_t level[3];       // Mean accel reading of each axis while level
+        int16_t accelBias[3];
+        int16_t accelScale[3];  // Q14
+        int16_t gyroBias[3];
+    };
+
+    enum Status : uint8_t {
+        STATUS_OK = 0,
+        STATUS_MOVING = 1,        // Spread during the run too large for a still period
+        STATUS_NOT_CAPTURING = 2, // No samples to average
+        STATUS_CLEARED = 3,       // Profile removed, counts pass through unchanged
+        STATUS_BUSY = 4           // A run is already in progress
+    };
+
+    MpuCalibration();
+
+    // Start from no correction for counts at these ranges
+    void reset(uint8_t ranges);
+
+    // Install a stored profile; false (and no change) if it was taken at other ranges or version
+    bool load(const Profile& profile);
+
+    const Profile& profile() const { return profile_; }
+    // Every successful run records a pose (and the gyro bias)
+    bool isCalibrated() const { return profile_.poses != 0; }
+
+    // Still-period accumulation, driven from the sampling task
+    void begin(uint32_t samples);
+    bool isCollecting() const { return target_ != 0; }
+    // Adds raw (uncorrected) samples; true once the requested number has been collected
+    bool accumulate(const MpuRawCounts* samples, size_t count);
+    // Evaluates the collected run and, if it was still, updates the profile
+    Status finish();
+
+    // Acquisition path: a few integer operations per sample
+    MpuRawCounts apply(const MpuRawCounts& raw) const {
+        MpuRawCounts out;
+        out.ax = saturate((((int32_t)raw.ax - accelBias_[0]) * accelScale_[0] + (1 << 13)) >> 14);
+        out.ay = saturate((((int32_t)raw.ay - accelBias_[1]) * accelScale_[1] + (1 << 13)) >> 14);
+        out.az = saturate((((int32_t)raw.az - accelBias_[2]) * accelScale_[2] + (1 << 13)) >> 14);
+        out.gx = saturate((int32_t)raw.gx - gyroBias_[0]);
+        out.gy = saturate((int32_t)raw.gy - gyroBias_[1]);
+        out.gz = saturate((int32_t)raw.gz - gyroBias_[2]);
+        return out;
+    }
+
+private:
+    Profile profile_;
+
+    // Widened copies of the profile for apply()
+    int32_t accelBias_[3];
+    int32_t accelScale_[3];
+    int32_t gyroBias_[3];
+
+    // Current run: per-channel sums in ax..gz order
+    uint32_t target_;
+    uint32_t collected_;
+    int64_t sum_[6];
+    int64_t sumSquares_[6];
+
+    void derive();
+
+    static int16_t saturate(int32_t value) {
+        return (int16_t)(value > 32767 ? 32767 : (value < -32768 ? -32768 : value));
+    }
+};
+
+#endif // MPU_CALIBRATION_H
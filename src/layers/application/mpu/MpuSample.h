@@ -0,0 +1,111 @@
+#ifndef MPU_SAMPLE_H
+#define MPU_SAMPLE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+// Raw MPU6050 sample as published on mpu/raw: the sensor's native int16 counts plus the
+// full-scale ranges needed to interpret them. Floats are produced only where a consumer
+// needs them (getLastReading(), the SI transmit format, or on the host).
+//
+// mpu/raw payload (22 bytes, little-endian):
+//   timestamp u64 (esp_timer us) | ranges u8 (accel << 4 | gyro) | reserved u8 | ax ay az gx gy gz int16
+//
+// The timestamp is when the sensor took the sample (data-ready ISR or the drift-corrected
+// sensor clock, see Mpu6050Fifo), not when it was read or published.
+//
+// Range codes are the register values (and Adafruit enums): accel 0-3 = ±2/4/8/16 g,
+// gyro 0-3 = ±250/500/1000/2000 deg/s.
+struct MpuRawCounts {
+    int16_t ax, ay, az;
+    int16_t gx, gy, gz;
+};
+
+namespace MpuSample {
+
+static const size_t RAW_SIZE = 22;
+static const size_t COUNTS_SIZE = sizeof(MpuRawCounts); // 12
+
+inline uint8_t packRanges(uint8_t accelRange, uint8_t gyroRange) {
+    return (uint8_t)(((accelRange & 0x03) << 4) | (gyroRange & 0x03));
+}
+
+inline float accelLsbPerG(uint8_t ranges) {
+    return 16384.0f / (float)(1 << ((ranges >> 4) & 0x03));
+}
+
+inline float gyroLsbPerDps(uint8_t ranges) {
+    return 131.0f / (float)(1 << (ranges & 0x03));
+}
+
+inline void encode(uint8_t out[RAW_SIZE], uint64_t timestampUs, uint8_t ranges, const MpuRawCounts& counts) {
+    memcpy(out, &timestampUs, 8);
+    out[8] = ranges;
+    out[9] = 0;
+    memcpy(out + 10, &counts, COUNTS_SIZE);
+}
+
+inline bool decode(const uint8_t* data, size_t len, uint64_t& timestampUs, uint8_t& ranges, MpuRawCounts& counts) {
+    if (data == nullptr || len < RAW_SIZE) {
+        return false;
+    }
+    memcpy(&timestampUs, data, 8);
+    ranges = data[8];
+    memcpy(&counts, data + 10, COUNTS_SIZE);
+    return true;
+}
+
+// m/s^2 and rad/s, the units of Adafruit's getEvent()
+inline void toSI(const MpuRawCounts& counts, uint8_t ranges, float& ax, float& ay, float& az, float& gx,
+                 float& gy, float& gz) {
+    const float accelScale = 9.80665f / accelLsbPerG(ranges);
+    const float gyroScale = 0.01745329f / gyroLsbPerDps(ranges);
+    ax = counts.ax * accelScale;
+    ay = counts.ay * accelScale;
+    az = counts.az * accelScale;
+    gx = counts.gx * gyroScale;
+    gy = counts.gy * gyroScale;
+    gz = counts.gz * gyroScale;
+}
+
+inline int16_t quantize(float value, float lsbPerUnit) {
+    float raw = value * lsbPerUnit;
+    if (raw >= 32767.0f) {
+        return 32767;
+    }
+    if (raw <= -32768.0f) {
+        return -32768;
+    }
+    return (int16_t)(raw < 0 ? raw - 0.5f : raw + 0.5f);
+}
+
+// Inverse of toSI() for readings that arrive as floats (polled getEvent mode)
+inline MpuRawCounts fromSI(uint8_t ranges, float ax, float ay, float az, float gx, float gy, float gz) {
+    const float accelLsb = accelLsbPerG(ranges) / 9.80665f;
+    const float gyroLsb = gyroLsbPerDps(ranges) * 57.29578f;
+    MpuRawCounts counts;
+    counts.ax = quantize(ax, accelLsb);
+    counts.ay = quantize(ay, accelLsb);
+    counts.az = quantize(az, accelLsb);
+    counts.gx = quantize(gx, gyroLsb);
+    counts.gy = quantize(gy, gyroLsb);
+    counts.gz = quantize(gz, gyroLsb);
+    return counts;
+}
+
+// One CSV line without the newline: integer counts, or SI floats with six decimals
+inline int formatCsv(const MpuRawCounts& counts, uint8_t ranges, bool si, char* out, size_t capacity) {
+    if (!si) {
+        return snprintf(out, capacity, "%d,%d,%d,%d,%d,%d", counts.ax, counts.ay, counts.az, counts.gx, counts.gy,
+                        counts.gz);
+    }
+    float ax, ay, az, gx, gy, gz;
+    toSI(counts, ranges, ax, ay, az, gx, gy, gz);
+    return snprintf(out, capacity, "%.6f,%.6f,%.6f,%.6f,%.6f,%.6f", ax, ay, az, gx, gy, gz);
+}
+
+} // namespace MpuSample
+
+#endif // MPU_SAMPLE_H
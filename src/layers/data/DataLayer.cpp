@@ -1,22 +1,56 @@
 #include "DataLayer.h"
 #include <Arduino.h> // For Serial debugging and millis()
+#include "../logging/Log.h"
 #include <algorithm>
 
 DataLayer::DataLayer() :
     dataMutex_(nullptr),
     cleanupTask_(nullptr),
+    lastVersion_(0),
+    persistence_(nullptr),
+    persistMutex_(nullptr),
+    notifyNetwork_(nullptr),
+    notifyTask_(nullptr),
+    notifyCoalesceMs_(0),
+    stats_(),
+    lockAcquiredUs_(0),
+    statsNetwork_(nullptr),
+    stopRequested_(false),
+    tasksRunning_(0),
     cleanupIntervalMs_(5000),
     initialized_(false) {
     Serial.println("[DataLayer] Redis-like key-value store created");
 }
 
 DataLayer::~DataLayer() {
+    // Let the tasks finish what they're doing and exit: deleting one that holds the data or
+    // persistence mutex would leave it taken forever
+    stopRequested_.store(true);
+    if (notifyTask_ != nullptr) {
+        xTaskNotifyGive(notifyTask_);
+    }
+    if (cleanupTask_ != nullptr) {
+        xTaskNotifyGive(cleanupTask_);
+    }
+    while (tasksRunning_.load() > 0) {
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+    notifyTask_ = nullptr;
+    cleanupTask_ = nullptr;
+
     if (initialized_) {
-        // Stop the cleanup task
-        if (cleanupTask_ != nullptr) {
-            vTaskDelete(cleanupTask_);
-            cleanupTask_ = nullptr;
+        // Persist whatever is still pending before the store goes away
+        commitPersistence();
+
+        for (auto& pair : streams_) {
+            delete pair.second;
+        }
+        streams_.clear();
+
+        for (auto& pair : hotSlots_) {
+            delete pair.second;
         }
+        hotSlots_.clear();
 
         // Clean up RTOS resources
         if (dataMutex_ != nullptr) {
@@ -24,9 +58,34 @@ DataLayer::~DataLayer() {
             dataMutex_ = nullptr;
         }
 
+        if (persistMutex_ != nullptr) {
+            vSemaphoreDelete(persistMutex_);
+            persistMutex_ = nullptr;
+        }
+
         initialized_ = false;
         Serial.println("[DataLayer] Cleaned up RTOS resources");
     }
+
+    delete persistence_;
+    persistence_ = nullptr;
+}
+
+bool DataLayer::enablePersistence(StorageBackend* storage, const PersistenceConfig& config) {
+    if (initialized_) {
+        Serial.println("[DataLayer] Persistence must be enabled before init()");
+        return false;
+    }
+
+    if (storage == nullptr) {
+        return false;
+    }
+
+    delete persistence_;
+    persistence_ = new PersistenceEngine(storage, config);
+    Serial.printf("[DataLayer] Persistence enabled in %s (commit every %u ms)\n",
+                  config.directory.c_str(), (unsigned)config.commitIntervalMs);
+    return true;
 }
 
 bool DataLayer::init(uint32_t cleanupIntervalMs, UBaseType_t taskPriority, uint32_t taskStackSize) {
@@ -44,7 +103,40 @@ bool DataLayer::init(uint32_t cleanupIntervalMs, UBaseType_t taskPriority, uint3
         return false;
     }
 
+    // Recover persisted state before any task can touch the store
+    if (persistence_ != nullptr) {
+        persistMutex_ = xSemaphoreCreateMutex();
+        if (persistMutex_ == nullptr) {
+            Serial.println("[DataLayer] Failed to create persistence mutex");
+            vSemaphoreDelete(dataMutex_);
+            dataMutex_ = nullptr;
+            return false;
+        }
+
+        uint32_t recoveryStart = getCurrentTimeMs();
+        size_t recovered = 0;
+        bool ok = persistence_->recover([this, recoveryStart](const std::string& key, const uint8_t* data, size_t len) {
+            DataEntry& entry = data_[key];
+            entry.value.assign(data, len);
+            entry.createdTime = recoveryStart;
+            entry.expiryTime = 0;
+            entry.version = ++lastVersion_;
+            entry.persisted = true;
+        }, recovered);
+
+        if (ok) {
+            Serial.printf("[DataLayer] Recovered %u persisted keys in %lu ms\n",
+                          (unsigned)recovered, (unsigned long)(getCurrentTimeMs() - recoveryStart));
+        } else {
+            // Keep running RAM-only rather than failing the whole system
+            Serial.println("[DataLayer] Persistence recovery failed, continuing without persistence");
+            delete persistence_;
+            persistence_ = nullptr;
+        }
+    }
+
     // Create cleanup task
+    tasksRunning_.fetch_add(1);
     BaseType_t result = xTaskCreate(
         cleanupTask,             // Task function
         "DataCleanup",           // Task name
@@ -56,8 +148,14 @@ bool DataLayer::init(uint32_t cleanupIntervalMs, UBaseType_t taskPriority, uint3
 
     if (result != pdPASS) {
         Serial.println("[DataLayer] Failed to create cleanup task");
+        tasksRunning_.fetch_sub(1);
+        cleanupTask_ = nullptr;
         vSemaphoreDelete(dataMutex_);
         dataMutex_ = nullptr;
+        if (persistMutex_ != nullptr) {
+            vSemaphoreDelete(persistMutex_);
+            persistMutex_ = nullptr;
+        }
         return false;
     }
 
@@ -67,32 +165,258 @@ bool DataLayer::init(uint32_t cleanupIntervalMs, UBaseType_t taskPriority, uint3
     return true;
 }
 
+bool DataLayer::enableKeyspaceNotifications(NetworkLayer* network, const std::string& channelPrefix,
+                                            uint32_t coalesceMs, UBaseType_t taskPriority, uint32_t taskStackSize) {
+    if (!initialized_ || network == nullptr) {
+        Serial.println("[DataLayer] Keyspace notifications need an initialized DataLayer and a NetworkLayer");
+        return false;
+    }
+
+    if (notifyTask_ != nullptr) {
+        return true;
+    }
+
+    notifyNetwork_ = network;
+    notifyChannelPrefix_ = channelPrefix;
+    notifyCoalesceMs_ = coalesceMs;
+
+    tasksRunning_.fetch_add(1);
+    BaseType_t result = xTaskCreate(
+        notifyTask,              // Task function
+        "DataNotify",            // Task name
+        taskStackSize,           // Stack size
+        this,                    // Task parameter
+        taskPriority,            // Priority
+        &notifyTask_             // Task handle
+    );
+
+    if (result != pdPASS) {
+        Serial.println("[DataLayer] Failed to create notification task");
+        tasksRunning_.fetch_sub(1);
+        notifyTask_ = nullptr;
+        return false;
+    }
+
+    Serial.printf("[DataLayer] Keyspace notifications on '%s*' (coalesce %u ms)\n",
+                  channelPrefix.c_str(), (unsigned)coalesceMs);
+    return true;
+}
+
+bool DataLayer::watch(const std::string& pattern, const std::string& appName, NetworkLayer::MessageCallback callback) {
+    if (pattern.empty() || notifyNetwork_ == nullptr) {
+        return false;
+    }
+
+    if (!notifyNetwork_->subscribe(notifyChannelPrefix_ + pattern, appName, callback)) {
+        return false;
+    }
+
+    if (!lockData()) {
+        Serial.println("[DataLayer] Failed to take data mutex in watch");
+        return false;
+    }
+    if (std::find(watches_.begin(), watches_.end(), pattern) == watches_.end()) {
+        watches_.push_back(pattern);
+    }
+    unlockData();
+
+    Serial.printf("[DataLayer] %s watching '%s'\n", appName.c_str(), pattern.c_str());
+    return true;
+}
+
+bool DataLayer::unwatch(const std::string& pattern, const std::string& appName) {
+    if (pattern.empty() || notifyNetwork_ == nullptr) {
+        return false;
+    }
+
+    std::string channel = notifyChannelPrefix_ + pattern;
+    notifyNetwork_->unsubscribe(channel, appName);
+
+    // Stop tracking the pattern once nobody listens on its channel
+    if (notifyNetwork_->getSubscriberCount(channel) == 0) {
+        if (!lockData()) {
+            return false;
+        }
+        watches_.erase(std::remove(watches_.begin(), watches_.end(), pattern), watches_.end());
+        unlockData();
+    }
+    return true;
+}
+
 bool DataLayer::set(const std::string& key, const std::vector<uint8_t>& value, uint32_t ttlMs) {
-    if (key.empty() || !initialized_) {
+    return set(key, value.data(), value.size(), ttlMs);
+}
+
+bool DataLayer::set(const std::string& key, const uint8_t* data, size_t len, uint32_t ttlMs) {
+    if (key.empty() || !initialized_ || (data == nullptr && len > 0)) {
         return false;
     }
 
     // Take mutex to protect data
-    if (xSemaphoreTake(dataMutex_, portMAX_DELAY) != pdTRUE) {
+    if (!lockData()) {
         Serial.println("[DataLayer] Failed to take data mutex in set");
         return false;
     }
 
+    bool commitDue = storeLocked(key, data, len, ttlMs, getCurrentTimeMs());
+
+    unlockData();
+
+    if (commitDue) {
+        requestCommit();
+    }
+
+    LOG_DEBUG(DATA, "Set key '%s' with %u bytes, TTL: %u ms", key, len, ttlMs);
+    return true;
+}
+
+bool DataLayer::incrBy(const std::string& key, int64_t delta, int64_t& result, uint32_t ttlMs) {
+    if (key.empty() || !initialized_) {
+        return false;
+    }
+
+    if (!lockData()) {
+        Serial.println("[DataLayer] Failed to take data mutex in incrBy");
+        return false;
+    }
+    bool ok = incrementLocked<int64_t>(key, delta, result, ttlMs);
+    unlockData();
+    return ok;
+}
+
+bool DataLayer::incrByFloat(const std::string& key, double delta, double& result, uint32_t ttlMs) {
+    if (key.empty() || !initialized_) {
+        return false;
+    }
+
+    if (!lockData()) {
+        Serial.println("[DataLayer] Failed to take data mutex in incrByFloat");
+        return false;
+    }
+    bool ok = incrementLocked<double>(key, delta, result, ttlMs);
+    unlockData();
+    return ok;
+}
+
+bool DataLayer::append(const std::string& key, const uint8_t* data, size_t len, size_t& newLen, uint32_t ttlMs) {
+    newLen = 0;
+    if (key.empty() || !initialized_ || (data == nullptr && len > 0)) {
+        return false;
+    }
+
+    if (!lockData()) {
+        Serial.println("[DataLayer] Failed to take data mutex in append");
+        return false;
+    }
+
+    bool created = false;
+    auto it = upsertLocked(key, ttlMs, getCurrentTimeMs(), created);
+    it->second.value.append(data, len);
+    newLen = it->second.value.size();
+    bool commitDue = afterWriteLocked(it);
+
+    unlockData();
+
+    if (commitDue) {
+        requestCommit();
+    }
+    return true;
+}
+
+bool DataLayer::getVersioned(const std::string& key, uint8_t* buffer, size_t capacity, size_t& len,
+                             uint32_t& version) {
+    len = 0;
+    version = 0;
+    if (key.empty() || !initialized_ || buffer == nullptr) {
+        return false;
+    }
+
+    if (!lockData()) {
+        Serial.println("[DataLayer] Failed to take data mutex in getVersioned");
+        return false;
+    }
+
+    auto it = findLiveLocked(key, getCurrentTimeMs());
+    if (it == data_.end()) {
+        stats_.getMisses++;
+        unlockData();
+        return false;
+    }
+
+    stats_.getHits++;
+    len = it->second.value.size();
+    version = it->second.version;
+    bool fits = len <= capacity;
+    if (fits) {
+        memcpy(buffer, it->second.value.data(), len);
+    }
+    unlockData();
+    return fits;
+}
+
+bool DataLayer::compareAndSet(const std::string& key, uint32_t expectedVersion, const uint8_t* data, size_t len,
+                              uint32_t ttlMs, uint32_t* newVersion) {
+    if (key.empty() || !initialized_ || (data == nullptr && len > 0)) {
+        return false;
+    }
+
+    if (!lockData()) {
+        Serial.println("[DataLayer] Failed to take data mutex in compareAndSet");
+        return false;
+    }
+
     uint32_t currentTime = getCurrentTimeMs();
-    DataEntry entry;
-    entry.value = value;
-    entry.createdTime = currentTime;
-    entry.expiryTime = (ttlMs > 0) ? (currentTime + ttlMs) : 0;
+    auto it = findLiveLocked(key, currentTime);
+    uint32_t currentVersion = (it == data_.end()) ? 0 : it->second.version;
+    if (currentVersion != expectedVersion) {
+        unlockData();
+        return false;
+    }
 
-    data_[key] = entry;
+    bool commitDue = storeLocked(key, data, len, ttlMs, currentTime);
+    if (newVersion != nullptr) {
+        *newVersion = data_.find(key)->second.version;
+    }
+    unlockData();
 
-    xSemaphoreGive(dataMutex_);
+    if (commitDue) {
+        requestCommit();
+    }
+    return true;
+}
+
+bool DataLayer::getSet(const std::string& key, const uint8_t* data, size_t len, uint8_t* oldBuffer,
+                       size_t oldCapacity, size_t& oldLen, bool& existed, uint32_t ttlMs) {
+    oldLen = 0;
+    existed = false;
+    if (key.empty() || !initialized_ || (data == nullptr && len > 0)) {
+        return false;
+    }
+
+    if (!lockData()) {
+        Serial.println("[DataLayer] Failed to take data mutex in getSet");
+        return false;
+    }
+
+    uint32_t currentTime = getCurrentTimeMs();
+    auto it = findLiveLocked(key, currentTime);
+    if (it != data_.end()) {
+        existed = true;
+        oldLen = it->second.value.size();
+        if (oldLen > oldCapacity || (oldBuffer == nullptr && oldLen > 0)) {
+            unlockData();
+            return false;
+        }
+        if (oldLen > 0) {
+            memcpy(oldBuffer, it->second.value.data(), oldLen);
+        }
+    }
 
-    // Don't log frequent MPU readings to avoid spam
-    if (key != "mpu/last_reading") {
-        Serial.printf("[DataLayer] Set key '%s' with %d bytes%s\n",
-                      key.c_str(), value.size(),
-                      (ttlMs > 0) ? (", TTL: " + std::to_string(ttlMs) + "ms").c_str() : "");
+    bool commitDue = storeLocked(key, data, len, ttlMs, currentTime);
+    unlockData();
+
+    if (commitDue) {
+        requestCommit();
     }
     return true;
 }
@@ -103,32 +427,78 @@ bool DataLayer::get(const std::string& key, std::vector<uint8_t>& value) {
     }
 
     // Take mutex to protect data
-    if (xSemaphoreTake(dataMutex_, portMAX_DELAY) != pdTRUE) {
+    if (!lockData()) {
         Serial.println("[DataLayer] Failed to take data mutex in get");
         return false;
     }
 
-    auto it = data_.find(key);
+    uint32_t currentTime = getCurrentTimeMs();
+    auto it = findLiveLocked(key, currentTime);
     if (it == data_.end()) {
-        xSemaphoreGive(dataMutex_);
-        return false; // Key doesn't exist
+        HotSlot* slot = findHotSlotLocked(key);
+        if (slot == nullptr) {
+            stats_.getMisses++;
+        } else {
+            stats_.getHits++;
+        }
+        unlockData();
+        if (slot == nullptr) {
+            return false; // Key doesn't exist or expired
+        }
+        value.resize(slot->size());
+        if (!slot->read(value.data(), currentTime)) {
+            value.clear(); // Never written or stale
+            return false;
+        }
+        return true;
     }
 
-    // Check if expired
-    uint32_t currentTime = getCurrentTimeMs();
-    if (it->second.expiryTime > 0 && currentTime >= it->second.expiryTime) {
-        // Key has expired, remove it
-        data_.erase(it);
-        xSemaphoreGive(dataMutex_);
-        Serial.printf("[DataLayer] Key '%s' has expired\n", key.c_str());
+    stats_.getHits++;
+    it->second.value.copyTo(value);
+    unlockData();
+
+    LOG_DEBUG(DATA, "Got key '%s' with %u bytes", key, value.size());
+    return true;
+}
+
+bool DataLayer::get(const std::string& key, uint8_t* buffer, size_t capacity, size_t& len) {
+    len = 0;
+    if (key.empty() || !initialized_ || buffer == nullptr) {
         return false;
     }
 
-    value = it->second.value;
-    xSemaphoreGive(dataMutex_);
+    // Take mutex to protect data
+    if (!lockData()) {
+        Serial.println("[DataLayer] Failed to take data mutex in get");
+        return false;
+    }
 
-    Serial.printf("[DataLayer] Got key '%s' with %d bytes\n", key.c_str(), value.size());
-    return true;
+    uint32_t currentTime = getCurrentTimeMs();
+    auto it = findLiveLocked(key, currentTime);
+    if (it == data_.end()) {
+        HotSlot* slot = findHotSlotLocked(key);
+        if (slot == nullptr) {
+            stats_.getMisses++;
+        } else {
+            stats_.getHits++;
+        }
+        unlockData();
+        if (slot == nullptr) {
+            return false; // Key doesn't exist or expired
+        }
+        len = slot->size();
+        return len <= capacity && slot->read(buffer, currentTime);
+    }
+
+    stats_.getHits++;
+    len = it->second.value.size();
+    bool fits = len <= capacity;
+    if (fits) {
+        memcpy(buffer, it->second.value.data(), len);
+    }
+    unlockData();
+
+    return fits;
 }
 
 bool DataLayer::del(const std::string& key) {
@@ -137,81 +507,302 @@ bool DataLayer::del(const std::string& key) {
     }
 
     // Take mutex to protect data
-    if (xSemaphoreTake(dataMutex_, portMAX_DELAY) != pdTRUE) {
+    if (!lockData()) {
         Serial.println("[DataLayer] Failed to take data mutex in del");
         return false;
     }
 
     auto it = data_.find(key);
     if (it == data_.end()) {
-        xSemaphoreGive(dataMutex_);
+        unlockData();
         return false; // Key doesn't exist
     }
 
-    data_.erase(it);
-    xSemaphoreGive(dataMutex_);
+    eraseLocked(it);
+    unlockData();
 
-    Serial.printf("[DataLayer] Deleted key '%s'\n", key.c_str());
+    LOG_DEBUG(DATA, "Deleted key '%s'", key);
     return true;
 }
 
+size_t DataLayer::mget(GetRequest* requests, size_t count) {
+    if (!initialized_ || requests == nullptr || count == 0) {
+        return 0;
+    }
+
+    // One lock and one timestamp for the whole batch, so the result is a consistent snapshot
+    if (!lockData()) {
+        Serial.println("[DataLayer] Failed to take data mutex in mget");
+        return 0;
+    }
+
+    uint32_t currentTime = getCurrentTimeMs();
+    size_t found = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        GetRequest& request = requests[i];
+        request.len = 0;
+        request.found = false;
+
+        auto it = findLiveLocked(request.key, currentTime);
+        if (it == data_.end()) {
+            stats_.getMisses++;
+            continue;
+        }
+        stats_.getHits++;
+
+        request.len = it->second.value.size();
+        if (request.buffer != nullptr && request.len <= request.capacity) {
+            memcpy(request.buffer, it->second.value.data(), request.len);
+            request.found = true;
+            found++;
+        }
+    }
+
+    unlockData();
+    return found;
+}
+
+size_t DataLayer::mset(const SetRequest* requests, size_t count) {
+    if (!initialized_ || requests == nullptr || count == 0) {
+        return 0;
+    }
+
+    if (!lockData()) {
+        Serial.println("[DataLayer] Failed to take data mutex in mset");
+        return 0;
+    }
+
+    uint32_t currentTime = getCurrentTimeMs();
+    size_t stored = 0;
+    bool commitDue = false;
+
+    for (size_t i = 0; i < count; i++) {
+        const SetRequest& request = requests[i];
+        if (request.key.empty() || (request.data == nullptr && request.len > 0)) {
+            continue;
+        }
+
+        commitDue |= storeLocked(request.key, request.data, request.len, request.ttlMs, currentTime);
+        stored++;
+    }
+
+    unlockData();
+
+    if (commitDue) {
+        requestCommit();
+    }
+    return stored;
+}
+
+size_t DataLayer::mdel(const std::string* keys, size_t count) {
+    if (!initialized_ || keys == nullptr || count == 0) {
+        return 0;
+    }
+
+    if (!lockData()) {
+        Serial.println("[DataLayer] Failed to take data mutex in mdel");
+        return 0;
+    }
+
+    size_t deleted = 0;
+    for (size_t i = 0; i < count; i++) {
+        auto it = data_.find(keys[i]);
+        if (it != data_.end()) {
+            eraseLocked(it);
+            deleted++;
+        }
+    }
+
+    unlockData();
+    return deleted;
+}
+
 bool DataLayer::exists(const std::string& key) {
     if (key.empty() || !initialized_) {
         return false;
     }
 
     // Take mutex to protect data
-    if (xSemaphoreTake(dataMutex_, portMAX_DELAY) != pdTRUE) {
+    if (!lockData()) {
         Serial.println("[DataLayer] Failed to take data mutex in exists");
         return false;
     }
 
-    auto it = data_.find(key);
-    if (it == data_.end()) {
-        xSemaphoreGive(dataMutex_);
-        return false; // Key doesn't exist
+    bool found = findLiveLocked(key, getCurrentTimeMs()) != data_.end();
+    unlockData();
+    return found;
+}
+
+std::vector<std::string> DataLayer::keys(const std::string& prefix) {
+    std::vector<std::string> result;
+    if (!initialized_) {
+        return result;
+    }
+
+    // Take mutex to protect data
+    if (!lockData()) {
+        Serial.println("[DataLayer] Failed to take data mutex in keys");
+        return result;
     }
 
-    // Check if expired
+    // Expired keys are skipped, not erased; removing them is the cleanup task's job
     uint32_t currentTime = getCurrentTimeMs();
-    if (it->second.expiryTime > 0 && currentTime >= it->second.expiryTime) {
-        // Key has expired, remove it
-        data_.erase(it);
-        xSemaphoreGive(dataMutex_);
-        return false;
+    for (auto it = data_.lower_bound(prefix); it != data_.end() && hasPrefix(it->first, prefix); ++it) {
+        if (it->second.expiryTime == 0 || currentTime < it->second.expiryTime) {
+            result.push_back(it->first);
+        }
     }
 
-    xSemaphoreGive(dataMutex_);
-    return true;
+    unlockData();
+    return result;
 }
 
-std::vector<std::string> DataLayer::keys() {
-    if (!initialized_) {
-        return {};
+bool DataLayer::scan(std::string& cursor, const std::string& prefix, size_t count, std::vector<std::string>& out) {
+    out.clear();
+    if (!initialized_ || count == 0) {
+        cursor.clear();
+        return false;
     }
 
-    // Take mutex to protect data
-    if (xSemaphoreTake(dataMutex_, portMAX_DELAY) != pdTRUE) {
-        Serial.println("[DataLayer] Failed to take data mutex in keys");
-        return {};
+    if (!lockData()) {
+        Serial.println("[DataLayer] Failed to take data mutex in scan");
+        return false;
     }
 
-    std::vector<std::string> result;
+    // The cursor is the last key returned, so keys added or removed between pages
+    // never cause a live key to be skipped or repeated
+    auto it = (cursor.empty() || cursor < prefix) ? data_.lower_bound(prefix) : data_.upper_bound(cursor);
     uint32_t currentTime = getCurrentTimeMs();
 
-    for (auto it = data_.begin(); it != data_.end(); ) {
-        // Check if expired
-        if (it->second.expiryTime > 0 && currentTime >= it->second.expiryTime) {
-            // Remove expired key
-            it = data_.erase(it);
-        } else {
-            result.push_back(it->first);
-            ++it;
+    while (it != data_.end() && hasPrefix(it->first, prefix) && out.size() < count) {
+        if (it->second.expiryTime == 0 || currentTime < it->second.expiryTime) {
+            out.push_back(it->first);
         }
+        cursor = it->first;
+        ++it;
     }
 
-    xSemaphoreGive(dataMutex_);
-    return result;
+    bool more = it != data_.end() && hasPrefix(it->first, prefix);
+    unlockData();
+
+    if (!more) {
+        cursor.clear();
+    }
+    return more;
+}
+
+DataStream* DataLayer::createStream(const std::string& key, size_t recordSize, size_t capacity, bool usePsram) {
+    if (key.empty() || !initialized_) {
+        return nullptr;
+    }
+
+    if (!lockData()) {
+        Serial.println("[DataLayer] Failed to take data mutex in createStream");
+        return nullptr;
+    }
+
+    // Re-creating with the same shape returns the existing stream
+    auto it = streams_.find(key);
+    if (it != streams_.end()) {
+        DataStream* existing = it->second;
+        unlockData();
+        if (existing->recordSize() != recordSize || existing->capacity() != capacity) {
+            Serial.printf("[DataLayer] Stream '%s' already exists with a different shape\n", key.c_str());
+            return nullptr;
+        }
+        return existing;
+    }
+    unlockData();
+
+    // Allocate outside the lock, the block may be large
+    DataStream* stream = new DataStream(recordSize, capacity, usePsram);
+    if (!stream->isValid()) {
+        delete stream;
+        return nullptr;
+    }
+
+    if (!lockData()) {
+        delete stream;
+        return nullptr;
+    }
+    auto inserted = streams_.emplace(key, stream);
+    if (!inserted.second) {
+        // Lost a race with another creator
+        delete stream;
+        stream = inserted.first->second;
+    }
+    unlockData();
+
+    Serial.printf("[DataLayer] Stream '%s' created: %u records x %u bytes%s\n", key.c_str(),
+                  (unsigned)capacity, (unsigned)recordSize, usePsram ? " (PSRAM)" : "");
+    return stream;
+}
+
+DataStream* DataLayer::getStream(const std::string& key) {
+    if (key.empty() || !initialized_) {
+        return nullptr;
+    }
+
+    if (!lockData()) {
+        return nullptr;
+    }
+
+    auto it = streams_.find(key);
+    DataStream* stream = (it != streams_.end()) ? it->second : nullptr;
+    unlockData();
+    return stream;
+}
+
+HotSlot* DataLayer::registerHotSlot(const std::string& key, size_t size, uint32_t ttlMs) {
+    if (key.empty() || !initialized_ || size == 0 || size > HotSlot::MAX_SIZE) {
+        return nullptr;
+    }
+
+    if (!lockData()) {
+        Serial.println("[DataLayer] Failed to take data mutex in registerHotSlot");
+        return nullptr;
+    }
+
+    // Registering the same key again returns the existing slot if the size matches
+    HotSlot* slot = findHotSlotLocked(key);
+    if (slot == nullptr) {
+        slot = new HotSlot(size, ttlMs);
+        hotSlots_.emplace(key, slot);
+    } else if (slot->size() != size) {
+        slot = nullptr;
+    }
+    unlockData();
+
+    if (slot == nullptr) {
+        Serial.printf("[DataLayer] Hot slot '%s' already exists with a different size\n", key.c_str());
+    } else {
+        Serial.printf("[DataLayer] Hot slot '%s' registered: %u bytes\n", key.c_str(), (unsigned)size);
+    }
+    return slot;
+}
+
+HotSlot* DataLayer::getHotSlot(const std::string& key) {
+    if (key.empty() || !initialized_) {
+        return nullptr;
+    }
+
+    if (!lockData()) {
+        return nullptr;
+    }
+    HotSlot* slot = findHotSlotLocked(key);
+    unlockData();
+    return slot;
+}
+
+HotSlot* DataLayer::findHotSlotLocked(const std::string& key) {
+    auto it = hotSlots_.find(key);
+    return (it != hotSlots_.end()) ? it->second : nullptr;
+}
+
+bool DataLayer::xadd(const std::string& key, uint64_t timestamp, const uint8_t* record) {
+    DataStream* stream = getStream(key);
+    return stream != nullptr && stream->append(timestamp, record);
 }
 
 bool DataLayer::expire(const std::string& key, uint32_t ttlMs) {
@@ -220,23 +811,29 @@ bool DataLayer::expire(const std::string& key, uint32_t ttlMs) {
     }
 
     // Take mutex to protect data
-    if (xSemaphoreTake(dataMutex_, portMAX_DELAY) != pdTRUE) {
+    if (!lockData()) {
         Serial.println("[DataLayer] Failed to take data mutex in expire");
         return false;
     }
 
     auto it = data_.find(key);
     if (it == data_.end()) {
-        xSemaphoreGive(dataMutex_);
+        unlockData();
         return false; // Key doesn't exist
     }
 
     uint32_t currentTime = getCurrentTimeMs();
     it->second.expiryTime = currentTime + ttlMs;
 
-    xSemaphoreGive(dataMutex_);
+    // A key with a TTL is volatile; remove it from flash
+    if (it->second.persisted && persistence_ != nullptr) {
+        persistence_->logDel(key);
+        it->second.persisted = false;
+    }
+
+    unlockData();
 
-    Serial.printf("[DataLayer] Set TTL for key '%s' to %d ms\n", key.c_str(), ttlMs);
+    LOG_DEBUG(DATA, "Set TTL for key '%s' to %u ms", key, ttlMs);
     return true;
 }
 
@@ -246,53 +843,101 @@ int32_t DataLayer::ttl(const std::string& key) {
     }
 
     // Take mutex to protect data
-    if (xSemaphoreTake(dataMutex_, portMAX_DELAY) != pdTRUE) {
+    if (!lockData()) {
         Serial.println("[DataLayer] Failed to take data mutex in ttl");
         return -2;
     }
 
-    auto it = data_.find(key);
-    if (it == data_.end()) {
-        xSemaphoreGive(dataMutex_);
-        return -2; // Key doesn't exist
-    }
-
-    // Check if expired
     uint32_t currentTime = getCurrentTimeMs();
-    if (it->second.expiryTime > 0 && currentTime >= it->second.expiryTime) {
-        // Key has expired, remove it
-        data_.erase(it);
-        xSemaphoreGive(dataMutex_);
-        return -2; // Key doesn't exist (expired)
+    auto it = findLiveLocked(key, currentTime);
+    if (it == data_.end()) {
+        unlockData();
+        return -2; // Key doesn't exist (or expired)
     }
 
     if (it->second.expiryTime == 0) {
-        xSemaphoreGive(dataMutex_);
+        unlockData();
         return -1; // No TTL set
     }
 
     int32_t remaining = it->second.expiryTime - currentTime;
-    xSemaphoreGive(dataMutex_);
+    unlockData();
 
     return remaining;
 }
 
+bool DataLayer::flush() {
+    if (!initialized_) {
+        return false;
+    }
+    return commitPersistence();
+}
+
 size_t DataLayer::size() const {
     if (!initialized_) {
         return 0;
     }
 
     // Take mutex to protect data
-    if (xSemaphoreTake(dataMutex_, portMAX_DELAY) != pdTRUE) {
+    if (!lockData()) {
         return 0;
     }
 
     size_t count = data_.size();
-    xSemaphoreGive(dataMutex_);
+    unlockData();
 
     return count;
 }
 
+DataLayer::Stats DataLayer::stats() {
+    Stats snapshot = Stats();
+    if (!initialized_ || !lockData()) {
+        return snapshot;
+    }
+
+    snapshot = stats_;
+    snapshot.keys = data_.size();
+    for (const auto& pair : data_) {
+        snapshot.keyBytes += pair.first.size();
+        snapshot.valueBytes += pair.second.value.size();
+        if (!pair.second.value.isInline()) {
+            snapshot.heapValueBytes += pair.second.value.size();
+        }
+    }
+
+    snapshot.streams = streams_.size();
+    for (const auto& pair : streams_) {
+        snapshot.streamBytes += pair.second->capacity() * (pair.second->recordSize() + sizeof(uint64_t));
+    }
+    snapshot.hotSlots = hotSlots_.size();
+
+    unlockData();
+    return snapshot;
+}
+
+void DataLayer::resetStats() {
+    if (!initialized_ || !lockData()) {
+        return;
+    }
+    stats_ = Stats();
+    unlockData();
+}
+
+bool DataLayer::publishStats(NetworkLayer* network, const std::string& topic) {
+    if (network == nullptr || topic.empty()) {
+        return false;
+    }
+
+    Stats snapshot = stats();
+    return network->publish(topic, reinterpret_cast<const uint8_t*>(&snapshot), sizeof(snapshot), "DataLayer");
+}
+
+void DataLayer::enableStatsPublishing(NetworkLayer* network, const std::string& topic) {
+    // Read by the cleanup task; set once at startup
+    statsTopic_ = topic;
+    statsNetwork_ = network;
+}
+
 // RTOS Task function - runs periodically to clean up expired data
 void DataLayer::cleanupTask(void* parameter) {
     DataLayer* dataLayer = static_cast<DataLayer*>(parameter);
@@ -303,13 +948,36 @@ void DataLayer::cleanupTask(void* parameter) {
 
     Serial.println("[DataLayer] Cleanup task started");
 
+    // With persistence the task also runs group commits, so wake at whichever is sooner
+    uint32_t waitMs = dataLayer->cleanupIntervalMs_;
+    if (dataLayer->persistence_ != nullptr) {
+        waitMs = std::min(waitMs, dataLayer->persistence_->config().commitIntervalMs);
+    }
+
+    uint32_t lastCleanupTime = dataLayer->getCurrentTimeMs();
+
     while (true) {
-        // Wait for cleanup interval
-        vTaskDelay(pdMS_TO_TICKS(dataLayer->cleanupIntervalMs_));
+        // Sleep until the next interval, or until a writer fills the commit buffer
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(waitMs));
+        if (dataLayer->stopRequested_.load()) {
+            break; // The destructor runs the final commit
+        }
+
+        uint32_t currentTime = dataLayer->getCurrentTimeMs();
+        if (currentTime - lastCleanupTime >= dataLayer->cleanupIntervalMs_) {
+            dataLayer->performCleanup();
+            lastCleanupTime = currentTime;
+
+            if (dataLayer->statsNetwork_ != nullptr) {
+                dataLayer->publishStats(dataLayer->statsNetwork_, dataLayer->statsTopic_);
+            }
+        }
 
-        // Perform cleanup
-        dataLayer->performCleanup();
+        dataLayer->commitPersistence();
     }
+
+    dataLayer->tasksRunning_.fetch_sub(1);
+    vTaskDelete(nullptr);
 }
 
 // Internal cleanup function
@@ -318,8 +986,10 @@ void DataLayer::performCleanup() {
         return;
     }
 
+    uint32_t passStart = micros();
+
     // Take mutex to protect data
-    if (xSemaphoreTake(dataMutex_, portMAX_DELAY) != pdTRUE) {
+    if (!lockData()) {
         Serial.println("[DataLayer] Failed to take data mutex in performCleanup");
         return;
     }
@@ -330,7 +1000,8 @@ void DataLayer::performCleanup() {
     for (auto it = data_.begin(); it != data_.end(); ) {
         // Check if expired
         if (it->second.expiryTime > 0 && currentTime >= it->second.expiryTime) {
-            Serial.printf("[DataLayer] Cleanup: Removing expired key '%s'\n", it->first.c_str());
+            LOG_DEBUG(DATA, "Cleanup: Removing expired key '%s'", it->first);
+            notifyLocked(it->first, EVENT_EXPIRED, nullptr, 0);
             it = data_.erase(it);
             removed++;
         } else {
@@ -338,10 +1009,309 @@ void DataLayer::performCleanup() {
         }
     }
 
-    xSemaphoreGive(dataMutex_);
+    uint32_t passUs = micros() - passStart;
+    stats_.evicted += removed;
+    stats_.cleanupRuns++;
+    stats_.cleanupLastUs = passUs;
+    stats_.cleanupMaxUs = std::max(stats_.cleanupMaxUs, passUs);
+
+    unlockData();
 
     if (removed > 0) {
-        Serial.printf("[DataLayer] Cleanup completed, removed %d expired keys\n", removed);
+        LOG_INFO(DATA, "Cleanup completed, removed %u expired keys in %u us", removed, passUs);
+    }
+}
+
+bool DataLayer::lockData() const {
+    uint32_t waitStart = micros();
+    if (xSemaphoreTake(dataMutex_, portMAX_DELAY) != pdTRUE) {
+        return false;
+    }
+
+    // Only the holder touches the timing fields
+    lockAcquiredUs_ = micros();
+    uint32_t waitUs = lockAcquiredUs_ - waitStart;
+    stats_.lockAcquisitions++;
+    stats_.lockWaitUs[latencyBucket(waitUs)]++;
+    stats_.lockWaitMaxUs = std::max(stats_.lockWaitMaxUs, waitUs);
+    return true;
+}
+
+void DataLayer::unlockData() const {
+    uint32_t holdUs = micros() - lockAcquiredUs_;
+    stats_.lockHoldUs[latencyBucket(holdUs)]++;
+    stats_.lockHoldMaxUs = std::max(stats_.lockHoldMaxUs, holdUs);
+    xSemaphoreGive(dataMutex_);
+}
+
+size_t DataLayer::latencyBucket(uint32_t us) {
+    if (us == 0) {
+        return 0;
+    }
+    size_t bucket = 32 - __builtin_clz(us);
+    return std::min(bucket, LATENCY_BUCKETS - 1);
+}
+
+// Write or overwrite an entry; caller holds dataMutex_. Returns true when a group commit is due.
+bool DataLayer::storeLocked(const std::string& key, const uint8_t* data, size_t len, uint32_t ttlMs,
+                            uint32_t currentTime) {
+    // Overwrite in place so existing keys reuse their entry (and inline buffer)
+    auto it = data_.find(key);
+    if (it == data_.end()) {
+        it = data_.emplace(key, DataEntry()).first;
+        it->second.version = 0;
+        it->second.persisted = false;
+    }
+
+    DataEntry& entry = it->second;
+    entry.value.assign(data, len);
+    entry.createdTime = currentTime;
+    entry.expiryTime = (ttlMs > 0) ? (currentTime + ttlMs) : 0;
+
+    return afterWriteLocked(it);
+}
+
+// Find a live key for read-modify-write, creating an empty entry (with ttlMs) if missing
+DataLayer::DataMap::iterator DataLayer::upsertLocked(const std::string& key, uint32_t ttlMs, uint32_t currentTime,
+                                                     bool& created) {
+    auto it = findLiveLocked(key, currentTime);
+    created = (it == data_.end());
+    if (created) {
+        it = data_.emplace(key, DataEntry()).first;
+        it->second.createdTime = currentTime;
+        it->second.expiryTime = (ttlMs > 0) ? (currentTime + ttlMs) : 0;
+        it->second.version = 0;
+        it->second.persisted = false;
+    }
+    return it;
+}
+
+// Bookkeeping after an entry's value changed in place: version, notifications, persistence.
+// Returns true when a group commit is due. Caller holds dataMutex_.
+bool DataLayer::afterWriteLocked(DataMap::iterator it) {
+    DataEntry& entry = it->second;
+    // Store-wide stamp: a deleted and recreated key never repeats a version a reader may hold
+    if (++lastVersion_ == 0) {
+        lastVersion_ = 1; // 0 means "no key" to compareAndSet
+    }
+    entry.version = lastVersion_;
+    stats_.sets++;
+    notifyLocked(it->first, EVENT_SET, entry.value.data(), entry.value.size());
+
+    if (persistence_ == nullptr) {
+        return false;
+    }
+
+    bool wasPersisted = entry.persisted;
+    entry.persisted = persistence_->shouldPersist(it->first, entry.expiryTime != 0);
+    if (entry.persisted) {
+        persistence_->logSet(it->first, entry.value.data(), entry.value.size());
+    } else if (wasPersisted) {
+        // Key turned volatile; drop it from flash so it isn't resurrected
+        persistence_->logDel(it->first);
+    }
+    return persistence_->pendingBytes() >= persistence_->config().commitThresholdBytes;
+}
+
+template <typename T>
+bool DataLayer::incrementLocked(const std::string& key, T delta, T& result, uint32_t ttlMs) {
+    bool created = false;
+    auto it = upsertLocked(key, ttlMs, getCurrentTimeMs(), created);
+    InlineValue& value = it->second.value;
+
+    T current = 0;
+    if (!created && value.size() != sizeof(T)) {
+        return false; // Not a counter of this type
+    }
+    if (!created) {
+        memcpy(&current, value.data(), sizeof(T));
+    }
+
+    result = current + delta;
+    value.assign(reinterpret_cast<const uint8_t*>(&result), sizeof(T));
+    if (afterWriteLocked(it)) {
+        requestCommit();
+    }
+    return true;
+}
+
+// Look up a key, lazily erasing it if expired; caller holds dataMutex_
+DataLayer::DataMap::iterator DataLayer::findLiveLocked(const std::string& key, uint32_t currentTime) {
+    auto it = data_.find(key);
+    if (it != data_.end() && it->second.expiryTime > 0 && currentTime >= it->second.expiryTime) {
+        notifyLocked(it->first, EVENT_EXPIRED, nullptr, 0);
+        data_.erase(it);
+        stats_.expired++;
+        return data_.end();
+    }
+    return it;
+}
+
+// Remove an entry, logging the delete if it was persisted; caller holds dataMutex_
+void DataLayer::eraseLocked(DataMap::iterator it) {
+    if (it->second.persisted && persistence_ != nullptr) {
+        persistence_->logDel(it->first);
+    }
+    notifyLocked(it->first, EVENT_DEL, nullptr, 0);
+    data_.erase(it);
+    stats_.dels++;
+}
+
+// Queue a keyspace event for watched keys; only the latest event per key survives
+// until the next dispatch. Caller holds dataMutex_.
+void DataLayer::notifyLocked(const std::string& key, KeyspaceEvent event, const uint8_t* data, size_t len) {
+    if (watches_.empty()) {
+        return;
+    }
+
+    bool watched = false;
+    for (const auto& pattern : watches_) {
+        if (matchesPattern(pattern, key)) {
+            watched = true;
+            break;
+        }
+    }
+    if (!watched) {
+        return;
+    }
+
+    bool wasIdle = pendingNotifications_.empty();
+    PendingNotification& pending = pendingNotifications_[key];
+    pending.event = event;
+    pending.value.assign(data, len);
+
+    if (wasIdle && notifyTask_ != nullptr) {
+        xTaskNotifyGive(notifyTask_);
+    }
+}
+
+bool DataLayer::hasPrefix(const std::string& key, const std::string& prefix) {
+    return key.compare(0, prefix.size(), prefix) == 0;
+}
+
+bool DataLayer::matchesPattern(const std::string& pattern, const std::string& key) {
+    // "prefix*" matches by prefix, anything else is an exact key
+    if (!pattern.empty() && pattern[pattern.size() - 1] == '*') {
+        return key.compare(0, pattern.size() - 1, pattern, 0, pattern.size() - 1) == 0;
+    }
+    return pattern == key;
+}
+
+// Publish coalesced keyspace events; runs on the notification task
+void DataLayer::dispatchNotifications() {
+    std::unordered_map<std::string, PendingNotification> batch;
+    std::vector<std::string> patterns;
+
+    if (!lockData()) {
+        return;
+    }
+    batch.swap(pendingNotifications_);
+    patterns = watches_;
+    unlockData();
+
+    // Payload: event(1) keyLen(1) key value
+    for (const auto& pair : batch) {
+        const std::string& key = pair.first;
+        size_t keyLen = std::min(key.size(), (size_t)255);
+
+        notifyPayload_.clear();
+        notifyPayload_.push_back(pair.second.event);
+        notifyPayload_.push_back(keyLen);
+        notifyPayload_.insert(notifyPayload_.end(), key.begin(), key.begin() + keyLen);
+        notifyPayload_.insert(notifyPayload_.end(), pair.second.value.data(),
+                              pair.second.value.data() + pair.second.value.size());
+
+        for (const auto& pattern : patterns) {
+            if (matchesPattern(pattern, key)) {
+                notifyNetwork_->publish(notifyChannelPrefix_ + pattern, notifyPayload_.data(),
+                                        notifyPayload_.size(), "DataLayer");
+            }
+        }
+    }
+}
+
+void DataLayer::notifyTask(void* parameter) {
+    DataLayer* dataLayer = static_cast<DataLayer*>(parameter);
+    if (dataLayer == nullptr) {
+        vTaskDelete(nullptr);
+        return;
+    }
+
+    while (true) {
+        // Sleep until the first event of a window, then let the window fill up
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (dataLayer->stopRequested_.load()) {
+            break;
+        }
+        if (dataLayer->notifyCoalesceMs_ > 0) {
+            vTaskDelay(pdMS_TO_TICKS(dataLayer->notifyCoalesceMs_));
+        }
+        dataLayer->dispatchNotifications();
+    }
+
+    dataLayer->tasksRunning_.fetch_sub(1);
+    vTaskDelete(nullptr);
+}
+
+// Write pending log records in one batch, compacting into a snapshot when the log grows
+bool DataLayer::commitPersistence() {
+    if (persistence_ == nullptr || persistMutex_ == nullptr) {
+        return true;
+    }
+
+    // Serializes file I/O; the data mutex is only held while swapping buffers
+    if (xSemaphoreTake(persistMutex_, portMAX_DELAY) != pdTRUE) {
+        Serial.println("[DataLayer] Failed to take persistence mutex");
+        return false;
+    }
+
+    if (!lockData()) {
+        xSemaphoreGive(persistMutex_);
+        return false;
+    }
+    persistence_->takePending(commitBatch_);
+    unlockData();
+
+    bool ok = persistence_->commit(commitBatch_);
+    if (!ok) {
+        // Retry on the next commit window rather than losing the batch
+        if (lockData()) {
+            persistence_->restorePending(commitBatch_);
+            unlockData();
+        }
+    } else if (persistence_->needsCompaction()) {
+        std::vector<uint8_t> snapshot;
+
+        if (lockData()) {
+            persistence_->beginSnapshot(snapshot);
+            for (const auto& pair : data_) {
+                if (pair.second.persisted) {
+                    persistence_->addSnapshotEntry(snapshot, pair.first, pair.second.value.data(),
+                                                   pair.second.value.size());
+                }
+            }
+            // Everything pending is already reflected in the snapshot, but stays in hand until
+            // the snapshot has landed
+            persistence_->takePending(commitBatch_);
+            unlockData();
+
+            ok = persistence_->writeSnapshot(snapshot);
+            if (!ok && lockData()) {
+                // Still only in RAM: log them on the next commit window
+                persistence_->restorePending(commitBatch_);
+                unlockData();
+            }
+        }
+    }
+
+    commitBatch_.clear();
+    xSemaphoreGive(persistMutex_);
+    return ok;
+}
+
+void DataLayer::requestCommit() {
+    if (cleanupTask_ != nullptr) {
+        xTaskNotifyGive(cleanupTask_);
     }
 }
 
@@ -2,28 +2,126 @@
 #define DATA_LAYER_H
 
 #include <cstdint>
+#include <atomic>
 #include <vector>
 #include <string>
 #include <unordered_map>
+#include <map>
+#include <type_traits>
 #include <freertos/FreeRTOS.h>
 #include <freertos/queue.h>
 #include <freertos/task.h>
 #include <freertos/semphr.h>
+#include "InlineValue.h"
+#include "DataStream.h"
+#include "HotSlot.h"
+#include "../network/NetworkLayer.h"
+#include "persistence/PersistenceEngine.h"
 
 class DataLayer {
 public:
     DataLayer();
     ~DataLayer();
 
+    // Optional persistence; call before init() so state is recovered at startup
+    bool enablePersistence(StorageBackend* storage, const PersistenceConfig& config = PersistenceConfig());
+
     // Initialize with cleanup interval (default 5 seconds)
     bool init(uint32_t cleanupIntervalMs = 5000, UBaseType_t taskPriority = 1, uint32_t taskStackSize = 2048);
 
+    // Keyspace notifications (opt-in). Watchers register an exact key or a "prefix*" pattern and
+    // receive events on channel "<channelPrefix><pattern>" with payload
+    // event(1) keyLen(1) key value. Events are coalesced per key over coalesceMs,
+    // so a fast writer produces at most one notification per window.
+    enum KeyspaceEvent : uint8_t {
+        EVENT_SET = 1,
+        EVENT_DEL = 2,
+        EVENT_EXPIRED = 3
+    };
+
+    bool enableKeyspaceNotifications(NetworkLayer* network, const std::string& channelPrefix = "keyspace/",
+                                     uint32_t coalesceMs = 50, UBaseType_t taskPriority = 1,
+                                     uint32_t taskStackSize = 4096);
+    bool watch(const std::string& pattern, const std::string& appName, NetworkLayer::MessageCallback callback);
+    bool unwatch(const std::string& pattern, const std::string& appName);
+
     // Basic operations
     bool set(const std::string& key, const std::vector<uint8_t>& value, uint32_t ttlMs = 0);
+    bool set(const std::string& key, const uint8_t* data, size_t len, uint32_t ttlMs = 0);
     bool get(const std::string& key, std::vector<uint8_t>& value);
+    // Copies into caller storage; len receives the stored size, false if missing or capacity too small
+    bool get(const std::string& key, uint8_t* buffer, size_t capacity, size_t& len);
     bool del(const std::string& key);
     bool exists(const std::string& key);
-    std::vector<std::string> keys();
+    std::vector<std::string> keys(const std::string& prefix = "");
+
+    // Cursor-based iteration over live keys starting with prefix, in key order.
+    // Start with an empty cursor; each call fills out with up to count keys under one short
+    // lock and advances the cursor. Returns false (and clears the cursor) once iteration is done.
+    bool scan(std::string& cursor, const std::string& prefix, size_t count, std::vector<std::string>& out);
+
+    // Batch operations: one lock acquisition and one timestamp for the whole batch.
+    // Results go into caller-provided storage, so a multi-key read is an atomic snapshot.
+    struct GetRequest {
+        std::string key;
+        uint8_t* buffer;     // Caller storage for the value
+        size_t capacity;
+        size_t len;          // Out: stored value size (also set when it didn't fit)
+        bool found;          // Out: key present, not expired and copied
+    };
+
+    struct SetRequest {
+        std::string key;
+        const uint8_t* data;
+        size_t len;
+        uint32_t ttlMs;
+    };
+
+    size_t mget(GetRequest* requests, size_t count);        // Returns number of keys found
+    size_t mset(const SetRequest* requests, size_t count);  // Returns number of keys stored
+    size_t mdel(const std::string* keys, size_t count);     // Returns number of keys deleted
+
+    // Atomic read-modify-write: each runs under one lock acquisition and modifies the entry in place.
+    // Every write stamps the entry with a new version from a store-wide counter, so a deleted and
+    // recreated key never repeats a stamp; ttlMs only applies when the key is created, existing
+    // keys keep their TTL.
+    bool incrBy(const std::string& key, int64_t delta, int64_t& result, uint32_t ttlMs = 0);    // int64 value
+    bool incrByFloat(const std::string& key, double delta, double& result, uint32_t ttlMs = 0); // double value
+    bool append(const std::string& key, const uint8_t* data, size_t len, size_t& newLen, uint32_t ttlMs = 0);
+    bool getVersioned(const std::string& key, uint8_t* buffer, size_t capacity, size_t& len, uint32_t& version);
+    // Writes only if the entry's version still equals expectedVersion (0 = key must not exist)
+    bool compareAndSet(const std::string& key, uint32_t expectedVersion, const uint8_t* data, size_t len,
+                       uint32_t ttlMs = 0, uint32_t* newVersion = nullptr);
+    // Stores the new value and returns the previous one; fails untouched if the old value doesn't fit
+    bool getSet(const std::string& key, const uint8_t* data, size_t len, uint8_t* oldBuffer, size_t oldCapacity,
+                size_t& oldLen, bool& existed, uint32_t ttlMs = 0);
+
+    // Typed accessors for trivially copyable scalars/structs (stored as raw bytes)
+    template <typename T>
+    bool setValue(const std::string& key, const T& value, uint32_t ttlMs = 0) {
+        static_assert(std::is_trivially_copyable<T>::value, "setValue requires a trivially copyable type");
+        return set(key, reinterpret_cast<const uint8_t*>(&value), sizeof(T), ttlMs);
+    }
+
+    template <typename T>
+    bool getValue(const std::string& key, T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "getValue requires a trivially copyable type");
+        size_t len = 0;
+        return get(key, reinterpret_cast<uint8_t*>(&value), sizeof(T), len) && len == sizeof(T);
+    }
+
+    // Streams (XADD/XRANGE-like time series). Streams live in their own namespace, have their
+    // own lock and stay alive until the DataLayer is destroyed, so consumers may cache the pointer.
+    DataStream* createStream(const std::string& key, size_t recordSize, size_t capacity, bool usePsram = false);
+    DataStream* getStream(const std::string& key);
+    bool xadd(const std::string& key, uint64_t timestamp, const uint8_t* record);
+
+    // Hot slots: fixed-size values with a single writer, stored in a seqlock. The owner writes
+    // through the returned pointer without locking; readers use HotSlot::read() directly or
+    // fall back to get(). Slots bypass notifications and persistence and live until the
+    // DataLayer is destroyed. ttlMs > 0 makes a reading stale once it is older than that.
+    HotSlot* registerHotSlot(const std::string& key, size_t size, uint32_t ttlMs = 0);
+    HotSlot* getHotSlot(const std::string& key);
 
     // TTL operations
     bool expire(const std::string& key, uint32_t ttlMs);
@@ -32,11 +130,60 @@ public:
     // Statistics
     size_t size() const;
 
+    // Observability. Counters and histograms are updated under dataMutex_ and cost a few
+    // increments per operation. Lock histograms use log2 microsecond buckets: [0] < 1 us,
+    // [i] 2^(i-1)..2^i - 1 us, the last bucket is open-ended. Hold time covers the whole
+    // critical section, so it doubles as per-operation latency.
+    static const size_t LATENCY_BUCKETS = 16;
+
+    struct Stats {
+        // Operation counters
+        uint32_t getHits;        // get/mget/getVersioned found the key (hot slot fallback included)
+        uint32_t getMisses;
+        uint32_t sets;           // Every write: set, mset, incr, append, cas, getSet
+        uint32_t dels;           // Explicit del/mdel
+        uint32_t expired;        // Expired keys found lazily on access
+        uint32_t evicted;        // Expired keys removed by the cleanup pass
+
+        // Memory footprint (computed when stats() is called)
+        uint32_t keys;
+        uint32_t keyBytes;
+        uint32_t valueBytes;
+        uint32_t heapValueBytes; // Part of valueBytes that did not fit inline
+        uint32_t streams;
+        uint32_t streamBytes;    // Preallocated ring storage
+        uint32_t hotSlots;
+
+        // dataMutex_ contention
+        uint32_t lockAcquisitions;
+        uint32_t lockWaitMaxUs;
+        uint32_t lockHoldMaxUs;
+        uint32_t lockWaitUs[LATENCY_BUCKETS];
+        uint32_t lockHoldUs[LATENCY_BUCKETS];
+
+        // Cleanup task
+        uint32_t cleanupRuns;
+        uint32_t cleanupLastUs;
+        uint32_t cleanupMaxUs;
+    };
+
+    Stats stats();
+    void resetStats(); // Clears counters and histograms, not the footprint
+    // Publishes the Stats struct as raw bytes (all uint32_t, little-endian, no padding)
+    bool publishStats(NetworkLayer* network, const std::string& topic = "diagnostics/datalayer");
+    // Publish stats after every cleanup pass
+    void enableStatsPublishing(NetworkLayer* network, const std::string& topic = "diagnostics/datalayer");
+
+    // Force pending persistence records to flash (e.g. before sleep or restart)
+    bool flush();
+
 private:
     struct DataEntry {
-        std::vector<uint8_t> value;
+        InlineValue value;   // Inline up to DATA_LAYER_INLINE_VALUE_SIZE bytes
         uint32_t expiryTime; // 0 means no expiry
         uint32_t createdTime;
+        uint32_t version;    // Store-wide write stamp, unique per write, for compare-and-set
+        bool persisted;      // Mirrored in the persistence log
     };
 
     // RTOS resources
@@ -44,7 +191,40 @@ private:
     TaskHandle_t cleanupTask_;
 
     // Data storage
-    std::unordered_map<std::string, DataEntry> data_;
+    // Ordered so prefix lookups (led/2/*, mpu/*) only touch matching keys
+    using DataMap = std::map<std::string, DataEntry>;
+    DataMap data_;
+    uint32_t lastVersion_; // Last stamp handed out; guarded by dataMutex_
+    std::unordered_map<std::string, DataStream*> streams_; // Guarded by dataMutex_
+    std::unordered_map<std::string, HotSlot*> hotSlots_;   // Guarded by dataMutex_
+
+    // Persistence (optional)
+    PersistenceEngine* persistence_;
+    SemaphoreHandle_t persistMutex_;
+    std::vector<uint8_t> commitBatch_;
+
+    // Keyspace notifications (optional)
+    struct PendingNotification {
+        KeyspaceEvent event;
+        InlineValue value;
+    };
+    NetworkLayer* notifyNetwork_;
+    TaskHandle_t notifyTask_;
+    std::string notifyChannelPrefix_;
+    uint32_t notifyCoalesceMs_;
+    std::vector<std::string> watches_;                                          // Guarded by dataMutex_
+    std::unordered_map<std::string, PendingNotification> pendingNotifications_; // Guarded by dataMutex_
+    std::vector<uint8_t> notifyPayload_;
+
+    // Statistics; counters guarded by dataMutex_, mutable so const readers can time the lock
+    mutable Stats stats_;
+    mutable uint32_t lockAcquiredUs_;
+    NetworkLayer* statsNetwork_;
+    std::string statsTopic_;
+
+    // Shutdown: tasks exit on their own once asked, the destructor waits for them
+    std::atomic<bool> stopRequested_;
+    std::atomic<int> tasksRunning_;
 
     // Configuration
     uint32_t cleanupIntervalMs_;
@@ -52,9 +232,32 @@ private:
 
     // RTOS task function
     static void cleanupTask(void* parameter);
+    static void notifyTask(void* parameter);
 
     // Internal cleanup
     void performCleanup();
+    bool commitPersistence();
+
+    // dataMutex_ take/give with wait and hold timing
+    bool lockData() const;
+    void unlockData() const;
+    static size_t latencyBucket(uint32_t us);
+
+    // Helpers for callers already holding dataMutex_
+    bool storeLocked(const std::string& key, const uint8_t* data, size_t len, uint32_t ttlMs, uint32_t currentTime);
+    DataMap::iterator upsertLocked(const std::string& key, uint32_t ttlMs, uint32_t currentTime, bool& created);
+    bool afterWriteLocked(DataMap::iterator it);
+    template <typename T>
+    bool incrementLocked(const std::string& key, T delta, T& result, uint32_t ttlMs);
+    DataMap::iterator findLiveLocked(const std::string& key, uint32_t currentTime);
+    void eraseLocked(DataMap::iterator it);
+    HotSlot* findHotSlotLocked(const std::string& key);
+    void notifyLocked(const std::string& key, KeyspaceEvent event, const uint8_t* data, size_t len);
+
+    void dispatchNotifications();
+    static bool matchesPattern(const std::string& pattern, const std::string& key);
+    static bool hasPrefix(const std::string& key, const std::string& prefix);
+    void requestCommit();
     uint32_t getCurrentTimeMs();
 };
 
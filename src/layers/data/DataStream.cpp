@@ -0,0 +1,219 @@
+#include "DataStream.h"
+#include <Arduino.h> // For Serial debugging
+#include <cstdlib>
+#include <cstring>
+#ifdef ESP_PLATFORM
+#include <esp_heap_caps.h>
+#endif
+
+DataStream::DataStream(size_t recordSize, size_t capacity, bool usePsram)
+    : recordSize_(recordSize),
+      capacity_(capacity),
+      block_(nullptr),
+      timestamps_(nullptr),
+      records_(nullptr),
+      head_(0),
+      count_(0),
+      totalAppended_(0),
+      mutex_(nullptr) {
+    if (recordSize == 0 || capacity == 0) {
+        return;
+    }
+
+    size_t bytes = capacity * (sizeof(uint64_t) + recordSize);
+
+#ifdef ESP_PLATFORM
+    if (usePsram) {
+        block_ = static_cast<uint8_t*>(heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT));
+        if (block_ == nullptr) {
+            Serial.println("[DataStream] PSRAM allocation failed, falling back to internal RAM");
+        }
+    }
+#endif
+    if (block_ == nullptr) {
+        block_ = static_cast<uint8_t*>(malloc(bytes));
+    }
+
+    if (block_ == nullptr) {
+        Serial.printf("[DataStream] Failed to allocate %u bytes\n", (unsigned)bytes);
+        return;
+    }
+
+    // Timestamps first keeps them 8-byte aligned
+    timestamps_ = reinterpret_cast<uint64_t*>(block_);
+    records_ = block_ + capacity * sizeof(uint64_t);
+    mutex_ = xSemaphoreCreateMutex();
+}
+
+DataStream::~DataStream() {
+    if (mutex_ != nullptr) {
+        vSemaphoreDelete(mutex_);
+        mutex_ = nullptr;
+    }
+    free(block_); // heap_caps_malloc memory is released with free() too
+    block_ = nullptr;
+}
+
+bool DataStream::append(uint64_t timestamp, const uint8_t* record) {
+    if (!isValid() || record == nullptr) {
+        return false;
+    }
+
+    if (xSemaphoreTake(mutex_, portMAX_DELAY) != pdTRUE) {
+        return false;
+    }
+
+    // Range reads binary-search on time, so keep the ring ordered
+    if (count_ > 0 && timestamp < timestamps_[slot(count_ - 1)]) {
+        xSemaphoreGive(mutex_);
+        return false;
+    }
+
+    timestamps_[head_] = timestamp;
+    memcpy(records_ + head_ * recordSize_, record, recordSize_);
+    head_ = (head_ + 1) % capacity_;
+    if (count_ < capacity_) {
+        count_++;
+    }
+    totalAppended_++;
+
+    xSemaphoreGive(mutex_);
+    return true;
+}
+
+size_t DataStream::range(uint64_t from, uint64_t to, const Visitor& visit, size_t maxRecords) const {
+    if (!isValid() || from > to) {
+        return 0;
+    }
+
+    if (xSemaphoreTake(mutex_, portMAX_DELAY) != pdTRUE) {
+        return 0;
+    }
+
+    size_t visited = 0;
+    for (size_t i = lowerBound(from); i < count_ && visited < maxRecords; i++) {
+        size_t s = slot(i);
+        if (timestamps_[s] > to) {
+            break;
+        }
+        visited++;
+        if (!visit(timestamps_[s], records_ + s * recordSize_)) {
+            break;
+        }
+    }
+
+    xSemaphoreGive(mutex_);
+    return visited;
+}
+
+size_t DataStream::latest(size_t n, const Visitor& visit) const {
+    if (!isValid()) {
+        return 0;
+    }
+
+    if (xSemaphoreTake(mutex_, portMAX_DELAY) != pdTRUE) {
+        return 0;
+    }
+
+    size_t start = (n < count_) ? count_ - n : 0;
+    size_t visited = 0;
+    for (size_t i = start; i < count_; i++) {
+        size_t s = slot(i);
+        visited++;
+        if (!visit(timestamps_[s], records_ + s * recordSize_)) {
+            break;
+        }
+    }
+
+    xSemaphoreGive(mutex_);
+    return visited;
+}
+
+size_t DataStream::downsample(uint64_t from, uint64_t to, uint64_t interval, const Visitor& visit) const {
+    if (!isValid() || from > to) {
+        return 0;
+    }
+
+    if (interval == 0) {
+        return range(from, to, visit);
+    }
+
+    if (xSemaphoreTake(mutex_, portMAX_DELAY) != pdTRUE) {
+        return 0;
+    }
+
+    size_t visited = 0;
+    size_t i = lowerBound(from);
+    while (i < count_) {
+        size_t s = slot(i);
+        uint64_t timestamp = timestamps_[s];
+        if (timestamp > to) {
+            break;
+        }
+
+        visited++;
+        if (!visit(timestamp, records_ + s * recordSize_)) {
+            break;
+        }
+
+        // Jump straight to the next bucket instead of scanning every record
+        uint64_t nextBucket = from + ((timestamp - from) / interval + 1) * interval;
+        if (nextBucket <= timestamp) {
+            break; // Overflow
+        }
+        i = lowerBound(nextBucket);
+    }
+
+    xSemaphoreGive(mutex_);
+    return visited;
+}
+
+size_t DataStream::copyLatest(size_t n, uint64_t* timestamps, uint8_t* records) const {
+    if (records == nullptr) {
+        return 0;
+    }
+
+    size_t copied = 0;
+    latest(n, [&](uint64_t timestamp, const uint8_t* record) {
+        if (timestamps != nullptr) {
+            timestamps[copied] = timestamp;
+        }
+        memcpy(records + copied * recordSize_, record, recordSize_);
+        copied++;
+        return true;
+    });
+    return copied;
+}
+
+size_t DataStream::count() const {
+    if (!isValid() || xSemaphoreTake(mutex_, portMAX_DELAY) != pdTRUE) {
+        return 0;
+    }
+    size_t result = count_;
+    xSemaphoreGive(mutex_);
+    return result;
+}
+
+uint64_t DataStream::totalAppended() const {
+    if (!isValid() || xSemaphoreTake(mutex_, portMAX_DELAY) != pdTRUE) {
+        return 0;
+    }
+    uint64_t result = totalAppended_;
+    xSemaphoreGive(mutex_);
+    return result;
+}
+
+// First logical index whose timestamp is >= the given one; caller holds mutex_
+size_t DataStream::lowerBound(uint64_t timestamp) const {
+    size_t low = 0;
+    size_t high = count_;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (timestamps_[slot(mid)] < timestamp) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
@@ -0,0 +1,60 @@
+#ifndef DATA_STREAM_H
+#define DATA_STREAM_H
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+// Time-series stream: a fixed-capacity ring of timestamped, fixed-width records.
+// Timestamps and records live in one preallocated block (optionally in PSRAM);
+// once full, appends overwrite the oldest record. Reads hand out pointers into
+// the ring while the stream lock is held, so consumers never need their own copy.
+class DataStream {
+public:
+    // Return false from the visitor to stop iterating
+    using Visitor = std::function<bool(uint64_t timestamp, const uint8_t* record)>;
+
+    DataStream(size_t recordSize, size_t capacity, bool usePsram = false);
+    ~DataStream();
+
+    bool isValid() const { return block_ != nullptr && mutex_ != nullptr; }
+
+    // XADD: timestamps must be non-decreasing (caller's time base)
+    bool append(uint64_t timestamp, const uint8_t* record);
+
+    // XRANGE: records with from <= timestamp <= to, oldest first
+    size_t range(uint64_t from, uint64_t to, const Visitor& visit, size_t maxRecords = SIZE_MAX) const;
+
+    // Last n records, oldest first
+    size_t latest(size_t n, const Visitor& visit) const;
+
+    // First record of every interval-wide time bucket within [from, to]
+    size_t downsample(uint64_t from, uint64_t to, uint64_t interval, const Visitor& visit) const;
+
+    // Copy the last n records into caller buffers (timestamps may be nullptr)
+    size_t copyLatest(size_t n, uint64_t* timestamps, uint8_t* records) const;
+
+    size_t count() const;
+    size_t capacity() const { return capacity_; }
+    size_t recordSize() const { return recordSize_; }
+    uint64_t totalAppended() const;
+
+private:
+    size_t recordSize_;
+    size_t capacity_;
+    uint8_t* block_;          // [timestamps][records], one allocation
+    uint64_t* timestamps_;
+    uint8_t* records_;
+    size_t head_;             // Next slot to write
+    size_t count_;
+    uint64_t totalAppended_;
+    SemaphoreHandle_t mutex_;
+
+    // Physical slot of the i-th oldest record
+    size_t slot(size_t logicalIndex) const { return (head_ + capacity_ - count_ + logicalIndex) % capacity_; }
+    size_t lowerBound(uint64_t timestamp) const;
+};
+
+#endif // DATA_STREAM_H
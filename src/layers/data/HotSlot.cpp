@@ -0,0 +1,60 @@
+#include "HotSlot.h"
+#include <cstring>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+namespace {
+// Tight retries before yielding; a reader that preempted the writer on the same
+// core must sleep to let the write finish
+const int SPIN_RETRIES = 8;
+}
+
+HotSlot::HotSlot(size_t size, uint32_t ttlMs)
+    : seq_(0),
+      size_(size > MAX_SIZE ? MAX_SIZE : size),
+      ttlMs_(ttlMs),
+      timestampMs_(0) {
+    memset(data_, 0, sizeof(data_));
+}
+
+void HotSlot::write(const uint8_t* data, uint32_t timestampMs) {
+    uint32_t seq = seq_.load(std::memory_order_relaxed);
+    seq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    memcpy(data_, data, size_);
+    timestampMs_ = timestampMs;
+
+    seq_.store(seq + 2, std::memory_order_release);
+}
+
+bool HotSlot::read(uint8_t* out, uint32_t nowMs, uint32_t* timestampMs) const {
+    uint32_t timestamp = 0;
+    int attempts = 0;
+
+    while (true) {
+        uint32_t before = seq_.load(std::memory_order_acquire);
+        if (before == 0) {
+            return false; // Never written
+        }
+
+        if ((before & 1) == 0) {
+            memcpy(out, data_, size_);
+            timestamp = timestampMs_;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq_.load(std::memory_order_relaxed) == before) {
+                break;
+            }
+        }
+
+        if (++attempts >= SPIN_RETRIES) {
+            vTaskDelay(1);
+            attempts = 0;
+        }
+    }
+
+    if (timestampMs != nullptr) {
+        *timestampMs = timestamp;
+    }
+    return ttlMs_ == 0 || nowMs - timestamp < ttlMs_;
+}
@@ -0,0 +1,37 @@
+#ifndef HOT_SLOT_H
+#define HOT_SLOT_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+// Fixed-size, single-writer value protected by a seqlock.
+// The writer never blocks: it bumps the sequence to odd, copies, and bumps it
+// back to even. Readers copy optimistically and retry if the sequence moved,
+// so neither side ever takes a mutex. Meant for values one task writes at a
+// high rate and others sample occasionally (e.g. the latest IMU reading).
+class HotSlot {
+public:
+    static const size_t MAX_SIZE = 64;
+
+    HotSlot(size_t size, uint32_t ttlMs);
+
+    // Single writer only; data must be size() bytes
+    void write(const uint8_t* data, uint32_t timestampMs);
+
+    // Copies size() bytes into out; false if never written or older than the TTL
+    bool read(uint8_t* out, uint32_t nowMs, uint32_t* timestampMs = nullptr) const;
+
+    size_t size() const { return size_; }
+    uint32_t ttlMs() const { return ttlMs_; }
+    uint32_t writeCount() const { return seq_.load(std::memory_order_relaxed) / 2; }
+
+private:
+    std::atomic<uint32_t> seq_; // Odd while a write is in progress
+    size_t size_;
+    uint32_t ttlMs_;
+    uint32_t timestampMs_;
+    alignas(4) uint8_t data_[MAX_SIZE];
+};
+
+#endif // HOT_SLOT_H
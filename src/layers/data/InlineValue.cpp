@@ -0,0 +1,110 @@
+#include "InlineValue.h"
+#include <cstring>
+#include <algorithm>
+
+InlineValue::InlineValue()
+    : size_(0),
+      heapCapacity_(0) {
+}
+
+InlineValue::~InlineValue() {
+    releaseHeap();
+}
+
+InlineValue::InlineValue(const InlineValue& other)
+    : size_(0),
+      heapCapacity_(0) {
+    assign(other.data(), other.size());
+}
+
+InlineValue::InlineValue(InlineValue&& other)
+    : size_(0),
+      heapCapacity_(0) {
+    *this = std::move(other);
+}
+
+InlineValue& InlineValue::operator=(const InlineValue& other) {
+    if (this != &other) {
+        assign(other.data(), other.size());
+    }
+    return *this;
+}
+
+InlineValue& InlineValue::operator=(InlineValue&& other) {
+    if (this == &other) {
+        return *this;
+    }
+
+    releaseHeap();
+    size_ = other.size_;
+    heapCapacity_ = other.heapCapacity_;
+
+    if (other.isInline()) {
+        memcpy(inline_, other.inline_, size_);
+    } else {
+        // Steal the heap block
+        heap_ = other.heap_;
+        other.heapCapacity_ = 0;
+    }
+
+    other.size_ = 0;
+    return *this;
+}
+
+void InlineValue::assign(const uint8_t* data, size_t len) {
+    if (len <= INLINE_CAPACITY) {
+        // Free the old block only after copying, the source may live in it
+        uint8_t* oldBlock = isInline() ? nullptr : heap_;
+        heapCapacity_ = 0;
+        if (len > 0) {
+            memmove(inline_, data, len);
+        }
+        delete[] oldBlock;
+        size_ = len;
+        return;
+    }
+
+    // Reuse the existing heap block when it is large enough
+    if (heapCapacity_ < len) {
+        uint8_t* block = new uint8_t[len];
+        memcpy(block, data, len);
+        releaseHeap();
+        heap_ = block;
+        heapCapacity_ = len;
+    } else {
+        memmove(heap_, data, len);
+    }
+    size_ = len;
+}
+
+void InlineValue::append(const uint8_t* data, size_t len) {
+    size_t newSize = size_ + len;
+
+    if (newSize <= INLINE_CAPACITY || newSize <= heapCapacity_) {
+        memmove(this->data() + size_, data, len);
+        size_ = newSize;
+        return;
+    }
+
+    // Grow geometrically so repeated appends stay amortized O(1)
+    size_t newCapacity = std::max(newSize, (size_t)heapCapacity_ * 2);
+    uint8_t* block = new uint8_t[newCapacity];
+    memcpy(block, this->data(), size_);
+    memcpy(block + size_, data, len);
+    releaseHeap();
+    heap_ = block;
+    heapCapacity_ = newCapacity;
+    size_ = newSize;
+}
+
+void InlineValue::clear() {
+    releaseHeap();
+    size_ = 0;
+}
+
+void InlineValue::releaseHeap() {
+    if (heapCapacity_ > 0) {
+        delete[] heap_;
+        heapCapacity_ = 0;
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef INLINE_VALUE_H
+#define INLINE_VALUE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Values up to this many bytes live inside the DataLayer entry itself
+#ifndef DATA_LAYER_INLINE_VALUE_SIZE
+#define DATA_LAYER_INLINE_VALUE_SIZE 32
+#endif
+
+// Byte buffer with small-buffer optimization for DataLayer values.
+// Most values (sensor readings, flags, counters) fit inline, so writing them
+// never touches the heap; larger values spill to a heap block that is reused
+// across writes as long as it is big enough.
+class InlineValue {
+public:
+    static const size_t INLINE_CAPACITY = DATA_LAYER_INLINE_VALUE_SIZE;
+
+    InlineValue();
+    ~InlineValue();
+    InlineValue(const InlineValue& other);
+    InlineValue(InlineValue&& other);
+    InlineValue& operator=(const InlineValue& other);
+    InlineValue& operator=(InlineValue&& other);
+
+    void assign(const uint8_t* data, size_t len);
+    void append(const uint8_t* data, size_t len);
+    void copyTo(std::vector<uint8_t>& out) const { out.assign(data(), data() + size_); }
+    void clear();
+
+    const uint8_t* data() const { return isInline() ? inline_ : heap_; }
+    uint8_t* data() { return isInline() ? inline_ : heap_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    bool isInline() const { return heapCapacity_ == 0; }
+
+private:
+    uint32_t size_;
+    uint32_t heapCapacity_; // 0 while the value is stored inline
+    union {
+        uint8_t inline_[INLINE_CAPACITY];
+        uint8_t* heap_;
+    };
+
+    void releaseHeap();
+};
+
+#endif // INLINE_VALUE_H
@@ -0,0 +1,112 @@
+#include "SampleRing.h"
+#include <Arduino.h> // For Serial debugging
+#include <cstdlib>
+#include <cstring>
+#ifdef ESP_PLATFORM
+#include <esp_heap_caps.h>
+#endif
+
+SampleRing::SampleRing(size_t recordSize, size_t capacity, bool usePsram)
+    : recordSize_(recordSize),
+      capacity_(0),
+      mask_(0),
+      records_(nullptr),
+      head_(0),
+      cachedTail_(0),
+      dropped_(0),
+      tail_(0),
+      cachedHead_(0) {
+    if (recordSize == 0 || capacity == 0) {
+        return;
+    }
+
+    size_t rounded = 1;
+    while (rounded < capacity) {
+        rounded <<= 1;
+    }
+    size_t bytes = rounded * recordSize;
+
+#ifdef ESP_PLATFORM
+    if (usePsram) {
+        records_ = static_cast<uint8_t*>(heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT));
+        if (records_ == nullptr) {
+            Serial.println("[SampleRing] PSRAM allocation failed, falling back to internal RAM");
+        }
+    }
+#endif
+    if (records_ == nullptr) {
+        records_ = static_cast<uint8_t*>(malloc(bytes));
+    }
+
+    if (records_ == nullptr) {
+        Serial.printf("[SampleRing] Failed to allocate %u bytes\n", (unsigned)bytes);
+        return;
+    }
+
+    capacity_ = rounded;
+    mask_ = rounded - 1;
+}
+
+SampleRing::~SampleRing() {
+    free(records_); // heap_caps_malloc memory is released with free() too
+    records_ = nullptr;
+}
+
+bool SampleRing::push(const uint8_t* record) {
+    if (records_ == nullptr || record == nullptr) {
+        return false;
+    }
+
+    // Indices run freely and wrap with the mask; head - tail is the fill level
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head - cachedTail_ >= capacity_) {
+        cachedTail_ = tail_.load(std::memory_order_acquire);
+        if (head - cachedTail_ >= capacity_) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+
+    memcpy(records_ + (head & mask_) * recordSize_, record, recordSize_);
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+size_t SampleRing::pop(uint8_t* out, size_t maxRecords) {
+    if (records_ == nullptr || out == nullptr) {
+        return 0;
+    }
+
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (cachedHead_ - tail < maxRecords) {
+        cachedHead_ = head_.load(std::memory_order_acquire);
+    }
+    size_t available = cachedHead_ - tail;
+    size_t n = available < maxRecords ? available : maxRecords;
+    if (n == 0) {
+        return 0;
+    }
+
+    // At most two copies: up to the end of the block, then from its start
+    size_t first = tail & mask_;
+    size_t untilEnd = capacity_ - first;
+    size_t firstCount = n < untilEnd ? n : untilEnd;
+    memcpy(out, records_ + first * recordSize_, firstCount * recordSize_);
+    if (n > firstCount) {
+        memcpy(out + firstCount * recordSize_, records_, (n - firstCount) * recordSize_);
+    }
+
+    tail_.store(tail + n, std::memory_order_release);
+    return n;
+}
+
+void SampleRing::clear() {
+    cachedHead_ = head_.load(std::memory_order_acquire);
+    tail_.store(cachedHead_, std::memory_order_release);
+}
+
+size_t SampleRing::count() const {
+    size_t tail = tail_.load(std::memory_order_acquire);
+    size_t head = head_.load(std::memory_order_acquire);
+    return head - tail;
+}
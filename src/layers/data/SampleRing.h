@@ -0,0 +1,61 @@
+#ifndef SAMPLE_RING_H
+#define SAMPLE_RING_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+// Single-producer/single-consumer ring of fixed-width records.
+// The producer only writes head_, the consumer only writes tail_; each keeps a cached copy of
+// the other side's index and reloads it only when the ring looks full (or empty), so in the
+// steady state neither side touches the other's cache line. No locks, no allocation after
+// construction: a full ring drops the new record and counts it rather than blocking the
+// producer. Storage is one block, optionally in PSRAM, with the capacity rounded up to a
+// power of two so indices wrap with a mask.
+class SampleRing {
+public:
+    // Padding between the two sides' indices; 32 bytes on the ESP32, 64 covers the host too
+    static const size_t CACHE_LINE = 64;
+
+    SampleRing(size_t recordSize, size_t capacity, bool usePsram = false);
+    ~SampleRing();
+
+    bool isValid() const { return records_ != nullptr; }
+
+    // Producer side only; false (and dropped() + 1) when the consumer has fallen behind
+    bool push(const uint8_t* record);
+
+    // Consumer side only: copy out up to maxRecords (recordSize() bytes each), oldest first
+    size_t pop(uint8_t* out, size_t maxRecords = 1);
+
+    // Consumer side only: discard everything queued so far
+    void clear();
+
+    // Either side; a snapshot that may be stale by the time it is used
+    size_t count() const;
+    size_t capacity() const { return capacity_; }
+    size_t recordSize() const { return recordSize_; }
+    uint32_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    size_t recordSize_;
+    size_t capacity_;
+    size_t mask_;
+    uint8_t* records_;
+
+    // Padded rather than alignas(): C++11 operator new doesn't honour over-alignment
+    uint8_t padStart_[CACHE_LINE];
+
+    // Producer side
+    std::atomic<size_t> head_; // Next slot to write
+    size_t cachedTail_;
+    std::atomic<uint32_t> dropped_;
+    uint8_t padMiddle_[CACHE_LINE];
+
+    // Consumer side
+    std::atomic<size_t> tail_; // Next slot to read
+    size_t cachedHead_;
+    uint8_t padEnd_[CACHE_LINE];
+};
+
+#endif // SAMPLE_RING_H
@@ -0,0 +1,99 @@
+#include "LittleFSStorage.h"
+#include <Arduino.h>
+#include <LittleFS.h>
+
+LittleFSStorage::LittleFSStorage(bool formatOnFail)
+    : formatOnFail_(formatOnFail),
+      mounted_(false) {
+}
+
+bool LittleFSStorage::begin() {
+    if (mounted_) {
+        return true;
+    }
+
+    if (!LittleFS.begin(formatOnFail_)) {
+        Serial.println("[LittleFSStorage] Failed to mount LittleFS");
+        return false;
+    }
+
+    mounted_ = true;
+    Serial.printf("[LittleFSStorage] Mounted (%u / %u bytes used)\n",
+                  (unsigned)LittleFS.usedBytes(), (unsigned)LittleFS.totalBytes());
+    return true;
+}
+
+bool LittleFSStorage::readFile(const std::string& path, std::vector<uint8_t>& out) {
+    File file = LittleFS.open(path.c_str(), "r");
+    if (!file) {
+        return false;
+    }
+
+    out.resize(file.size());
+    size_t bytesRead = out.empty() ? 0 : file.read(out.data(), out.size());
+    file.close();
+
+    if (bytesRead != out.size()) {
+        out.resize(bytesRead);
+        return false;
+    }
+    return true;
+}
+
+bool LittleFSStorage::writeFile(const std::string& path, const uint8_t* data, size_t len) {
+    File file = LittleFS.open(path.c_str(), "w");
+    if (!file) {
+        Serial.printf("[LittleFSStorage] Failed to open %s for writing\n", path.c_str());
+        return false;
+    }
+
+    size_t written = (len > 0) ? file.write(data, len) : 0;
+    file.close();
+    return written == len;
+}
+
+bool LittleFSStorage::appendFile(const std::string& path, const uint8_t* data, size_t len) {
+    File file = LittleFS.open(path.c_str(), "a");
+    if (!file) {
+        Serial.printf("[LittleFSStorage] Failed to open %s for append\n", path.c_str());
+        return false;
+    }
+
+    size_t written = (len > 0) ? file.write(data, len) : 0;
+    file.close();
+    return written == len;
+}
+
+bool LittleFSStorage::renameFile(const std::string& from, const std::string& to) {
+    // littlefs rename atomically replaces an existing target
+    return LittleFS.rename(from.c_str(), to.c_str());
+}
+
+bool LittleFSStorage::removeFile(const std::string& path) {
+    if (!LittleFS.exists(path.c_str())) {
+        return true;
+    }
+    return LittleFS.remove(path.c_str());
+}
+
+bool LittleFSStorage::exists(const std::string& path) {
+    return LittleFS.exists(path.c_str());
+}
+
+size_t LittleFSStorage::fileSize(const std::string& path) {
+    File file = LittleFS.open(path.c_str(), "r");
+    if (!file) {
+        return 0;
+    }
+
+    size_t size = file.size();
+    file.close();
+    return size;
+}
+
+bool LittleFSStorage::makeDir(const std::string& path) {
+    if (LittleFS.exists(path.c_str())) {
+        return true;
+    }
+    return LittleFS.mkdir(path.c_str());
+}
@@ -0,0 +1,26 @@
+#ifndef LITTLEFS_STORAGE_H
+#define LITTLEFS_STORAGE_H
+
+#include "StorageBackend.h"
+
+// StorageBackend on the ESP32 LittleFS partition
+class LittleFSStorage : public StorageBackend {
+public:
+    explicit LittleFSStorage(bool formatOnFail = true);
+
+    bool begin();
+    bool readFile(const std::string& path, std::vector<uint8_t>& out);
+    bool writeFile(const std::string& path, const uint8_t* data, size_t len);
+    bool appendFile(const std::string& path, const uint8_t* data, size_t len);
+    bool renameFile(const std::string& from, const std::string& to);
+    bool removeFile(const std::string& path);
+    bool exists(const std::string& path);
+    size_t fileSize(const std::string& path);
+    bool makeDir(const std::string& path);
+
+private:
+    bool formatOnFail_;
+    bool mounted_;
+};
+
+#endif // LITTLEFS_STORAGE_H
@@ -0,0 +1,306 @@
+#include "PersistenceEngine.h"
+#include "../Crc32.h"
+#include <Arduino.h> // For Serial debugging
+#include <unordered_map>
+
+namespace {
+
+const uint8_t RECORD_MAGIC = 0xA5;
+const uint32_t LOG_MAGIC = 0x4C464154;      // "TAFL"
+const uint32_t SNAPSHOT_MAGIC = 0x53464154; // "TAFS"
+const size_t RECORD_HEADER_SIZE = 8;        // magic + op + keyLen + valueLen
+const size_t RECORD_CRC_SIZE = 4;
+const size_t LOG_HEADER_SIZE = 8;           // magic + generation
+const size_t SNAPSHOT_HEADER_SIZE = 12;     // magic + generation + count
+
+void putU16(std::vector<uint8_t>& out, uint16_t v) {
+    out.push_back(v & 0xFF);
+    out.push_back((v >> 8) & 0xFF);
+}
+
+void putU32(std::vector<uint8_t>& out, uint32_t v) {
+    out.push_back(v & 0xFF);
+    out.push_back((v >> 8) & 0xFF);
+    out.push_back((v >> 16) & 0xFF);
+    out.push_back((v >> 24) & 0xFF);
+}
+
+void writeU32At(std::vector<uint8_t>& out, size_t offset, uint32_t v) {
+    out[offset] = v & 0xFF;
+    out[offset + 1] = (v >> 8) & 0xFF;
+    out[offset + 2] = (v >> 16) & 0xFF;
+    out[offset + 3] = (v >> 24) & 0xFF;
+}
+
+uint16_t getU16(const uint8_t* p) {
+    return p[0] | (p[1] << 8);
+}
+
+uint32_t getU32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+} // namespace
+
+PersistenceEngine::PersistenceEngine(StorageBackend* storage, const PersistenceConfig& config)
+    : storage_(storage),
+      config_(config),
+      logPath_(config.directory + "/oplog.bin"),
+      snapshotPath_(config.directory + "/snapshot.bin"),
+      snapshotTmpPath_(config.directory + "/snapshot.tmp"),
+      generation_(0),
+      logBytes_(0),
+      snapshotCount_(0),
+      logReady_(false) {
+}
+
+bool PersistenceEngine::shouldPersist(const std::string& key, bool hasTtl) const {
+    // Keys with a TTL are volatile by definition and would only churn flash
+    if (hasTtl) {
+        return false;
+    }
+
+    if (config_.prefixes.empty()) {
+        return true;
+    }
+
+    for (const auto& prefix : config_.prefixes) {
+        if (key.compare(0, prefix.size(), prefix) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PersistenceEngine::recover(ApplyCallback apply, size_t& recoveredKeys) {
+    recoveredKeys = 0;
+
+    if (storage_ == nullptr || !storage_->begin()) {
+        Serial.println("[Persistence] Storage backend unavailable");
+        return false;
+    }
+
+    if (!storage_->makeDir(config_.directory)) {
+        Serial.printf("[Persistence] Failed to create directory %s\n", config_.directory.c_str());
+        return false;
+    }
+
+    std::unordered_map<std::string, std::vector<uint8_t>> state;
+    std::vector<uint8_t> buf;
+    std::string key;
+    const uint8_t* data = nullptr;
+    size_t len = 0;
+    uint8_t op = 0;
+    bool snapshotValid = false;
+
+    // Snapshot: all-or-nothing, a torn snapshot is never renamed into place
+    if (storage_->readFile(snapshotPath_, buf) && buf.size() >= SNAPSHOT_HEADER_SIZE &&
+        getU32(buf.data()) == SNAPSHOT_MAGIC) {
+        uint32_t generation = getU32(buf.data() + 4);
+        uint32_t count = getU32(buf.data() + 8);
+        size_t offset = SNAPSHOT_HEADER_SIZE;
+        uint32_t decoded = 0;
+
+        while (decoded < count && decodeRecord(buf, offset, op, key, data, len) && op == OP_SET) {
+            state[key].assign(data, data + len);
+            decoded++;
+        }
+
+        if (decoded == count) {
+            generation_ = generation;
+            snapshotCount_ = count;
+            snapshotValid = true;
+        } else {
+            Serial.println("[Persistence] Snapshot corrupt, ignoring it");
+            state.clear();
+        }
+    }
+
+    // Log: replay the valid prefix; a torn tail from a power cut is dropped
+    bool logTruncated = false;
+    logBytes_ = 0;
+    if (storage_->readFile(logPath_, buf) && buf.size() >= LOG_HEADER_SIZE &&
+        getU32(buf.data()) == LOG_MAGIC && getU32(buf.data() + 4) == generation_) {
+        size_t offset = LOG_HEADER_SIZE;
+        size_t replayed = 0;
+
+        while (offset < buf.size()) {
+            if (!decodeRecord(buf, offset, op, key, data, len)) {
+                logTruncated = true;
+                break;
+            }
+            if (op == OP_SET) {
+                state[key].assign(data, data + len);
+            } else if (op == OP_DEL) {
+                state.erase(key);
+            }
+            replayed++;
+        }
+
+        logBytes_ = offset;
+        logReady_ = true;
+        Serial.printf("[Persistence] Replayed %u log records%s\n", (unsigned)replayed,
+                      logTruncated ? " (torn tail discarded)" : "");
+    } else if (storage_->exists(logPath_)) {
+        // Log from another generation: superseded by the snapshot
+        storage_->removeFile(logPath_);
+    }
+
+    for (const auto& pair : state) {
+        apply(pair.first, pair.second.data(), pair.second.size());
+    }
+    recoveredKeys = state.size();
+
+    // Start a fresh generation when the log cannot be appended to as-is
+    if (logTruncated || logBytes_ == 0) {
+        std::vector<uint8_t> snapshot;
+        beginSnapshot(snapshot);
+        for (const auto& pair : state) {
+            addSnapshotEntry(snapshot, pair.first, pair.second.data(), pair.second.size());
+        }
+        if (logTruncated || !snapshotValid || state.size() != snapshotCount_) {
+            return writeSnapshot(snapshot);
+        }
+        return writeLogHeader();
+    }
+
+    return true;
+}
+
+void PersistenceEngine::logSet(const std::string& key, const uint8_t* data, size_t len) {
+    encodeRecord(pending_, OP_SET, key, data, len);
+}
+
+void PersistenceEngine::logDel(const std::string& key) {
+    encodeRecord(pending_, OP_DEL, key, nullptr, 0);
+}
+
+void PersistenceEngine::takePending(std::vector<uint8_t>& batch) {
+    batch.clear();
+    batch.swap(pending_);
+}
+
+void PersistenceEngine::restorePending(std::vector<uint8_t>& batch) {
+    // Failed batch precedes anything logged since, keep the order
+    batch.insert(batch.end(), pending_.begin(), pending_.end());
+    pending_.swap(batch);
+    batch.clear();
+}
+
+bool PersistenceEngine::commit(const std::vector<uint8_t>& batch) {
+    if (batch.empty()) {
+        return true;
+    }
+
+    // After a snapshot whose log reset failed, the file on flash still belongs to the previous
+    // generation and recovery would drop anything appended to it: start the log first
+    if (!logReady_ && !writeLogHeader()) {
+        return false;
+    }
+
+    if (!storage_->appendFile(logPath_, batch.data(), batch.size())) {
+        Serial.println("[Persistence] Failed to append to log");
+        return false;
+    }
+
+    logBytes_ += batch.size();
+    return true;
+}
+
+bool PersistenceEngine::needsCompaction() const {
+    return logBytes_ >= config_.compactThresholdBytes;
+}
+
+void PersistenceEngine::beginSnapshot(std::vector<uint8_t>& snapshot) {
+    snapshot.clear();
+    putU32(snapshot, SNAPSHOT_MAGIC);
+    putU32(snapshot, generation_ + 1);
+    putU32(snapshot, 0); // Count, patched in writeSnapshot
+}
+
+void PersistenceEngine::addSnapshotEntry(std::vector<uint8_t>& snapshot, const std::string& key,
+                                         const uint8_t* data, size_t len) {
+    encodeRecord(snapshot, OP_SET, key, data, len);
+    writeU32At(snapshot, 8, getU32(snapshot.data() + 8) + 1);
+}
+
+bool PersistenceEngine::writeSnapshot(std::vector<uint8_t>& snapshot) {
+    uint32_t count = getU32(snapshot.data() + 8);
+
+    // Write aside and rename so a power cut leaves either the old or the new snapshot
+    if (!storage_->writeFile(snapshotTmpPath_, snapshot.data(), snapshot.size()) ||
+        !storage_->renameFile(snapshotTmpPath_, snapshotPath_)) {
+        Serial.println("[Persistence] Failed to write snapshot");
+        return false;
+    }
+
+    generation_++;
+    snapshotCount_ = count;
+
+    Serial.printf("[Persistence] Snapshot generation %u written (%u keys, %u bytes)\n",
+                  (unsigned)generation_, (unsigned)count, (unsigned)snapshot.size());
+    return writeLogHeader();
+}
+
+bool PersistenceEngine::writeLogHeader() {
+    std::vector<uint8_t> header;
+    putU32(header, LOG_MAGIC);
+    putU32(header, generation_);
+
+    if (!storage_->writeFile(logPath_, header.data(), header.size())) {
+        Serial.println("[Persistence] Failed to reset log");
+        logBytes_ = 0;
+        logReady_ = false;
+        return false;
+    }
+
+    logBytes_ = header.size();
+    logReady_ = true;
+    return true;
+}
+
+void PersistenceEngine::encodeRecord(std::vector<uint8_t>& out, uint8_t op, const std::string& key,
+                                     const uint8_t* data, size_t len) {
+    size_t start = out.size();
+    out.reserve(start + RECORD_HEADER_SIZE + key.size() + len + RECORD_CRC_SIZE);
+
+    out.push_back(RECORD_MAGIC);
+    out.push_back(op);
+    putU16(out, key.size());
+    putU32(out, len);
+    out.insert(out.end(), key.begin(), key.end());
+    if (len > 0) {
+        out.insert(out.end(), data, data + len);
+    }
+
+    // CRC covers everything after the magic byte
+    putU32(out, crc32(out.data() + start + 1, out.size() - start - 1));
+}
+
+bool PersistenceEngine::decodeRecord(const std::vector<uint8_t>& buf, size_t& offset, uint8_t& op,
+                                     std::string& key, const uint8_t*& data, size_t& len) {
+    if (offset + RECORD_HEADER_SIZE > buf.size() || buf[offset] != RECORD_MAGIC) {
+        return false;
+    }
+
+    const uint8_t* p = buf.data() + offset;
+    size_t keyLen = getU16(p + 2);
+    size_t valueLen = getU32(p + 4);
+    size_t total = RECORD_HEADER_SIZE + keyLen + valueLen + RECORD_CRC_SIZE;
+
+    if (valueLen > buf.size() || offset + total > buf.size()) {
+        return false;
+    }
+
+    uint32_t storedCrc = getU32(p + total - RECORD_CRC_SIZE);
+    if (crc32(p + 1, total - RECORD_CRC_SIZE - 1) != storedCrc) {
+        return false;
+    }
+
+    op = p[1];
+    key.assign(reinterpret_cast<const char*>(p + RECORD_HEADER_SIZE), keyLen);
+    data = p + RECORD_HEADER_SIZE + keyLen;
+    len = valueLen;
+    offset += total;
+    return true;
+}
@@ -0,0 +1,87 @@
+#ifndef PERSISTENCE_ENGINE_H
+#define PERSISTENCE_ENGINE_H
+
+#include "StorageBackend.h"
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <functional>
+
+struct PersistenceConfig {
+    std::string directory = "/datalayer";
+    uint32_t commitIntervalMs = 1000;       // Group-commit window
+    size_t commitThresholdBytes = 1024;     // Commit early once this much is pending
+    size_t compactThresholdBytes = 16384;   // Rewrite snapshot once the log grows past this
+    std::vector<std::string> prefixes;      // Keys to persist; empty persists every key without TTL
+};
+
+// Append-only operation log plus snapshot for DataLayer.
+//
+// Log file:      [header: magic, generation] [record]*
+// Snapshot file: [header: magic, generation, count] [SET record]*
+// Record:        magic(1) op(1) keyLen(2) valueLen(4) key value crc32(4)
+//
+// Records are encoded into an in-memory pending buffer by the DataLayer
+// (under its data mutex) and written in batches by commit(), so flash sees
+// one write per commit window rather than one per set(). A log is only
+// replayed on top of the snapshot with the same generation, so a crash
+// between writing a new snapshot and resetting the log cannot resurrect
+// stale values.
+class PersistenceEngine {
+public:
+    using ApplyCallback = std::function<void(const std::string& key, const uint8_t* data, size_t len)>;
+
+    PersistenceEngine(StorageBackend* storage, const PersistenceConfig& config);
+
+    const PersistenceConfig& config() const { return config_; }
+
+    // Whether a key belongs in persistent storage
+    bool shouldPersist(const std::string& key, bool hasTtl) const;
+
+    // Load snapshot and replay log; apply is called for every live key
+    bool recover(ApplyCallback apply, size_t& recoveredKeys);
+
+    // Encode operations into the pending buffer (caller serializes access)
+    void logSet(const std::string& key, const uint8_t* data, size_t len);
+    void logDel(const std::string& key);
+    size_t pendingBytes() const { return pending_.size(); }
+
+    // Move pending records into batch / put a failed batch back in front
+    void takePending(std::vector<uint8_t>& batch);
+    void restorePending(std::vector<uint8_t>& batch);
+
+    // Append a batch to the log file (I/O, call without the data mutex held)
+    bool commit(const std::vector<uint8_t>& batch);
+
+    // Snapshot support: begin, add every live key, then write
+    bool needsCompaction() const;
+    void beginSnapshot(std::vector<uint8_t>& snapshot);
+    void addSnapshotEntry(std::vector<uint8_t>& snapshot, const std::string& key, const uint8_t* data, size_t len);
+    bool writeSnapshot(std::vector<uint8_t>& snapshot);
+
+private:
+    enum Op : uint8_t {
+        OP_SET = 1,
+        OP_DEL = 2
+    };
+
+    StorageBackend* storage_;
+    PersistenceConfig config_;
+    std::vector<uint8_t> pending_;
+    std::string logPath_;
+    std::string snapshotPath_;
+    std::string snapshotTmpPath_;
+    uint32_t generation_;
+    size_t logBytes_;
+    uint32_t snapshotCount_;
+    bool logReady_;  // The log file starts with the current generation's header; commits need it
+
+    static void encodeRecord(std::vector<uint8_t>& out, uint8_t op, const std::string& key,
+                             const uint8_t* data, size_t len);
+    static bool decodeRecord(const std::vector<uint8_t>& buf, size_t& offset, uint8_t& op,
+                             std::string& key, const uint8_t*& data, size_t& len);
+    bool writeLogHeader();
+};
+
+#endif // PERSISTENCE_ENGINE_H
@@ -0,0 +1,87 @@
+#include "PosixFileStorage.h"
+#include <cstdio>
+#include <cerrno>
+#include <sys/stat.h>
+
+PosixFileStorage::PosixFileStorage(const std::string& rootDir)
+    : rootDir_(rootDir) {
+}
+
+bool PosixFileStorage::begin() {
+    return makeDir("");
+}
+
+bool PosixFileStorage::readFile(const std::string& path, std::vector<uint8_t>& out) {
+    FILE* file = fopen(resolve(path).c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    out.resize(size > 0 ? size : 0);
+    size_t bytesRead = out.empty() ? 0 : fread(out.data(), 1, out.size(), file);
+    fclose(file);
+
+    if (bytesRead != out.size()) {
+        out.resize(bytesRead);
+        return false;
+    }
+    return true;
+}
+
+bool PosixFileStorage::writeFile(const std::string& path, const uint8_t* data, size_t len) {
+    FILE* file = fopen(resolve(path).c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    size_t written = (len > 0) ? fwrite(data, 1, len, file) : 0;
+    bool ok = (fflush(file) == 0) && written == len;
+    fclose(file);
+    return ok;
+}
+
+bool PosixFileStorage::appendFile(const std::string& path, const uint8_t* data, size_t len) {
+    FILE* file = fopen(resolve(path).c_str(), "ab");
+    if (file == nullptr) {
+        return false;
+    }
+
+    size_t written = (len > 0) ? fwrite(data, 1, len, file) : 0;
+    bool ok = (fflush(file) == 0) && written == len;
+    fclose(file);
+    return ok;
+}
+
+bool PosixFileStorage::renameFile(const std::string& from, const std::string& to) {
+    return rename(resolve(from).c_str(), resolve(to).c_str()) == 0;
+}
+
+bool PosixFileStorage::removeFile(const std::string& path) {
+    return remove(resolve(path).c_str()) == 0 || errno == ENOENT;
+}
+
+bool PosixFileStorage::exists(const std::string& path) {
+    struct stat st;
+    return stat(resolve(path).c_str(), &st) == 0;
+}
+
+size_t PosixFileStorage::fileSize(const std::string& path) {
+    struct stat st;
+    if (stat(resolve(path).c_str(), &st) != 0) {
+        return 0;
+    }
+    return st.st_size;
+}
+
+bool PosixFileStorage::makeDir(const std::string& path) {
+    std::string fullPath = resolve(path);
+    return mkdir(fullPath.c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+std::string PosixFileStorage::resolve(const std::string& path) const {
+    return rootDir_ + path;
+}
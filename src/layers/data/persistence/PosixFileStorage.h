@@ -0,0 +1,28 @@
+#ifndef POSIX_FILE_STORAGE_H
+#define POSIX_FILE_STORAGE_H
+
+#include "StorageBackend.h"
+
+// StorageBackend on plain stdio files, rooted at a host directory.
+// Used for host-side testing of the persistence engine.
+class PosixFileStorage : public StorageBackend {
+public:
+    explicit PosixFileStorage(const std::string& rootDir);
+
+    bool begin();
+    bool readFile(const std::string& path, std::vector<uint8_t>& out);
+    bool writeFile(const std::string& path, const uint8_t* data, size_t len);
+    bool appendFile(const std::string& path, const uint8_t* data, size_t len);
+    bool renameFile(const std::string& from, const std::string& to);
+    bool removeFile(const std::string& path);
+    bool exists(const std::string& path);
+    size_t fileSize(const std::string& path);
+    bool makeDir(const std::string& path);
+
+private:
+    std::string rootDir_;
+
+    std::string resolve(const std::string& path) const;
+};
+
+#endif // POSIX_FILE_STORAGE_H
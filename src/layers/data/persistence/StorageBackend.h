@@ -0,0 +1,29 @@
+#ifndef STORAGE_BACKEND_H
+#define STORAGE_BACKEND_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Minimal filesystem abstraction used by the DataLayer persistence engine.
+// LittleFSStorage backs it on the device, PosixFileStorage on the host.
+class StorageBackend {
+public:
+    virtual ~StorageBackend() {}
+
+    // Mount / prepare the underlying filesystem
+    virtual bool begin() = 0;
+
+    // Whole-file operations; paths are absolute within the backend
+    virtual bool readFile(const std::string& path, std::vector<uint8_t>& out) = 0;
+    virtual bool writeFile(const std::string& path, const uint8_t* data, size_t len) = 0;
+    virtual bool appendFile(const std::string& path, const uint8_t* data, size_t len) = 0;
+    virtual bool renameFile(const std::string& from, const std::string& to) = 0;
+    virtual bool removeFile(const std::string& path) = 0;
+    virtual bool exists(const std::string& path) = 0;
+    virtual size_t fileSize(const std::string& path) = 0;
+    virtual bool makeDir(const std::string& path) = 0;
+};
+
+#endif // STORAGE_BACKEND_H
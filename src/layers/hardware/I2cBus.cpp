@@ -0,0 +1,337 @@
+#include "I2cBus.h"
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <cstring>
+#include "../logging/Log.h"
+
+I2cBus::I2cBus()
+    : wire_(nullptr),
+      pending_(nullptr),
+      busMutex_(nullptr),
+      task_(nullptr),
+      stopRequested_(false),
+      taskRunning_(false),
+      muxAddress_(0),
+      muxChannel_(NO_CHANNEL),
+      completed_(0),
+      failed_(0),
+      rejected_(0),
+      maxLatencyUs_(0) {
+    for (size_t i = 0; i < PRIORITY_LEVELS; i++) {
+        queues_[i] = nullptr;
+    }
+}
+
+I2cBus::~I2cBus() {
+    // Let the bus task finish its transaction and exit: deleting it mid-transaction would leave
+    // busMutex_ taken and Wire in an unknown state
+    if (task_ != nullptr) {
+        stopRequested_.store(true);
+        xSemaphoreGive(pending_);
+        while (taskRunning_.load()) {
+            vTaskDelay(pdMS_TO_TICKS(1));
+        }
+        task_ = nullptr;
+    }
+    for (size_t i = 0; i < PRIORITY_LEVELS; i++) {
+        if (queues_[i] != nullptr) {
+            vQueueDelete(queues_[i]);
+            queues_[i] = nullptr;
+        }
+    }
+    if (pending_ != nullptr) {
+        vSemaphoreDelete(pending_);
+        pending_ = nullptr;
+    }
+    if (busMutex_ != nullptr) {
+        vSemaphoreDelete(busMutex_);
+        busMutex_ = nullptr;
+    }
+}
+
+bool I2cBus::begin(int sda, int scl, uint32_t frequency, UBaseType_t taskPriority, uint32_t taskStackSize,
+                   size_t queueDepth) {
+    if (task_ != nullptr) {
+        return true;
+    }
+    if (queueDepth == 0) {
+        return false;
+    }
+
+    busMutex_ = xSemaphoreCreateMutex();
+    pending_ = xSemaphoreCreateCounting(queueDepth * PRIORITY_LEVELS, 0);
+    for (size_t i = 0; i < PRIORITY_LEVELS; i++) {
+        queues_[i] = xQueueCreate(queueDepth, sizeof(Pending));
+        if (queues_[i] == nullptr) {
+            Serial.println("[I2cBus] Failed to create transaction queue");
+            return false;
+        }
+    }
+    if (busMutex_ == nullptr || pending_ == nullptr) {
+        Serial.println("[I2cBus] Failed to create semaphores");
+        return false;
+    }
+
+    wire_ = &Wire;
+    if (!wire_->begin(sda, scl, frequency)) {
+        Serial.println("[I2cBus] Failed to start I2C controller");
+        return false;
+    }
+    wire_->setClock(frequency);
+
+    taskRunning_.store(true);
+    if (xTaskCreate(busTask, "I2cBus", taskStackSize, this, taskPriority, &task_) != pdPASS) {
+        Serial.println("[I2cBus] Failed to create bus task");
+        taskRunning_.store(false);
+        task_ = nullptr;
+        return false;
+    }
+
+    Serial.printf("[I2cBus] Started on SDA %d / SCL %d at %u Hz\n", sda, scl, (unsigned)frequency);
+    return true;
+}
+
+bool I2cBus::submit(const Transaction& transaction, Priority priority) {
+    if (task_ == nullptr || stopRequested_.load() || priority < PRIORITY_LOW || priority >= PRIORITY_LEVELS ||
+        transaction.txLen > MAX_TRANSFER || transaction.rxLen > MAX_TRANSFER ||
+        (transaction.txLen == 0 && transaction.rxLen == 0) ||
+        (transaction.txLen > 0 && transaction.tx == nullptr) ||
+        (transaction.rxLen > 0 && transaction.rx == nullptr) ||
+        (transaction.channel != NO_CHANNEL && (muxAddress_ == 0 || transaction.channel < 0 ||
+                                               transaction.channel >= (int8_t)MUX_CHANNELS))) {
+        rejected_++;
+        return false;
+    }
+
+    Pending pending;
+    pending.transaction = transaction;
+    pending.submittedUs = esp_timer_get_time();
+    if (xQueueSend(queues_[priority], &pending, 0) != pdTRUE) {
+        rejected_++;
+        LOG_WARN(I2C, "Queue full at priority %d, transaction to 0x%02X rejected", (int)priority,
+                 transaction.address);
+        return false;
+    }
+    xSemaphoreGive(pending_);
+    return true;
+}
+
+bool I2cBus::acquire(TickType_t timeout) {
+    return busMutex_ != nullptr && xSemaphoreTake(busMutex_, timeout) == pdTRUE;
+}
+
+void I2cBus::release() {
+    xSemaphoreGive(busMutex_);
+}
+
+void I2cBus::setMux(uint8_t address) {
+    muxAddress_ = address;
+    muxChannel_ = NO_CHANNEL;
+}
+
+bool I2cBus::selectChannel(int8_t channel) {
+    if (channel == NO_CHANNEL || channel == muxChannel_) {
+        return true;
+    }
+    if (muxAddress_ == 0 || channel < 0 || channel >= (int8_t)MUX_CHANNELS) {
+        return false;
+    }
+
+    wire_->beginTransmission(muxAddress_);
+    wire_->write((uint8_t)(1u << channel));
+    if (wire_->endTransmission(true) != 0) {
+        muxChannel_ = NO_CHANNEL; // State unknown; select again next time
+        return false;
+    }
+    muxChannel_ = channel;
+    return true;
+}
+
+I2cBus::Stats I2cBus::getStats() const {
+    Stats stats;
+    stats.completed = completed_.load();
+    stats.failed = failed_.load();
+    stats.rejected = rejected_.load();
+    stats.maxLatencyUs = maxLatencyUs_.load();
+    return stats;
+}
+
+void I2cBus::busTask(void* parameter) {
+    I2cBus* bus = static_cast<I2cBus*>(parameter);
+    Pending pending;
+
+    while (true) {
+        xSemaphoreTake(bus->pending_, portMAX_DELAY);
+        if (bus->stopRequested_.load()) {
+            break;
+        }
+
+        // One semaphore count per queued transaction, so some level has one; take the highest
+        bool found = false;
+        for (int level = PRIORITY_LEVELS - 1; level >= 0 && !found; level--) {
+            found = xQueueReceive(bus->queues_[level], &pending, 0) == pdTRUE;
+        }
+        if (!found) {
+            continue;
+        }
+
+        xSemaphoreTake(bus->busMutex_, portMAX_DELAY);
+        bool ok = bus->execute(pending.transaction);
+        xSemaphoreGive(bus->busMutex_);
+
+        bus->complete(pending, ok);
+    }
+
+    // Fail whatever is still queued so no driver waits on it forever
+    for (int level = PRIORITY_LEVELS - 1; level >= 0; level--) {
+        while (xQueueReceive(bus->queues_[level], &pending, 0) == pdTRUE) {
+            bus->complete(pending, false);
+        }
+    }
+
+    bus->taskRunning_.store(false);
+    vTaskDelete(nullptr);
+}
+
+bool I2cBus::execute(const Transaction& transaction) {
+    if (!selectChannel(transaction.channel)) {
+        return false;
+    }
+
+    if (transaction.txLen > 0) {
+        wire_->beginTransmission(transaction.address);
+        wire_->write(transaction.tx, transaction.txLen);
+        // Repeated start when a read follows, so no other controller can slip in between
+        if (wire_->endTransmission(transaction.rxLen == 0) != 0) {
+            return false;
+        }
+    }
+
+    if (transaction.rxLen > 0) {
+        if (wire_->requestFrom(transaction.address, transaction.rxLen, true) != transaction.rxLen) {
+            return false;
+        }
+        for (size_t i = 0; i < transaction.rxLen; i++) {
+            transaction.rx[i] = (uint8_t)wire_->read();
+        }
+    }
+    return true;
+}
+
+void I2cBus::complete(const Pending& pending, bool ok) {
+    if (ok) {
+        completed_++;
+    } else {
+        failed_++;
+        LOG_DEBUG(I2C, "Transaction to 0x%02X failed", pending.transaction.address);
+    }
+
+    uint32_t latency = (uint32_t)(esp_timer_get_time() - pending.submittedUs);
+    uint32_t seen = maxLatencyUs_.load(std::memory_order_relaxed);
+    while (latency > seen && !maxLatencyUs_.compare_exchange_weak(seen, latency)) {
+    }
+
+    const Transaction& transaction = pending.transaction;
+    if (transaction.ok != nullptr) {
+        *transaction.ok = ok;
+    }
+    if (transaction.callback != nullptr) {
+        transaction.callback(ok, transaction.callbackArg);
+    }
+    if (transaction.done != nullptr) {
+        xSemaphoreGive(transaction.done);
+    }
+}
+
+I2cBus::Device::Device()
+    : bus_(nullptr),
+      address_(0),
+      channel_(NO_CHANNEL),
+      priority_(PRIORITY_NORMAL),
+      done_(nullptr),
+      queued_(0),
+      queueFailed_(false) {
+    memset(results_, 0, sizeof(results_));
+}
+
+I2cBus::Device::~Device() {
+    if (done_ != nullptr) {
+        wait();
+        vSemaphoreDelete(done_);
+        done_ = nullptr;
+    }
+}
+
+bool I2cBus::Device::attach(I2cBus* bus, uint8_t address, Priority priority, int8_t channel) {
+    if (bus == nullptr || !bus->isRunning() ||
+        (channel != NO_CHANNEL && (!bus->hasMux() || channel < 0 || channel >= (int8_t)MUX_CHANNELS))) {
+        return false;
+    }
+    if (done_ == nullptr) {
+        done_ = xSemaphoreCreateCounting(MAX_QUEUED, 0);
+        if (done_ == nullptr) {
+            return false;
+        }
+    }
+    bus_ = bus;
+    address_ = address;
+    channel_ = channel;
+    priority_ = priority;
+    return true;
+}
+
+bool I2cBus::Device::transfer(const uint8_t* tx, size_t txLen, uint8_t* rx, size_t rxLen) {
+    if (!queue(tx, txLen, rx, rxLen)) {
+        wait();
+        return false;
+    }
+    return wait();
+}
+
+bool I2cBus::Device::writeRegister(uint8_t reg, uint8_t value) {
+    uint8_t data[2] = {reg, value};
+    return transfer(data, sizeof(data), nullptr, 0);
+}
+
+bool I2cBus::Device::readRegisters(uint8_t reg, uint8_t* out, size_t len) {
+    return transfer(&reg, 1, out, len);
+}
+
+bool I2cBus::Device::queue(const uint8_t* tx, size_t txLen, uint8_t* rx, size_t rxLen) {
+    if (bus_ == nullptr || queued_ >= MAX_QUEUED) {
+        queueFailed_ = true;
+        return false;
+    }
+
+    Transaction transaction;
+    transaction.address = address_;
+    transaction.tx = tx;
+    transaction.txLen = txLen;
+    transaction.rx = rx;
+    transaction.rxLen = rxLen;
+    transaction.callback = nullptr;
+    transaction.callbackArg = nullptr;
+    transaction.done = done_;
+    transaction.ok = &results_[queued_];
+    transaction.channel = channel_;
+
+    if (!bus_->submit(transaction, priority_)) {
+        queueFailed_ = true;
+        return false;
+    }
+    queued_++;
+    return true;
+}
+
+bool I2cBus::Device::wait() {
+    bool ok = !queueFailed_;
+    for (size_t i = 0; i < queued_; i++) {
+        xSemaphoreTake(done_, portMAX_DELAY);
+    }
+    for (size_t i = 0; i < queued_; i++) {
+        ok = ok && results_[i];
+    }
+    queued_ = 0;
+    queueFailed_ = false;
+    return ok;
+}
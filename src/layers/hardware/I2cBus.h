@@ -0,0 +1,157 @@
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <Wire.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+// Shared I2C bus manager.
+//
+// Owns the TwoWire controller and runs every transaction on one bus task, so any number of
+// drivers can share the bus without coordinating. Drivers submit write-then-read transactions
+// (a register address and/or data, then a repeated-start read) to one of three priority
+// queues; the bus task always serves the highest non-empty queue, FIFO within a level, and
+// reports completion through a callback, a semaphore, or both.
+//
+// Drivers normally go through an I2cBus::Device: one per chip, with its own address, priority
+// and completion semaphore. A driver waiting on it sleeps while the bus serves others instead
+// of holding the CPU, and can queue several transactions (e.g. consecutive burst reads) and
+// wait once for all of them.
+//
+// Libraries that drive Wire themselves (Adafruit_MPU6050) take the bus with acquire()/release()
+// around their calls; the bus task holds the same mutex for each transaction.
+//
+// Chips behind a TCA9548A multiplexer (setMux()) carry their mux channel in the transaction.
+// The bus task selects it first when the mux is on another channel, so the selection and the
+// transfer can't be separated by another driver's traffic; consecutive transactions on one
+// channel cost no extra writes. Only one channel is open at a time, and devices on the main
+// bus must not share an address with a device behind the mux.
+class I2cBus {
+public:
+    enum Priority {
+        PRIORITY_LOW = 0,    // Configuration, diagnostics
+        PRIORITY_NORMAL = 1,
+        PRIORITY_HIGH = 2,   // Sample acquisition
+        PRIORITY_LEVELS = 3
+    };
+
+    // Runs on the bus task after the transaction; keep it short
+    typedef void (*Callback)(bool ok, void* arg);
+
+    // Buffers must stay valid until completion is reported
+    struct Transaction {
+        uint8_t address;
+        const uint8_t* tx;      // Written first (typically the register address)
+        size_t txLen;
+        uint8_t* rx;            // Then read with a repeated start; rxLen 0 ends with a stop
+        size_t rxLen;
+        Callback callback;      // Optional
+        void* callbackArg;
+        SemaphoreHandle_t done; // Optional, given after the callback
+        bool* ok;               // Optional, set before done is given
+        int8_t channel;         // Mux channel the device sits behind, NO_CHANNEL on the main bus
+    };
+
+    struct Stats {
+        uint32_t completed;
+        uint32_t failed;    // Bus or device errors (NACK, short read)
+        uint32_t rejected;  // Queue full or invalid transaction
+        uint32_t maxLatencyUs; // Submit to completion, including queueing
+    };
+
+    // Wire buffer size on the ESP32 Arduino core; longer transfers must be split by the driver
+    static const size_t MAX_TRANSFER = 128;
+    static const int8_t NO_CHANNEL = -1;
+    static const uint8_t MUX_CHANNELS = 8;
+
+    // A chip on the bus, used from one task at a time
+    class Device {
+    public:
+        static const size_t MAX_QUEUED = 8; // Transactions in flight between queue() and wait()
+
+        Device();
+        ~Device();
+
+        bool attach(I2cBus* bus, uint8_t address, Priority priority = PRIORITY_NORMAL,
+                    int8_t channel = NO_CHANNEL);
+        bool isAttached() const { return bus_ != nullptr; }
+        uint8_t address() const { return address_; }
+        int8_t channel() const { return channel_; }
+
+        // Queue a transaction and sleep until it completes
+        bool transfer(const uint8_t* tx, size_t txLen, uint8_t* rx, size_t rxLen);
+        bool writeRegister(uint8_t reg, uint8_t value);
+        bool readRegisters(uint8_t reg, uint8_t* out, size_t len);
+
+        // Queue without waiting (tx/rx must outlive the wait), then collect everything queued;
+        // wait() is true only if all of them succeeded
+        bool queue(const uint8_t* tx, size_t txLen, uint8_t* rx, size_t rxLen);
+        bool wait();
+
+    private:
+        I2cBus* bus_;
+        uint8_t address_;
+        int8_t channel_;
+        Priority priority_;
+        SemaphoreHandle_t done_;
+        bool results_[MAX_QUEUED];
+        size_t queued_;
+        bool queueFailed_;
+    };
+
+    I2cBus();
+    ~I2cBus();
+
+    // Start the controller and the bus task (default: ESP32-CAM pins, 400 kHz)
+    bool begin(int sda = 14, int scl = 15, uint32_t frequency = 400000, UBaseType_t taskPriority = 6,
+               uint32_t taskStackSize = 3072, size_t queueDepth = 16);
+
+    // Queue a transaction; fails without blocking when that priority's queue is full
+    bool submit(const Transaction& transaction, Priority priority = PRIORITY_NORMAL);
+
+    // Exclusive access for code that calls Wire directly
+    bool acquire(TickType_t timeout = portMAX_DELAY);
+    void release();
+
+    // TCA9548A at address (0x70-0x77); call once, before devices behind it are used
+    void setMux(uint8_t address);
+    bool hasMux() const { return muxAddress_ != 0; }
+    // With the bus acquired: open channel (NO_CHANNEL leaves the mux as it is) for direct Wire use
+    bool selectChannel(int8_t channel);
+
+    TwoWire* wire() const { return wire_; }
+    bool isRunning() const { return task_ != nullptr; }
+    Stats getStats() const;
+
+private:
+    struct Pending {
+        Transaction transaction;
+        int64_t submittedUs;
+    };
+
+    TwoWire* wire_;
+    QueueHandle_t queues_[PRIORITY_LEVELS];
+    SemaphoreHandle_t pending_;  // Counts queued transactions across all levels
+    SemaphoreHandle_t busMutex_; // Held by the bus task per transaction and by acquire()
+    TaskHandle_t task_;
+    std::atomic<bool> stopRequested_; // Asks the bus task to exit after its current transaction
+    std::atomic<bool> taskRunning_;
+    uint8_t muxAddress_;         // 0 = no mux
+    int8_t muxChannel_;          // Open channel, guarded by busMutex_; NO_CHANNEL = unknown
+
+    std::atomic<uint32_t> completed_;
+    std::atomic<uint32_t> failed_;
+    std::atomic<uint32_t> rejected_;
+    std::atomic<uint32_t> maxLatencyUs_;
+
+    static void busTask(void* parameter);
+    bool execute(const Transaction& transaction);
+    void complete(const Pending& pending, bool ok);
+};
+
+#endif // I2C_BUS_H
@@ -0,0 +1,347 @@
+#include "Log.h"
+#include <Arduino.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+static_assert((LOG_RING_SLOTS & (LOG_RING_SLOTS - 1)) == 0, "LOG_RING_SLOTS must be a power of two");
+static_assert(LOG_PAYLOAD_SIZE <= 255, "LOG_PAYLOAD_SIZE must fit the uint8_t payload length");
+
+namespace {
+
+// Bounded MPMC queue (Vyukov) used with a single consumer. A slot's sequence equals the
+// enqueue position when free and position + 1 once its record is ready to drain.
+struct Slot {
+    std::atomic<uint32_t> sequence;
+    Log::Record record;
+};
+
+struct Ring {
+    Slot slots[LOG_RING_SLOTS];
+    std::atomic<uint32_t> enqueuePos;
+    uint32_t dequeuePos; // Drain side only
+    std::atomic<uint32_t> dropped;
+
+    Ring() : enqueuePos(0), dequeuePos(0), dropped(0) {
+        for (uint32_t i = 0; i < LOG_RING_SLOTS; i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+};
+
+Ring ring;
+SemaphoreHandle_t drainMutex = nullptr; // Serializes drain() callers (task and manual flushes)
+TaskHandle_t drainTaskHandle = nullptr;
+uint32_t drainIntervalMs = 20;
+
+const char* const LEVEL_NAMES[] = {"", "E", "W", "I", "D", "T"};
+const char* const MODULE_NAMES[] = {"System", "NetworkLayer", "DataLayer", "Bluetooth",
+                                    "MPU", "LED", "MeasurementApp", "Camera", "LoadGen", "I2cBus",
+                                    "FusionApp"};
+const size_t LINE_SIZE = 256;
+const uint8_t ARGS_TRUNCATED = 0x80; // Flag in Record::argCount
+
+// Append to out at pos, keeping room for the terminator
+size_t appendText(char* out, size_t capacity, size_t pos, const char* text, size_t len) {
+    size_t room = (pos + 1 < capacity) ? capacity - 1 - pos : 0;
+    if (len > room) {
+        len = room;
+    }
+    memcpy(out + pos, text, len);
+    return pos + len;
+}
+
+}
+
+Log::Record* Log::claim() {
+    uint32_t pos = ring.enqueuePos.load(std::memory_order_relaxed);
+    while (true) {
+        Slot& slot = ring.slots[pos & (LOG_RING_SLOTS - 1)];
+        uint32_t sequence = slot.sequence.load(std::memory_order_acquire);
+        int32_t diff = (int32_t)(sequence - pos);
+
+        if (diff == 0) {
+            if (ring.enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                slot.record.timestampMs = millis();
+                return &slot.record;
+            }
+        } else if (diff < 0) {
+            // Full: drop rather than wait for the drain task
+            ring.dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        } else {
+            pos = ring.enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void Log::commit(Record* record) {
+    // The record is the second member, so step back to its slot
+    Slot* slot = reinterpret_cast<Slot*>(reinterpret_cast<uint8_t*>(record) - offsetof(Slot, record));
+    uint32_t pos = slot->sequence.load(std::memory_order_relaxed);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+}
+
+uint8_t Log::moduleIndex(uint32_t module) {
+    uint8_t index = 0;
+    while (module > 1) {
+        module >>= 1;
+        index++;
+    }
+    return index;
+}
+
+void Log::putInt(Record& record, int64_t value) {
+    putBytes(record, ARG_INT, reinterpret_cast<const uint8_t*>(&value), sizeof(value));
+}
+
+void Log::putUint(Record& record, uint64_t value) {
+    putBytes(record, ARG_UINT, reinterpret_cast<const uint8_t*>(&value), sizeof(value));
+}
+
+void Log::putDouble(Record& record, double value) {
+    putBytes(record, ARG_DOUBLE, reinterpret_cast<const uint8_t*>(&value), sizeof(value));
+}
+
+void Log::putPointer(Record& record, const void* value) {
+    uint64_t address = reinterpret_cast<uintptr_t>(value);
+    putBytes(record, ARG_POINTER, reinterpret_cast<const uint8_t*>(&address), sizeof(address));
+}
+
+// Scalars are type(1) + 8 bytes; strings and hex are type(1) + len(1) + bytes, truncated to fit.
+// Once an argument doesn't fit, it and all later ones are dropped and their conversions printed verbatim.
+void Log::putBytes(Record& record, ArgType type, const uint8_t* data, size_t len) {
+    bool variable = (type == ARG_STRING || type == ARG_HEX);
+    size_t header = variable ? 2 : 1;
+    size_t room = LOG_PAYLOAD_SIZE - record.payloadLen;
+
+    if ((record.argCount & ARGS_TRUNCATED) != 0) {
+        return;
+    }
+    if (room < header + (variable ? 0 : len)) {
+        record.argCount |= ARGS_TRUNCATED; // Keep later arguments from shifting into this slot
+        return;
+    }
+    if (variable && len > room - header) {
+        len = room - header;
+    }
+
+    uint8_t* out = record.payload + record.payloadLen;
+    out[0] = type;
+    if (variable) {
+        out[1] = (uint8_t)len;
+    }
+    memcpy(out + header, data, len);
+    record.payloadLen += header + len;
+    record.argCount++;
+}
+
+void Log::encodeArg(Record& record, const char* value) {
+    if (value == nullptr) {
+        value = "(null)";
+    }
+    putBytes(record, ARG_STRING, reinterpret_cast<const uint8_t*>(value), strlen(value));
+}
+
+void Log::encodeArg(Record& record, const std::string& value) {
+    putBytes(record, ARG_STRING, reinterpret_cast<const uint8_t*>(value.data()), value.size());
+}
+
+void Log::encodeArg(Record& record, const LogHex& value) {
+    putBytes(record, ARG_HEX, value.data, value.data != nullptr ? value.len : 0);
+}
+
+size_t Log::format(const Record& record, char* out, size_t capacity) {
+    if (capacity == 0) {
+        return 0;
+    }
+
+    char piece[64];
+    int n = snprintf(piece, sizeof(piece), "%s %lu [%s] ",
+                     LEVEL_NAMES[record.level <= LOG_LEVEL_TRACE ? record.level : 0],
+                     (unsigned long)record.timestampMs,
+                     record.module < sizeof(MODULE_NAMES) / sizeof(MODULE_NAMES[0]) ? MODULE_NAMES[record.module] : "?");
+    size_t pos = appendText(out, capacity, 0, piece, n > 0 ? (size_t)n : 0);
+
+    const uint8_t* arg = record.payload;
+    const uint8_t* argEnd = record.payload + record.payloadLen;
+    const char* fmt = record.fmt;
+
+    while (*fmt != '\0') {
+        if (*fmt != '%') {
+            const char* literal = fmt;
+            while (*fmt != '\0' && *fmt != '%') {
+                fmt++;
+            }
+            pos = appendText(out, capacity, pos, literal, fmt - literal);
+            continue;
+        }
+
+        if (fmt[1] == '%') {
+            pos = appendText(out, capacity, pos, "%", 1);
+            fmt += 2;
+            continue;
+        }
+
+        // Split the conversion into flags/width/precision (kept) and length modifiers (replaced)
+        const char* specStart = fmt++;
+        while (*fmt != '\0' && strchr("-+ #0123456789.", *fmt) != nullptr) {
+            fmt++;
+        }
+        size_t prefixLen = fmt - specStart;
+        while (*fmt != '\0' && strchr("hlLqjzt", *fmt) != nullptr) {
+            fmt++;
+        }
+        char conversion = *fmt;
+        if (conversion == '\0' || arg >= argEnd || prefixLen > 16) {
+            // Missing argument or malformed spec: print it as written
+            pos = appendText(out, capacity, pos, specStart, (conversion == '\0' ? fmt : fmt + 1) - specStart);
+            if (conversion != '\0') {
+                fmt++;
+            }
+            continue;
+        }
+        fmt++;
+
+        char spec[24];
+        memcpy(spec, specStart, prefixLen);
+        uint8_t type = *arg++;
+        n = 0;
+
+        if (type == ARG_STRING || type == ARG_HEX) {
+            size_t len = *arg++;
+            if (type == ARG_HEX) {
+                for (size_t i = 0; i < len; i++) {
+                    n = snprintf(piece, sizeof(piece), i == 0 ? "%02X" : " %02X", arg[i]);
+                    pos = appendText(out, capacity, pos, piece, n);
+                }
+                n = 0;
+            } else if (prefixLen == 1) {
+                pos = appendText(out, capacity, pos, (const char*)arg, len);
+            } else {
+                // Width/precision given; the payload copy isn't NUL-terminated
+                char text[LOG_PAYLOAD_SIZE + 1];
+                memcpy(text, arg, len);
+                text[len] = '\0';
+                spec[prefixLen] = 's';
+                spec[prefixLen + 1] = '\0';
+                n = snprintf(piece, sizeof(piece), spec, text);
+            }
+            arg += len;
+        } else {
+            uint64_t raw;
+            memcpy(&raw, arg, sizeof(raw));
+            arg += sizeof(raw);
+
+            if (type == ARG_DOUBLE) {
+                double value;
+                memcpy(&value, &raw, sizeof(value));
+                if (strchr("fFeEgGaA", conversion) != nullptr) {
+                    spec[prefixLen] = conversion;
+                    spec[prefixLen + 1] = '\0';
+                    n = snprintf(piece, sizeof(piece), spec, value);
+                } else {
+                    memcpy(spec + prefixLen, "lld", 4);
+                    n = snprintf(piece, sizeof(piece), spec, (long long)value);
+                }
+            } else if (type == ARG_POINTER || conversion == 'p') {
+                n = snprintf(piece, sizeof(piece), "%p", (void*)(uintptr_t)raw);
+            } else if (conversion == 'c') {
+                spec[prefixLen] = 'c';
+                spec[prefixLen + 1] = '\0';
+                n = snprintf(piece, sizeof(piece), spec, (int)raw);
+            } else if (strchr("fFeEgGaA", conversion) != nullptr) {
+                spec[prefixLen] = conversion;
+                spec[prefixLen + 1] = '\0';
+                double value = (type == ARG_INT) ? (double)(int64_t)raw : (double)raw;
+                n = snprintf(piece, sizeof(piece), spec, value);
+            } else {
+                bool isSigned = (conversion == 'd' || conversion == 'i');
+                spec[prefixLen] = 'l';
+                spec[prefixLen + 1] = 'l';
+                spec[prefixLen + 2] = strchr("diouxX", conversion) != nullptr ? conversion : 'd';
+                spec[prefixLen + 3] = '\0';
+                if (isSigned || conversion == 's') {
+                    n = snprintf(piece, sizeof(piece), spec, (long long)(int64_t)raw);
+                } else {
+                    n = snprintf(piece, sizeof(piece), spec, (unsigned long long)raw);
+                }
+            }
+        }
+
+        if (n > 0) {
+            pos = appendText(out, capacity, pos, piece, std::min((size_t)n, sizeof(piece) - 1));
+        }
+    }
+
+    out[pos] = '\0';
+    return pos;
+}
+
+size_t Log::drain() {
+    if (drainMutex != nullptr && xSemaphoreTake(drainMutex, portMAX_DELAY) != pdTRUE) {
+        return 0;
+    }
+
+    char line[LINE_SIZE];
+    size_t drained = 0;
+    while (true) {
+        Slot& slot = ring.slots[ring.dequeuePos & (LOG_RING_SLOTS - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != ring.dequeuePos + 1) {
+            break; // Empty, or the next writer hasn't committed yet
+        }
+
+        format(slot.record, line, sizeof(line));
+        slot.sequence.store(ring.dequeuePos + LOG_RING_SLOTS, std::memory_order_release);
+        ring.dequeuePos++;
+        drained++;
+
+        // Only this task ever blocks on the UART
+        Serial.println(line);
+    }
+
+    if (drainMutex != nullptr) {
+        xSemaphoreGive(drainMutex);
+    }
+    return drained;
+}
+
+uint32_t Log::dropped() {
+    return ring.dropped.load(std::memory_order_relaxed);
+}
+
+bool Log::begin(UBaseType_t taskPriority, uint32_t taskStackSize, uint32_t intervalMs) {
+    if (drainTaskHandle != nullptr) {
+        return true;
+    }
+
+    drainMutex = xSemaphoreCreateMutex();
+    if (drainMutex == nullptr) {
+        return false;
+    }
+
+    drainIntervalMs = intervalMs;
+    if (xTaskCreate(drainTask, "LogDrain", taskStackSize, nullptr, taskPriority, &drainTaskHandle) != pdPASS) {
+        Serial.println("[Log] Failed to create drain task");
+        drainTaskHandle = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void Log::drainTask(void* parameter) {
+    (void)parameter;
+    uint32_t lastDropped = 0;
+
+    while (true) {
+        drain();
+
+        uint32_t droppedNow = dropped();
+        if (droppedNow != lastDropped) {
+            Serial.printf("[Log] Dropped %lu records (ring full)\n", (unsigned long)(droppedNow - lastDropped));
+            lastDropped = droppedNow;
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(drainIntervalMs));
+    }
+}
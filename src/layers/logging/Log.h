@@ -0,0 +1,186 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <type_traits>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// Structured async logging.
+//
+// LOG_* macros capture the format pointer and the arguments as tagged binary values into a
+// lock-free ring; a low-priority drain task formats them and writes to Serial. A full ring
+// drops the record (and counts it) instead of blocking, so sensor and radio tasks never wait
+// on the UART. Level and module filters are compile-time constants: a filtered-out call
+// compiles to nothing and its arguments are never evaluated.
+//
+// Build flags:
+//   -DLOG_LEVEL=LOG_LEVEL_DEBUG        Most verbose level kept (default LOG_LEVEL_INFO)
+//   -DLOG_MODULE_MASK=0x0003           Modules kept (default all)
+//   -DLOG_RING_SLOTS=64                Ring size, power of two
+//   -DLOG_PAYLOAD_SIZE=96              Argument bytes per record; longer strings are truncated
+//
+// Format strings use printf conversions and must be string literals (only the pointer is stored).
+// Wrap binary buffers in LogHex(data, len) and print them with %s as a hex dump.
+
+#define LOG_LEVEL_NONE  0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_INFO  3
+#define LOG_LEVEL_DEBUG 4
+#define LOG_LEVEL_TRACE 5
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+#define LOG_MODULE_SYSTEM      (1u << 0)
+#define LOG_MODULE_NETWORK     (1u << 1)
+#define LOG_MODULE_DATA        (1u << 2)
+#define LOG_MODULE_BLUETOOTH   (1u << 3)
+#define LOG_MODULE_MPU         (1u << 4)
+#define LOG_MODULE_LED         (1u << 5)
+#define LOG_MODULE_MEASUREMENT (1u << 6)
+#define LOG_MODULE_CAMERA      (1u << 7)
+#define LOG_MODULE_LOADGEN     (1u << 8)
+#define LOG_MODULE_I2C         (1u << 9)
+#define LOG_MODULE_FUSION      (1u << 10)
+
+#ifndef LOG_MODULE_MASK
+#define LOG_MODULE_MASK 0xFFFFFFFFu
+#endif
+
+#ifndef LOG_RING_SLOTS
+#define LOG_RING_SLOTS 64
+#endif
+
+#ifndef LOG_PAYLOAD_SIZE
+#define LOG_PAYLOAD_SIZE 96
+#endif
+
+#define LOG_ENABLED(level, module) ((level) <= LOG_LEVEL && ((module) & (LOG_MODULE_MASK)) != 0)
+
+#define LOG_AT(level, module, fmt, ...)                                  \
+    do {                                                                 \
+        if (LOG_ENABLED(level, module)) {                                \
+            Log::write((level), (module), fmt, ##__VA_ARGS__);           \
+        }                                                                \
+    } while (0)
+
+#define LOG_ERROR(module, fmt, ...) LOG_AT(LOG_LEVEL_ERROR, LOG_MODULE_##module, fmt, ##__VA_ARGS__)
+#define LOG_WARN(module, fmt, ...)  LOG_AT(LOG_LEVEL_WARN, LOG_MODULE_##module, fmt, ##__VA_ARGS__)
+#define LOG_INFO(module, fmt, ...)  LOG_AT(LOG_LEVEL_INFO, LOG_MODULE_##module, fmt, ##__VA_ARGS__)
+#define LOG_DEBUG(module, fmt, ...) LOG_AT(LOG_LEVEL_DEBUG, LOG_MODULE_##module, fmt, ##__VA_ARGS__)
+#define LOG_TRACE(module, fmt, ...) LOG_AT(LOG_LEVEL_TRACE, LOG_MODULE_##module, fmt, ##__VA_ARGS__)
+
+// Binary buffer argument, rendered as "AA BB CC" (truncated to fit the record)
+struct LogHex {
+    const uint8_t* data;
+    size_t len;
+    LogHex(const uint8_t* d, size_t n) : data(d), len(n) {}
+};
+
+class Log {
+public:
+    enum ArgType : uint8_t {
+        ARG_INT = 1,
+        ARG_UINT,
+        ARG_DOUBLE,
+        ARG_STRING,
+        ARG_HEX,
+        ARG_POINTER
+    };
+
+    struct Record {
+        uint32_t timestampMs;
+        const char* fmt;
+        uint8_t level;
+        uint8_t module; // Bit index of the module flag
+        uint8_t argCount;
+        uint8_t payloadLen;
+        uint8_t payload[LOG_PAYLOAD_SIZE]; // type(1) then value; strings and hex are len(1) + bytes
+    };
+
+    // Start the drain task; records written earlier wait in the ring
+    static bool begin(UBaseType_t taskPriority = 1, uint32_t taskStackSize = 4096, uint32_t drainIntervalMs = 20);
+
+    // Records dropped because the ring was full
+    static uint32_t dropped();
+
+    // Format and emit everything currently in the ring (also used by the drain task)
+    static size_t drain();
+
+    template <typename... Args>
+    static void write(uint8_t level, uint32_t module, const char* fmt, const Args&... args) {
+        Record* record = claim();
+        if (record == nullptr) {
+            return;
+        }
+        record->level = level;
+        record->module = moduleIndex(module);
+        record->fmt = fmt;
+        record->argCount = 0;
+        record->payloadLen = 0;
+        encodeArgs(*record, args...);
+        commit(record);
+    }
+
+    // Render one record into out (always NUL-terminated); exposed for tests and replay tools
+    static size_t format(const Record& record, char* out, size_t capacity);
+
+private:
+    static Record* claim();
+    static void commit(Record* record);
+    static void drainTask(void* parameter);
+    static uint8_t moduleIndex(uint32_t module);
+
+    static void putInt(Record& record, int64_t value);
+    static void putUint(Record& record, uint64_t value);
+    static void putDouble(Record& record, double value);
+    static void putPointer(Record& record, const void* value);
+    static void putBytes(Record& record, ArgType type, const uint8_t* data, size_t len);
+
+    static void encodeArgs(Record&) {}
+
+    template <typename T, typename... Rest>
+    static void encodeArgs(Record& record, const T& first, const Rest&... rest) {
+        encodeArg(record, first);
+        encodeArgs(record, rest...);
+    }
+
+    static void encodeArg(Record& record, const char* value);
+    static void encodeArg(Record& record, const std::string& value);
+    static void encodeArg(Record& record, const LogHex& value);
+
+    template <typename T>
+    static typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type
+    encodeArg(Record& record, T value) {
+        putInt(record, value);
+    }
+
+    template <typename T>
+    static typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type
+    encodeArg(Record& record, T value) {
+        putUint(record, value);
+    }
+
+    template <typename T>
+    static typename std::enable_if<std::is_enum<T>::value>::type encodeArg(Record& record, T value) {
+        putInt(record, static_cast<int64_t>(value));
+    }
+
+    template <typename T>
+    static typename std::enable_if<std::is_floating_point<T>::value>::type encodeArg(Record& record, T value) {
+        putDouble(record, value);
+    }
+
+    template <typename T>
+    static void encodeArg(Record& record, const T* value) {
+        putPointer(record, value);
+    }
+};
+
+#endif // LOG_H
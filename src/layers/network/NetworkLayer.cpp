@@ -1,10 +1,13 @@
 #include "NetworkLayer.h"
 #include <algorithm>
 #include <Arduino.h> // For Serial debugging
+#include "../logging/Log.h"
 
 NetworkLayer::NetworkLayer() :
     subscribersMutex_(nullptr),
-    initialized_(false) {
+    initialized_(false),
+    tap_(nullptr),
+    tapCalls_(0) {
     Serial.println("[NetworkLayer] Topic-based message broker created");
 }
 
@@ -110,14 +113,15 @@ bool NetworkLayer::publish(const std::string& topic, const uint8_t* data, size_t
         return false;
     }
 
-    // Debug: Show what we're publishing
-    if (topic == "bluetooth/command") {
-        Serial.printf("[NetworkLayer] Publishing to %s: ", topic.c_str());
-        for (size_t i = 0; i < len && i < 10; i++) {
-            Serial.printf("%02X ", data[i]);
-        }
-        Serial.printf("(%d bytes)\n", len);
+    LOG_TRACE(NETWORK, "Publishing to %s: %s (%u bytes)", topic, LogHex(data, std::min(len, (size_t)10)), len);
+
+    // Counted before the tap is loaded, so setTap(nullptr) can wait for every call that saw it
+    tapCalls_.fetch_add(1);
+    Tap* tap = tap_.load();
+    if (tap != nullptr) {
+        tap->onPublish(topic, data, len, publisher);
     }
+    tapCalls_.fetch_sub(1, std::memory_order_release);
 
     // Copy data to heap so it remains valid for the delivery task
     uint8_t* dataCopy = new uint8_t[len];
@@ -207,6 +211,20 @@ std::vector<std::string> NetworkLayer::getTopics() const {
     return topics;
 }
 
+bool NetworkLayer::setTap(Tap* tap) {
+    if (tap == nullptr) {
+        // Sequentially consistent with publish(): a publisher either sees nullptr or is counted
+        tap_.store(nullptr);
+        while (tapCalls_.load(std::memory_order_acquire) > 0) {
+            vTaskDelay(pdMS_TO_TICKS(1));
+        }
+        return true;
+    }
+
+    Tap* expected = nullptr;
+    return tap_.compare_exchange_strong(expected, tap, std::memory_order_acq_rel) || expected == tap;
+}
+
 void NetworkLayer::deliverMessage(const std::string& topic, const uint8_t* data, size_t len) {
     // Take mutex to protect subscriber list during iteration
     if (xSemaphoreTake(subscribersMutex_, portMAX_DELAY) != pdTRUE) {
@@ -219,14 +237,8 @@ void NetworkLayer::deliverMessage(const std::string& topic, const uint8_t* data,
         // Create a copy of subscribers to avoid issues if callbacks modify subscriptions
         auto subscribersCopy = topicIt->second;
 
-        // Debug: Show what we're delivering
-        if (topic == "bluetooth/command") {
-            Serial.printf("[NetworkLayer] Delivering to %d subscribers of %s: ", subscribersCopy.size(), topic.c_str());
-            for (size_t i = 0; i < len && i < 10; i++) {
-                Serial.printf("%02X ", data[i]);
-            }
-            Serial.printf("(%d bytes)\n", len);
-        }
+        LOG_TRACE(NETWORK, "Delivering to %u subscribers of %s: %s (%u bytes)", subscribersCopy.size(), topic,
+                  LogHex(data, std::min(len, (size_t)10)), len);
 
         // Serial.printf("[NetworkLayer] Delivering to %d subscribers of %s\n",
         //               subscribersCopy.size(), topic.c_str());
@@ -3,6 +3,7 @@
 
 #include <cstdint>
 #include <cstddef>
+#include <atomic>
 #include <vector>
 #include <string>
 #include <functional>
@@ -18,6 +19,15 @@ public:
     // Topic-based message broker API
     using MessageCallback = std::function<void(const uint8_t* data, size_t len, const std::string& topic)>;
 
+    // Observer of every accepted publish, called inline on the publishing task before the
+    // message is handed to delivery. Keep onPublish short and non-blocking.
+    class Tap {
+    public:
+        virtual ~Tap() {}
+        virtual void onPublish(const std::string& topic, const uint8_t* data, size_t len,
+                               const std::string& publisher) = 0;
+    };
+
     // Initialize the network layer
     bool init();
 
@@ -39,11 +49,19 @@ public:
     // List all available topics
     std::vector<std::string> getTopics() const;
 
+    // Install a publish tap (one at a time, nullptr removes it). Returns false if another tap
+    // is already installed. Removing waits until no publish is still inside onPublish, so the
+    // tap may be destroyed once setTap(nullptr) returns; don't remove it from its own onPublish.
+    bool setTap(Tap* tap);
+    bool hasTap() const { return tap_.load(std::memory_order_acquire) != nullptr; }
+
 private:
     // Thread-safe subscriber management
     SemaphoreHandle_t subscribersMutex_;
     std::unordered_map<std::string, std::unordered_map<std::string, MessageCallback>> subscribers_;
     bool initialized_;
+    std::atomic<Tap*> tap_;
+    std::atomic<uint32_t> tapCalls_; // publish() calls between loading tap_ and leaving onPublish
 
     // Helper method to deliver message to all subscribers of a topic
     void deliverMessage(const std::string& topic, const uint8_t* data, size_t len);
@@ -0,0 +1,62 @@
+#ifndef TRAFFIC_LOG_H
+#define TRAFFIC_LOG_H
+
+#include <cstdint>
+#include <cstddef>
+
+// Binary format shared by TrafficRecorder and TrafficReplayer.
+//
+// Header (16 bytes, little-endian):
+//   magic "TRFC" | version u8 | reserved[3] | messageCount u32 | crc32 u32 (over the records)
+//
+// Records follow back to back:
+//   varint deltaUs   Time since the previous record (first record: since recording started)
+//   varint topicRef  1-based index of an earlier topic, or 0 for a new topic followed by
+//                    varint nameLen + name bytes (it becomes the next index)
+//   varint len       Payload length, then the payload bytes
+//
+// Varints are unsigned LEB128, so a typical sensor record costs 4-5 bytes of framing.
+namespace TrafficLog {
+
+static const uint8_t MAGIC[4] = { 'T', 'R', 'F', 'C' };
+static const uint8_t VERSION = 1;
+static const size_t HEADER_SIZE = 16;
+static const size_t MAX_VARINT_SIZE = 10;
+
+inline size_t putVarint(uint8_t* out, uint64_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = static_cast<uint8_t>(value);
+    return n;
+}
+
+// Returns bytes consumed, 0 if the varint is truncated or too long
+inline size_t getVarint(const uint8_t* in, size_t avail, uint64_t& value) {
+    value = 0;
+    for (size_t i = 0; i < avail && i < MAX_VARINT_SIZE; i++) {
+        value |= static_cast<uint64_t>(in[i] & 0x7F) << (7 * i);
+        if ((in[i] & 0x80) == 0) {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+inline void putU32(uint8_t* out, uint32_t value) {
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+    out[2] = static_cast<uint8_t>(value >> 16);
+    out[3] = static_cast<uint8_t>(value >> 24);
+}
+
+inline uint32_t getU32(const uint8_t* in) {
+    return static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8) |
+           (static_cast<uint32_t>(in[2]) << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+
+} // namespace TrafficLog
+
+#endif // TRAFFIC_LOG_H
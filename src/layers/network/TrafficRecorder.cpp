@@ -0,0 +1,199 @@
+#include "TrafficRecorder.h"
+#include "TrafficLog.h"
+#include "../data/Crc32.h"
+#include "../logging/Log.h"
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <cstdlib>
+#include <cstring>
+#ifdef ESP_PLATFORM
+#include <esp_heap_caps.h>
+#endif
+
+TrafficRecorder::TrafficRecorder(size_t capacityBytes, bool usePsram)
+    : buffer_(nullptr),
+      capacity_(capacityBytes),
+      size_(TrafficLog::HEADER_SIZE),
+      mutex_(nullptr),
+      network_(nullptr),
+      lastUs_(0),
+      messageCount_(0),
+      droppedCount_(0) {
+    if (capacityBytes <= TrafficLog::HEADER_SIZE) {
+        return;
+    }
+
+#ifdef ESP_PLATFORM
+    if (usePsram) {
+        buffer_ = static_cast<uint8_t*>(heap_caps_malloc(capacityBytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT));
+        if (buffer_ == nullptr) {
+            Serial.println("[TrafficRecorder] PSRAM allocation failed, falling back to internal RAM");
+        }
+    }
+#endif
+    if (buffer_ == nullptr) {
+        buffer_ = static_cast<uint8_t*>(malloc(capacityBytes));
+    }
+
+    if (buffer_ == nullptr) {
+        Serial.printf("[TrafficRecorder] Failed to allocate %u bytes\n", (unsigned)capacityBytes);
+        return;
+    }
+
+    mutex_ = xSemaphoreCreateMutex();
+}
+
+TrafficRecorder::~TrafficRecorder() {
+    stop();
+    if (mutex_ != nullptr) {
+        vSemaphoreDelete(mutex_);
+        mutex_ = nullptr;
+    }
+    free(buffer_); // heap_caps_malloc memory is released with free() too
+    buffer_ = nullptr;
+}
+
+bool TrafficRecorder::start(NetworkLayer* network) {
+    if (!isValid() || network == nullptr || isRecording()) {
+        return false;
+    }
+
+    xSemaphoreTake(mutex_, portMAX_DELAY);
+    size_ = TrafficLog::HEADER_SIZE;
+    topicIds_.clear();
+    messageCount_ = 0;
+    droppedCount_ = 0;
+    lastUs_ = esp_timer_get_time();
+    network_ = network;
+    xSemaphoreGive(mutex_);
+
+    if (!network->setTap(this)) {
+        Serial.println("[TrafficRecorder] Another tap is already installed");
+        xSemaphoreTake(mutex_, portMAX_DELAY);
+        network_ = nullptr;
+        xSemaphoreGive(mutex_);
+        return false;
+    }
+
+    LOG_INFO(NETWORK, "Traffic recording started (%u bytes)", capacity_);
+    return true;
+}
+
+void TrafficRecorder::stop() {
+    if (!isRecording()) {
+        return;
+    }
+
+    // Returns once no publish is still inside onPublish
+    network_->setTap(nullptr);
+
+    xSemaphoreTake(mutex_, portMAX_DELAY);
+    network_ = nullptr;
+    xSemaphoreGive(mutex_);
+
+    LOG_INFO(NETWORK, "Traffic recording stopped: %u messages, %u bytes, %u dropped", messageCount_, size_,
+             droppedCount_);
+}
+
+void TrafficRecorder::onPublish(const std::string& topic, const uint8_t* data, size_t len,
+                                const std::string& publisher) {
+    if (!ignoredPublisher_.empty() && publisher == ignoredPublisher_) {
+        return;
+    }
+
+    int64_t now = esp_timer_get_time();
+    uint8_t framing[3 * TrafficLog::MAX_VARINT_SIZE];
+    uint8_t lenField[TrafficLog::MAX_VARINT_SIZE];
+
+    xSemaphoreTake(mutex_, portMAX_DELAY);
+    if (network_ == nullptr) {
+        xSemaphoreGive(mutex_);
+        return;
+    }
+
+    // Timestamps from different publishing tasks can arrive slightly out of order
+    uint64_t delta = now > lastUs_ ? static_cast<uint64_t>(now - lastUs_) : 0;
+
+    auto it = topicIds_.find(topic);
+    uint32_t topicRef = it != topicIds_.end() ? it->second : 0;
+
+    size_t n = TrafficLog::putVarint(framing, delta);
+    n += TrafficLog::putVarint(framing + n, topicRef);
+    if (topicRef == 0) {
+        n += TrafficLog::putVarint(framing + n, topic.size());
+    }
+    size_t nameLen = topicRef == 0 ? topic.size() : 0;
+    size_t lenBytes = TrafficLog::putVarint(lenField, len);
+
+    size_t total = n + nameLen + lenBytes + len;
+    if (total > capacity_ - size_) {
+        droppedCount_++;
+        xSemaphoreGive(mutex_);
+        return;
+    }
+
+    uint8_t* out = buffer_ + size_;
+    memcpy(out, framing, n);
+    out += n;
+    if (topicRef == 0) {
+        memcpy(out, topic.data(), nameLen);
+        out += nameLen;
+        topicIds_[topic] = static_cast<uint32_t>(topicIds_.size() + 1);
+    }
+    memcpy(out, lenField, lenBytes);
+    out += lenBytes;
+    memcpy(out, data, len);
+
+    size_ += total;
+    if (now > lastUs_) {
+        lastUs_ = now;
+    }
+    messageCount_++;
+    xSemaphoreGive(mutex_);
+}
+
+void TrafficRecorder::finalizeHeader() {
+    memcpy(buffer_, TrafficLog::MAGIC, sizeof(TrafficLog::MAGIC));
+    buffer_[4] = TrafficLog::VERSION;
+    buffer_[5] = 0;
+    buffer_[6] = 0;
+    buffer_[7] = 0;
+    TrafficLog::putU32(buffer_ + 8, messageCount_);
+    TrafficLog::putU32(buffer_ + 12,
+                       crc32(buffer_ + TrafficLog::HEADER_SIZE, size_ - TrafficLog::HEADER_SIZE));
+}
+
+bool TrafficRecorder::copyTo(std::vector<uint8_t>& out) {
+    if (!isValid()) {
+        return false;
+    }
+
+    xSemaphoreTake(mutex_, portMAX_DELAY);
+    finalizeHeader();
+    out.assign(buffer_, buffer_ + size_);
+    xSemaphoreGive(mutex_);
+    return true;
+}
+
+bool TrafficRecorder::save(StorageBackend* storage, const std::string& path) {
+    if (!isValid() || storage == nullptr || path.empty()) {
+        return false;
+    }
+
+    // Write beside the target and rename, so a reset mid-write keeps the previous log
+    std::string tmpPath = path + ".tmp";
+
+    xSemaphoreTake(mutex_, portMAX_DELAY);
+    finalizeHeader();
+    bool ok = storage->writeFile(tmpPath, buffer_, size_);
+    size_t written = size_;
+    xSemaphoreGive(mutex_);
+
+    if (!ok || !storage->renameFile(tmpPath, path)) {
+        Serial.printf("[TrafficRecorder] Failed to save %s\n", path.c_str());
+        return false;
+    }
+
+    LOG_INFO(NETWORK, "Traffic log saved to %s (%u bytes)", path, written);
+    return true;
+}
@@ -0,0 +1,68 @@
+#ifndef TRAFFIC_RECORDER_H
+#define TRAFFIC_RECORDER_H
+
+#include "NetworkLayer.h"
+#include "../data/persistence/StorageBackend.h"
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+// Captures every message published on a NetworkLayer into a fixed, preallocated buffer
+// (PSRAM when available) using the compact format in TrafficLog.h. Recording runs inline in
+// publish(), so it only appends and never allocates per message; when the buffer is full
+// further messages are counted as dropped. The result can be saved through any
+// StorageBackend (LittleFS on the device, a host directory natively) or copied out and
+// handed to a TrafficReplayer.
+class TrafficRecorder : public NetworkLayer::Tap {
+public:
+    explicit TrafficRecorder(size_t capacityBytes, bool usePsram = true);
+    ~TrafficRecorder();
+
+    bool isValid() const { return buffer_ != nullptr && mutex_ != nullptr; }
+
+    // Clear the buffer and install the recorder as the network's tap
+    bool start(NetworkLayer* network);
+
+    // Remove the tap; the recording stays available until the next start()
+    void stop();
+
+    bool isRecording() const { return network_ != nullptr; }
+
+    // Messages sent by this publisher are not recorded, so a replay can run while recording
+    void setIgnoredPublisher(const std::string& publisher) { ignoredPublisher_ = publisher; }
+
+    // Complete log (header + records) for TrafficReplayer::load()
+    bool copyTo(std::vector<uint8_t>& out);
+
+    // Write the complete log to path, replacing any existing file
+    bool save(StorageBackend* storage, const std::string& path);
+
+    uint32_t messageCount() const { return messageCount_; }
+    uint32_t droppedCount() const { return droppedCount_; }
+    size_t bytesUsed() const { return size_; }
+    size_t capacity() const { return capacity_; }
+
+    void onPublish(const std::string& topic, const uint8_t* data, size_t len, const std::string& publisher) override;
+
+private:
+    uint8_t* buffer_;
+    size_t capacity_;
+    size_t size_;
+    SemaphoreHandle_t mutex_;
+    NetworkLayer* network_;
+    std::string ignoredPublisher_;
+
+    std::unordered_map<std::string, uint32_t> topicIds_;
+    int64_t lastUs_;
+    uint32_t messageCount_;
+    uint32_t droppedCount_;
+
+    // Fill in the header for the records written so far (mutex held)
+    void finalizeHeader();
+};
+
+#endif // TRAFFIC_RECORDER_H
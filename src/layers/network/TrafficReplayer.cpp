@@ -0,0 +1,215 @@
+#include "TrafficReplayer.h"
+#include "TrafficLog.h"
+#include "../data/Crc32.h"
+#include "../logging/Log.h"
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <cstring>
+
+const char* const TrafficReplayer::PUBLISHER_NAME = "TrafficReplayer";
+
+// Longest single sleep, so stop() is noticed promptly during long gaps
+static const uint32_t MAX_SLEEP_MS = 100;
+
+TrafficReplayer::TrafficReplayer()
+    : messageCount_(0),
+      durationUs_(0),
+      running_(false),
+      stopRequested_(false),
+      network_(nullptr),
+      speed_(1.0f) {
+    memset(&stats_, 0, sizeof(stats_));
+}
+
+TrafficReplayer::~TrafficReplayer() {
+    stop();
+}
+
+bool TrafficReplayer::load(const uint8_t* data, size_t len) {
+    if (isRunning() || data == nullptr || len < TrafficLog::HEADER_SIZE) {
+        return false;
+    }
+
+    if (memcmp(data, TrafficLog::MAGIC, sizeof(TrafficLog::MAGIC)) != 0 || data[4] != TrafficLog::VERSION) {
+        Serial.println("[TrafficReplayer] Not a traffic log (bad magic or version)");
+        return false;
+    }
+    if (crc32(data + TrafficLog::HEADER_SIZE, len - TrafficLog::HEADER_SIZE) != TrafficLog::getU32(data + 12)) {
+        Serial.println("[TrafficReplayer] Traffic log CRC mismatch");
+        return false;
+    }
+
+    log_.assign(data, data + len);
+    topics_.clear();
+    messageCount_ = 0;
+    durationUs_ = 0;
+
+    if (!replay(nullptr, 0) || messageCount_ != TrafficLog::getU32(data + 8)) {
+        Serial.println("[TrafficReplayer] Traffic log records are corrupt");
+        log_.clear();
+        topics_.clear();
+        messageCount_ = 0;
+        durationUs_ = 0;
+        return false;
+    }
+
+    LOG_INFO(NETWORK, "Traffic log loaded: %u messages on %u topics over %u ms", messageCount_, topics_.size(),
+             (uint32_t)(durationUs_ / 1000));
+    return true;
+}
+
+bool TrafficReplayer::load(StorageBackend* storage, const std::string& path) {
+    if (storage == nullptr) {
+        return false;
+    }
+
+    std::vector<uint8_t> data;
+    if (!storage->readFile(path, data)) {
+        Serial.printf("[TrafficReplayer] Failed to read %s\n", path.c_str());
+        return false;
+    }
+    return load(data.data(), data.size());
+}
+
+bool TrafficReplayer::run(NetworkLayer* network, float speed) {
+    if (network == nullptr || !isLoaded() || speed < 0) {
+        return false;
+    }
+
+    bool expected = false;
+    if (!running_.compare_exchange_strong(expected, true)) {
+        return false;
+    }
+    stopRequested_.store(false);
+
+    bool ok = replay(network, speed);
+    running_.store(false);
+    return ok;
+}
+
+bool TrafficReplayer::start(NetworkLayer* network, float speed, UBaseType_t priority, uint32_t stackSize) {
+    if (network == nullptr || !isLoaded() || speed < 0) {
+        return false;
+    }
+
+    bool expected = false;
+    if (!running_.compare_exchange_strong(expected, true)) {
+        return false;
+    }
+    stopRequested_.store(false);
+    network_ = network;
+    speed_ = speed;
+
+    if (xTaskCreate(replayTask, "TrafficReplay", stackSize, this, priority, nullptr) != pdPASS) {
+        Serial.println("[TrafficReplayer] Failed to create replay task");
+        running_.store(false);
+        return false;
+    }
+    return true;
+}
+
+void TrafficReplayer::stop() {
+    stopRequested_.store(true);
+    while (running_.load()) {
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+}
+
+void TrafficReplayer::replayTask(void* parameter) {
+    TrafficReplayer* replayer = static_cast<TrafficReplayer*>(parameter);
+    replayer->replay(replayer->network_, replayer->speed_);
+    replayer->running_.store(false);
+    vTaskDelete(nullptr);
+}
+
+bool TrafficReplayer::replay(NetworkLayer* network, float speed) {
+    const uint8_t* p = log_.data() + TrafficLog::HEADER_SIZE;
+    const uint8_t* end = log_.data() + log_.size();
+    bool validating = network == nullptr;
+
+    uint64_t offsetUs = 0;
+    uint32_t count = 0;
+    int64_t startUs = esp_timer_get_time();
+    if (!validating) {
+        memset(&stats_, 0, sizeof(stats_));
+        LOG_INFO(NETWORK, "Replaying %u messages at %s", messageCount_, speed > 0 ? "scaled speed" : "max speed");
+    }
+
+    while (p < end) {
+        uint64_t delta = 0;
+        uint64_t topicRef = 0;
+        uint64_t len = 0;
+        size_t n;
+
+        if ((n = TrafficLog::getVarint(p, end - p, delta)) == 0) {
+            return false;
+        }
+        p += n;
+        if ((n = TrafficLog::getVarint(p, end - p, topicRef)) == 0) {
+            return false;
+        }
+        p += n;
+
+        if (topicRef == 0) {
+            uint64_t nameLen = 0;
+            if ((n = TrafficLog::getVarint(p, end - p, nameLen)) == 0 || nameLen == 0 ||
+                nameLen > (uint64_t)(end - p - n)) {
+                return false;
+            }
+            p += n;
+            if (validating) {
+                topics_.push_back(std::string(reinterpret_cast<const char*>(p), nameLen));
+            }
+            p += nameLen;
+            topicRef = topics_.size();
+        } else if (topicRef > topics_.size()) {
+            return false;
+        }
+
+        if ((n = TrafficLog::getVarint(p, end - p, len)) == 0 || len == 0 || len > (uint64_t)(end - p - n)) {
+            return false;
+        }
+        p += n;
+
+        offsetUs += delta;
+        count++;
+
+        if (!validating) {
+            if (speed > 0) {
+                int64_t dueUs = startUs + (int64_t)(offsetUs / speed);
+                int64_t waitUs = dueUs - esp_timer_get_time();
+                while (waitUs >= 1000 && !stopRequested_.load()) {
+                    uint32_t ms = (uint32_t)(waitUs / 1000);
+                    vTaskDelay(pdMS_TO_TICKS(ms < MAX_SLEEP_MS ? ms : MAX_SLEEP_MS));
+                    waitUs = dueUs - esp_timer_get_time();
+                }
+                if (waitUs < 0 && (uint64_t)-waitUs > stats_.maxLateUs) {
+                    stats_.maxLateUs = (uint32_t)-waitUs;
+                }
+            } else {
+                // Give the delivery tasks a turn so a flat-out replay doesn't pile up in-flight copies
+                taskYIELD();
+            }
+            if (stopRequested_.load()) {
+                break;
+            }
+
+            if (network->publish(topics_[topicRef - 1], p, (size_t)len, PUBLISHER_NAME)) {
+                stats_.published++;
+            } else {
+                stats_.failed++;
+            }
+        }
+        p += len;
+    }
+
+    if (validating) {
+        messageCount_ = count;
+        durationUs_ = offsetUs;
+    } else {
+        stats_.elapsedUs = esp_timer_get_time() - startUs;
+        LOG_INFO(NETWORK, "Replay finished: %u published, %u failed, max %u us late", stats_.published,
+                 stats_.failed, stats_.maxLateUs);
+    }
+    return true;
+}
@@ -0,0 +1,71 @@
+#ifndef TRAFFIC_REPLAYER_H
+#define TRAFFIC_REPLAYER_H
+
+#include "NetworkLayer.h"
+#include "../data/persistence/StorageBackend.h"
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// Re-publishes a log written by TrafficRecorder into a NetworkLayer with the original
+// inter-message timing scaled by a speed factor: 1.0 is real time, N plays N times faster and
+// 0 publishes back to back. Messages go out under PUBLISHER_NAME so a recorder can skip them.
+// Only broker subscribers see the replay: consumers fed from SampleRings (MPU::attachConsumer)
+// keep their single producer and get no replayed samples.
+// The log is validated (magic, version, CRC, record framing) when it is loaded.
+class TrafficReplayer {
+public:
+    static const char* const PUBLISHER_NAME;
+
+    struct Stats {
+        uint32_t published;
+        uint32_t failed;     // publish() returned false
+        uint32_t maxLateUs;  // Worst lag behind the scaled schedule
+        uint64_t elapsedUs;
+    };
+
+    TrafficReplayer();
+    ~TrafficReplayer();
+
+    bool load(const uint8_t* data, size_t len);
+    bool load(StorageBackend* storage, const std::string& path);
+
+    bool isLoaded() const { return !log_.empty(); }
+    uint32_t messageCount() const { return messageCount_; }
+    uint64_t durationUs() const { return durationUs_; }
+    size_t topicCount() const { return topics_.size(); }
+
+    // Replay on the calling task; returns when the log ends or stop() is called
+    bool run(NetworkLayer* network, float speed = 1.0f);
+
+    // Replay on a dedicated task
+    bool start(NetworkLayer* network, float speed = 1.0f, UBaseType_t priority = 1, uint32_t stackSize = 4096);
+
+    // Ask a running replay to finish and wait for it
+    void stop();
+
+    bool isRunning() const { return running_.load(); }
+    Stats stats() const { return stats_; }
+
+private:
+    std::vector<uint8_t> log_;
+    std::vector<std::string> topics_;
+    uint32_t messageCount_;
+    uint64_t durationUs_;
+
+    std::atomic<bool> running_;
+    std::atomic<bool> stopRequested_;
+    NetworkLayer* network_;
+    float speed_;
+    Stats stats_;
+
+    // Walk the records; with network set, publish them on schedule, otherwise only validate
+    bool replay(NetworkLayer* network, float speed);
+    static void replayTask(void* parameter);
+};
+
+#endif // TRAFFIC_REPLAYER_H
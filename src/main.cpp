@@ -1,21 +1,28 @@
 #include <Arduino.h>
-#include <Wire.h>
 #include <soc/rtc_cntl_reg.h>
 #include <stdexcept>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
+#include "layers/logging/Log.h"
 #include "layers/network/NetworkLayer.h"
 #include "layers/data/DataLayer.h"
+#include "layers/data/persistence/LittleFSStorage.h"
+#include "layers/hardware/I2cBus.h"
 // #include "layers/application/camera/Camera.h"
 #include "layers/application/ApplicationInterface.h"
 #include "layers/application/bluetooth/Bluetooth.h"
 #include "layers/application/mpu/MPU.h"
 #include "layers/application/led/LED.h"
 #include "layers/application/measurement/MeasurementApp.h"
+#include "layers/application/loadgen/LoadGenApp.h"
+#include "layers/application/fusion/FusionApp.h"
 // Network instances
 NetworkLayer *networkLayer = nullptr;
 // Data Layer instance
 DataLayer *dataLayer = nullptr;
+LittleFSStorage *flashStorage = nullptr;
+// Shared I2C bus, owned by its own task
+I2cBus *i2cBus = nullptr;
 
 // Application instances
 
@@ -24,16 +31,24 @@ ApplicationInterface *bluetoothApp = nullptr;
 ApplicationInterface *mpuApp = nullptr;
 ApplicationInterface *ledApp = nullptr;
 ApplicationInterface *measurementApp = nullptr;
+ApplicationInterface *loadGenApp = nullptr;
+ApplicationInterface *fusionApp = nullptr;
 
 void setup()
 {
   Serial.begin(115200);
+  // Low-priority task that formats and prints LOG_* records; callers never block on the UART
+  Log::begin(1, 4096, 20);
 
   // Disable brownout detector
   WRITE_PERI_REG(RTC_CNTL_BROWN_OUT_REG, 0);
-  // Init I2C for MPU6050 (will be handled by MPU application later)
-  Wire.begin(14, 15); // SDA 14, SCL 15
-  Wire.setClock(400000); // Set I2C to 400kHz for maximum speed
+  // I2C bus manager: every device driver queues its transactions on one bus task
+  i2cBus = new I2cBus();
+  if (!i2cBus->begin(14, 15, 400000, 6, 3072, 16))
+  { // SDA 14, SCL 15, 400 kHz, above the MPU acquisition task
+    Serial.println("[ApplicationManager] Failed to initialize I2C bus");
+    throw std::runtime_error("Failed to initialize I2C bus");
+  }
   networkLayer = new NetworkLayer();
   if (!networkLayer || !networkLayer->init())
   {
@@ -43,12 +58,23 @@ void setup()
 
   // Create and initialize Data Layer
   dataLayer = new DataLayer();
-  if (!dataLayer || !dataLayer->init(5000, 1, 2048))
-  { // 5s cleanup, priority 1, 2KB stack
+  flashStorage = new LittleFSStorage();
+  // Only settings and counters that must survive a reboot go to flash (calibration profiles,
+  // the measurement session counter); everything else stays RAM-only
+  PersistenceConfig persistenceConfig;
+  persistenceConfig.prefixes = {"config/", "measurement/"};
+  dataLayer->enablePersistence(flashStorage, persistenceConfig);
+  if (!dataLayer || !dataLayer->init(5000, 1, 4096))
+  { // 5s cleanup, priority 1, 4KB stack (group commits do flash I/O)
     Serial.println("[ApplicationManager] Failed to initialize Data Layer");
     throw std::runtime_error("Failed to initialize Data Layer");
   }
 
+  // Opt-in change notifications for apps that watch DataLayer keys instead of polling
+  dataLayer->enableKeyspaceNotifications(networkLayer, "keyspace/", 50);
+  // Hit/miss, footprint and lock contention stats on diagnostics/datalayer after each cleanup pass
+  dataLayer->enableStatsPublishing(networkLayer);
+
   // // Create and setup applications
   // cameraApp = new Camera(appManager.getNetworkLayer(), appManager.getDataLayer());
   // if (!cameraApp->setup()) {
@@ -65,7 +91,15 @@ void setup()
     bluetoothApp = nullptr;
   }
 
-  mpuApp = new MPU();
+  // One MPU app samples every IMU on the board; sensor n publishes under mpu<n>/ (the first under mpu/)
+  mpuApp = new MPU(i2cBus);
+  static const MPU::SensorConfig mpuSensors[] = {MPU_SENSORS};
+  for (const MPU::SensorConfig& sensor : mpuSensors) {
+    if (sensor.channel != I2cBus::NO_CHANNEL && !i2cBus->hasMux()) {
+      i2cBus->setMux(MPU_MUX_ADDRESS);
+    }
+    static_cast<MPU*>(mpuApp)->addSensor(sensor.address, sensor.channel);
+  }
   mpuApp->setNetworkLayer(networkLayer)->setDataLayer(dataLayer);
   if (!mpuApp->setup())
   {
@@ -95,6 +129,42 @@ void setup()
     measurementApp = nullptr;
   }
 
+  // Orientation and low-rate filtered IMU streams for clients that don't need every raw sample
+  fusionApp = new FusionApp();
+  fusionApp->setNetworkLayer(networkLayer)->setDataLayer(dataLayer);
+  if (!fusionApp->setup())
+  {
+    Serial.println("Failed to setup Fusion application");
+    delete fusionApp;
+    fusionApp = nullptr;
+  }
+
+  // Recorders and streamers take samples straight from the MPU's sampling task, one ring each
+  if (mpuApp) {
+    MPU* mpu = static_cast<MPU*>(mpuApp);
+    if (measurementApp) {
+      mpu->attachConsumer(static_cast<MeasurementApp*>(measurementApp)->sampleRing());
+    }
+    if (fusionApp) {
+      mpu->attachConsumer(static_cast<FusionApp*>(fusionApp)->sampleRing());
+    }
+  }
+
+  // Binary exports reach the link in order through the Bluetooth task, not one delivery task per frame
+  if (bluetoothApp && measurementApp) {
+    static_cast<MeasurementApp*>(measurementApp)->setFrameOutput(static_cast<Bluetooth*>(bluetoothApp)->streamRing());
+  }
+
+  // Idle until "LOAD START" arrives over Bluetooth; lets a production build be soak-tested in place
+  loadGenApp = new LoadGenApp();
+  loadGenApp->setNetworkLayer(networkLayer)->setDataLayer(dataLayer);
+  if (!loadGenApp->setup())
+  {
+    Serial.println("Failed to setup LoadGen application");
+    delete loadGenApp;
+    loadGenApp = nullptr;
+  }
+
   Serial.println("All applications initialized");
 
   // Create RTOS tasks for applications
@@ -122,6 +192,18 @@ void setup()
     }
   }
 
+  if (fusionApp) {
+    if (!fusionApp->createTask("FusionApp", 4096, 2, tskNO_AFFINITY, 20)) {  // Drains queued samples at 50Hz
+      Serial.println("Failed to create Fusion application task");
+    }
+  }
+
+  if (loadGenApp) {
+    if (!loadGenApp->createTask("LoadGenApp", 4096, 1, tskNO_AFFINITY, 10)) {  // 100Hz generator tick when running
+      Serial.println("Failed to create LoadGen application task");
+    }
+  }
+
   Serial.println("RTOS tasks initialized - applications now running concurrently");
 }
 
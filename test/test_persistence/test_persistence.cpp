@@ -0,0 +1,160 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include "layers/data/DataLayer.h"
+#include "layers/data/persistence/PosixFileStorage.h"
+
+// DataLayer persistence on the host (pio test -e native_test)
+
+namespace {
+
+const char* ROOT_DIR = ".pio/test_persistence";
+
+// Host files with injectable faults
+class FaultyStorage : public StorageBackend {
+public:
+    explicit FaultyStorage(const std::string& rootDir) : files_(rootDir) {}
+
+    bool failSnapshot = false;        // Snapshot writes fail while set
+    bool failLogReset = false;        // Rewriting the log (new generation header) fails while set
+    std::function<void()> onAppend;   // Runs inside every log append
+
+    bool begin() { return files_.begin(); }
+    bool readFile(const std::string& path, std::vector<uint8_t>& out) { return files_.readFile(path, out); }
+    bool writeFile(const std::string& path, const uint8_t* data, size_t len) {
+        if (failSnapshot && path.find("snapshot") != std::string::npos) {
+            return false;
+        }
+        if (failLogReset && path.find("oplog") != std::string::npos) {
+            return false;
+        }
+        return files_.writeFile(path, data, len);
+    }
+    bool appendFile(const std::string& path, const uint8_t* data, size_t len) {
+        bool ok = files_.appendFile(path, data, len);
+        if (onAppend) {
+            onAppend();
+        }
+        return ok;
+    }
+    bool renameFile(const std::string& from, const std::string& to) { return files_.renameFile(from, to); }
+    bool removeFile(const std::string& path) { return files_.removeFile(path); }
+    bool exists(const std::string& path) { return files_.exists(path); }
+    size_t fileSize(const std::string& path) { return files_.fileSize(path); }
+    bool makeDir(const std::string& path) { return files_.makeDir(path); }
+
+private:
+    PosixFileStorage files_;
+};
+
+PersistenceConfig testConfig() {
+    PersistenceConfig config;
+    config.directory = "/datalayer";
+    config.commitIntervalMs = 60000;      // Commits only when the test flushes
+    config.commitThresholdBytes = 65536;
+    config.compactThresholdBytes = 16;    // Every flush that logs a record compacts
+    return config;
+}
+
+void removeStore() {
+    std::remove((std::string(ROOT_DIR) + "/datalayer/oplog.bin").c_str());
+    std::remove((std::string(ROOT_DIR) + "/datalayer/snapshot.bin").c_str());
+    std::remove((std::string(ROOT_DIR) + "/datalayer/snapshot.tmp").c_str());
+}
+
+}
+
+// A set that lands between the log append and the compaction snapshot must survive a
+// failed snapshot write and come back from the log after a restart
+void test_failed_snapshot_keeps_pending_records(void) {
+    removeStore();
+    FaultyStorage storage(ROOT_DIR);
+
+    DataLayer* dataLayer = new DataLayer();
+    TEST_ASSERT_TRUE(dataLayer->enablePersistence(&storage, testConfig()));
+    TEST_ASSERT_TRUE(dataLayer->init(60000));
+
+    uint32_t first = 1;
+    uint32_t late = 2;
+    TEST_ASSERT_TRUE(dataLayer->setValue("config/first", first));
+
+    bool wroteLate = false;
+    storage.onAppend = [&]() {
+        if (!wroteLate) {
+            wroteLate = true;
+            dataLayer->setValue("config/late", late);
+        }
+    };
+    storage.failSnapshot = true;
+    TEST_ASSERT_FALSE(dataLayer->flush());
+    TEST_ASSERT_TRUE(wroteLate);
+    storage.onAppend = nullptr;
+
+    // Destruction commits what is still pending; the snapshot keeps failing
+    delete dataLayer;
+
+    storage.failSnapshot = false;
+    dataLayer = new DataLayer();
+    TEST_ASSERT_TRUE(dataLayer->enablePersistence(&storage, testConfig()));
+    TEST_ASSERT_TRUE(dataLayer->init(60000));
+
+    uint32_t value = 0;
+    TEST_ASSERT_TRUE(dataLayer->getValue("config/first", value));
+    TEST_ASSERT_EQUAL_UINT32(first, value);
+    TEST_ASSERT_TRUE(dataLayer->getValue("config/late", value));
+    TEST_ASSERT_EQUAL_UINT32(late, value);
+
+    delete dataLayer;
+    removeStore();
+}
+
+// A snapshot that lands but whose new log header doesn't must not let later writes go to the
+// previous generation's log, which recovery discards
+void test_failed_log_reset_keeps_later_records(void) {
+    removeStore();
+    FaultyStorage storage(ROOT_DIR);
+
+    // Log header plus one record compacts, a lone record does not: the second flush must not
+    // compact its way past a misdirected append
+    PersistenceConfig config = testConfig();
+    config.compactThresholdBytes = 30;
+
+    DataLayer* dataLayer = new DataLayer();
+    TEST_ASSERT_TRUE(dataLayer->enablePersistence(&storage, config));
+    TEST_ASSERT_TRUE(dataLayer->init(60000));
+
+    uint32_t first = 1;
+    uint32_t later = 2;
+    TEST_ASSERT_TRUE(dataLayer->setValue("config/first", first));
+    storage.failLogReset = true;
+    TEST_ASSERT_FALSE(dataLayer->flush());   // Snapshot written, log reset failed
+
+    TEST_ASSERT_TRUE(dataLayer->setValue("config/later", later));
+    TEST_ASSERT_FALSE(dataLayer->flush());   // Refused until the new log exists, kept pending
+
+    // Destruction commits once the log can be started again
+    storage.failLogReset = false;
+    delete dataLayer;
+
+    dataLayer = new DataLayer();
+    TEST_ASSERT_TRUE(dataLayer->enablePersistence(&storage, config));
+    TEST_ASSERT_TRUE(dataLayer->init(60000));
+
+    uint32_t value = 0;
+    TEST_ASSERT_TRUE(dataLayer->getValue("config/first", value));
+    TEST_ASSERT_EQUAL_UINT32(first, value);
+    TEST_ASSERT_TRUE(dataLayer->getValue("config/later", value));
+    TEST_ASSERT_EQUAL_UINT32(later, value);
+
+    delete dataLayer;
+    removeStore();
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_failed_snapshot_keeps_pending_records);
+    RUN_TEST(test_failed_log_reset_keeps_later_records);
+    return UNITY_END();
+}